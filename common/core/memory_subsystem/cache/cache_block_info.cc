@@ -23,12 +23,34 @@ const char* CacheBlockInfo::getOptionName(option_t option)
 
 CacheBlockInfo::CacheBlockInfo(IntPtr tag, CacheState::cstate_t cstate, UInt64 options):
    m_tag(tag),
-   m_cstate(cstate),
    m_owner(0),
+   m_cstate(cstate),
    m_used(0),
-   m_options(options)
+   m_options(options),
+   m_in_set(false)
+{}
+
+CacheBlockInfo::CacheBlockInfo(const CacheBlockInfo& cache_block_info):
+   m_tag(cache_block_info.getTag()),
+   m_owner(cache_block_info.m_owner),
+   m_cstate(cache_block_info.m_cstate),
+   m_used(cache_block_info.m_used),
+   m_options(cache_block_info.m_options),
+   m_in_set(false)
 {}
 
+CacheBlockInfo&
+CacheBlockInfo::operator=(const CacheBlockInfo& cache_block_info)
+{
+   // Copy the tag value, this block keeps its own tag storage
+   setTag(cache_block_info.getTag());
+   m_cstate = cache_block_info.m_cstate;
+   m_owner = cache_block_info.m_owner;
+   m_used = cache_block_info.m_used;
+   m_options = cache_block_info.m_options;
+   return *this;
+}
+
 CacheBlockInfo::~CacheBlockInfo()
 {}
 
@@ -52,17 +74,75 @@ CacheBlockInfo::create(CacheBase::cache_t cache_type)
    }
 }
 
+template <class T> CacheBlockInfo**
+CacheBlockInfo::createArrayOf(UInt32 count, IntPtr* tags)
+{
+   T* blocks = new T[count];
+   CacheBlockInfo** block_ptrs = new CacheBlockInfo*[count];
+   for (UInt32 i = 0; i < count; i++)
+   {
+      tags[i] = blocks[i].getTag();
+      blocks[i].m_set_tag = &tags[i];
+      blocks[i].m_in_set = true;
+      block_ptrs[i] = &blocks[i];
+   }
+   return block_ptrs;
+}
+
+CacheBlockInfo**
+CacheBlockInfo::createArray(CacheBase::cache_t cache_type, UInt32 count, IntPtr* tags)
+{
+   switch (cache_type)
+   {
+      case CacheBase::PR_L1_CACHE:
+         return createArrayOf<PrL1CacheBlockInfo>(count, tags);
+
+      case CacheBase::PR_L2_CACHE:
+         return createArrayOf<PrL2CacheBlockInfo>(count, tags);
+
+      case CacheBase::SHARED_CACHE:
+         return createArrayOf<SharedCacheBlockInfo>(count, tags);
+
+      default:
+         LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+         return NULL;
+   }
+}
+
+void
+CacheBlockInfo::deleteArray(CacheBase::cache_t cache_type, CacheBlockInfo** blocks)
+{
+   switch (cache_type)
+   {
+      case CacheBase::PR_L1_CACHE:
+         delete [] static_cast<PrL1CacheBlockInfo*>(blocks[0]);
+         break;
+
+      case CacheBase::PR_L2_CACHE:
+         delete [] static_cast<PrL2CacheBlockInfo*>(blocks[0]);
+         break;
+
+      case CacheBase::SHARED_CACHE:
+         delete [] static_cast<SharedCacheBlockInfo*>(blocks[0]);
+         break;
+
+      default:
+         LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+   }
+   delete [] blocks;
+}
+
 void
 CacheBlockInfo::invalidate()
 {
-   m_tag = ~0;
+   setTag(~0);
    m_cstate = CacheState::INVALID;
 }
 
 void
 CacheBlockInfo::clone(CacheBlockInfo* cache_block_info)
 {
-   m_tag = cache_block_info->getTag();
+   setTag(cache_block_info->getTag());
    m_cstate = cache_block_info->getCState();
    m_owner = cache_block_info->m_owner;
    m_used = cache_block_info->m_used;
@@ -21,31 +21,43 @@ class CacheBlockInfo
    // This can be extended later to include other information
    // for different cache coherence protocols
    private:
-      IntPtr m_tag;
-      CacheState::cstate_t m_cstate;
+      union
+      {
+         IntPtr m_tag;         // Stand-alone blocks hold their own tag
+         IntPtr *m_set_tag;    // Blocks inside a CacheSet point into its contiguous tag array
+      };
       UInt64 m_owner;
+      CacheState::cstate_t m_cstate;
       BitsUsedType m_used;
       UInt8 m_options;  // large enough to hold a bitfield for all available option_t's
+      bool m_in_set;
 
       static const char* option_names[];
 
+      template <class T> static CacheBlockInfo** createArrayOf(UInt32 count, IntPtr* tags);
+
    public:
       CacheBlockInfo(IntPtr tag = ~0,
             CacheState::cstate_t cstate = CacheState::INVALID,
             UInt64 options = 0);
+      CacheBlockInfo(const CacheBlockInfo& cache_block_info);
+      CacheBlockInfo& operator=(const CacheBlockInfo& cache_block_info);
       virtual ~CacheBlockInfo();
 
       static CacheBlockInfo* create(CacheBase::cache_t cache_type);
+      // Allocate count blocks in one array, storing their tags in tags[0 .. count-1]
+      static CacheBlockInfo** createArray(CacheBase::cache_t cache_type, UInt32 count, IntPtr* tags);
+      static void deleteArray(CacheBase::cache_t cache_type, CacheBlockInfo** blocks);
 
       virtual void invalidate(void);
       virtual void clone(CacheBlockInfo* cache_block_info);
 
-      bool isValid() const { return (m_tag != ((IntPtr) ~0)); }
+      bool isValid() const { return (getTag() != ((IntPtr) ~0)); }
 
-      IntPtr getTag() const { return m_tag; }
+      IntPtr getTag() const { return m_in_set ? *m_set_tag : m_tag; }
       CacheState::cstate_t getCState() const { return m_cstate; }
 
-      void setTag(IntPtr tag) { m_tag = tag; }
+      void setTag(IntPtr tag) { (m_in_set ? *m_set_tag : m_tag) = tag; }
       void setCState(CacheState::cstate_t cstate) { m_cstate = cstate; }
 
       UInt64 getOwner() const { return m_owner; }
@@ -13,15 +13,14 @@
 #include "config.h"
 #include "config.hpp"
 
+#include <algorithm>
+
 CacheSet::CacheSet(CacheBase::cache_t cache_type,
       UInt32 associativity, UInt32 blocksize):
-      m_associativity(associativity), m_blocksize(blocksize)
+      m_cache_type(cache_type), m_associativity(associativity), m_blocksize(blocksize)
 {
-   m_cache_block_info_array = new CacheBlockInfo*[m_associativity];
-   for (UInt32 i = 0; i < m_associativity; i++)
-   {
-      m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type);
-   }
+   m_tags = new IntPtr[m_associativity];
+   m_cache_block_info_array = CacheBlockInfo::createArray(cache_type, m_associativity, m_tags);
 
    if (Sim()->getFaultinjectionManager())
    {
@@ -34,9 +33,8 @@ CacheSet::CacheSet(CacheBase::cache_t cache_type,
 
 CacheSet::~CacheSet()
 {
-   for (UInt32 i = 0; i < m_associativity; i++)
-      delete m_cache_block_info_array[i];
-   delete [] m_cache_block_info_array;
+   CacheBlockInfo::deleteArray(m_cache_type, m_cache_block_info_array);
+   delete [] m_tags;
    delete [] m_blocks;
 }
 
@@ -66,33 +64,44 @@ CacheSet::write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 byt
       updateReplacementIndex(line_index);
 }
 
-CacheBlockInfo*
-CacheSet::find(IntPtr tag, UInt32* line_index)
+SInt32
+CacheSet::findWay(IntPtr tag) const
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
+   // Compare up to 64 ways at a time into a bitmask, without an early exit so the compiler can vectorize the loop
+   for (SInt32 base = (m_associativity - 1) & ~63; base >= 0; base -= 64)
    {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         if (line_index != NULL)
-            *line_index = index;
-         return (m_cache_block_info_array[index]);
-      }
+      UInt32 ways = std::min(m_associativity - base, 64U);
+      const IntPtr* tags = &m_tags[base];
+      UInt64 match = 0;
+      for (UInt32 way = 0; way < ways; way++)
+         match |= UInt64(tags[way] == tag) << way;
+      if (match)
+         return base + 63 - __builtin_clzll(match);
    }
-   return NULL;
+   return -1;
+}
+
+CacheBlockInfo*
+CacheSet::find(IntPtr tag, UInt32* line_index)
+{
+   SInt32 index = findWay(tag);
+   if (index < 0)
+      return NULL;
+
+   if (line_index != NULL)
+      *line_index = index;
+   return (m_cache_block_info_array[index]);
 }
 
 bool
 CacheSet::invalidate(IntPtr& tag)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
-   {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         m_cache_block_info_array[index]->invalidate();
-         return true;
-      }
-   }
-   return false;
+   SInt32 index = findWay(tag);
+   if (index < 0)
+      return false;
+
+   m_cache_block_info_array[index]->invalidate();
+   return true;
 }
 
 void
@@ -145,7 +154,19 @@ CacheSet::createCacheSet(String cfgname, core_id_t core_id,
 
       case CacheBase::LRU:
       case CacheBase::LRU_QBS:
-         return new CacheSetLRU(cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+      {
+         // Pick the age store once per cache, so each access runs code specialized for its associativity
+         CacheSetInfoLRU* lru_info = dynamic_cast<CacheSetInfoLRU*>(set_info);
+         UInt8 num_attempts = getNumQBSAttempts(policy, cfgname, core_id);
+         if (associativity <= 8)
+            return new CacheSetLRU<LRUAgesPacked<1> >(cache_type, associativity, blocksize, lru_info, num_attempts);
+         else if (associativity <= 16)
+            return new CacheSetLRU<LRUAgesPacked<2> >(cache_type, associativity, blocksize, lru_info, num_attempts);
+         else if (associativity <= 32)
+            return new CacheSetLRU<LRUAgesPacked<4> >(cache_type, associativity, blocksize, lru_info, num_attempts);
+         else
+            return new CacheSetLRU<LRUAgesArray>(cache_type, associativity, blocksize, lru_info, num_attempts);
+      }
 
       case CacheBase::NRU:
          return new CacheSetNRU(cache_type, associativity, blocksize);
@@ -157,7 +178,17 @@ CacheSet::createCacheSet(String cfgname, core_id_t core_id,
          return new CacheSetNMRU(cache_type, associativity, blocksize);
 
       case CacheBase::PLRU:
-         return new CacheSetPLRU(cache_type, associativity, blocksize);
+         switch(associativity)
+         {
+            case 2:  return new CacheSetPLRU<1>(cache_type, associativity, blocksize);
+            case 4:  return new CacheSetPLRU<2>(cache_type, associativity, blocksize);
+            case 8:  return new CacheSetPLRU<3>(cache_type, associativity, blocksize);
+            case 16: return new CacheSetPLRU<4>(cache_type, associativity, blocksize);
+            case 32: return new CacheSetPLRU<5>(cache_type, associativity, blocksize);
+            case 64: return new CacheSetPLRU<6>(cache_type, associativity, blocksize);
+            default:
+               LOG_PRINT_ERROR("PLRU not implemented for associativity %d (only powers of two from 2 to 64)", associativity);
+         }
 
       case CacheBase::SRRIP:
       case CacheBase::SRRIP_QBS:
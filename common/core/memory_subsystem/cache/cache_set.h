@@ -29,7 +29,11 @@ class CacheSet
       static UInt8 getNumQBSAttempts(CacheBase::ReplacementPolicy, String cfgname, core_id_t core_id);
 
    protected:
+      CacheBase::cache_t m_cache_type;
+      // The blocks of all ways are allocated together and keep their tags in the contiguous m_tags array,
+      // so lookups compare tags without touching the blocks themselves
       CacheBlockInfo** m_cache_block_info_array;
+      IntPtr* m_tags;
       char* m_blocks;
       UInt32 m_associativity;
       UInt32 m_blocksize;
@@ -60,6 +64,9 @@ class CacheSet
       virtual void updateReplacementIndex(UInt32) = 0;
 
       bool isValidReplacement(UInt32 index);
+      bool isValidWay(UInt32 index) const { return m_tags[index] != (IntPtr) ~0; }
+      // Way holding the tag (the highest one if there are several), or -1
+      SInt32 findWay(IntPtr tag) const;
 };
 
 #endif /* CACHE_SET_H */
@@ -4,33 +4,33 @@
 
 // Implements LRU replacement, optionally augmented with Query-Based Selection [Jaleel et al., MICRO'10]
 
-CacheSetLRU::CacheSetLRU(
+template <class Ages>
+CacheSetLRU<Ages>::CacheSetLRU(
       CacheBase::cache_t cache_type,
       UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts)
    : CacheSet(cache_type, associativity, blocksize)
    , m_num_attempts(num_attempts)
+   , m_lru_bits(associativity)
    , m_set_info(set_info)
 {
-   m_lru_bits = new UInt8[m_associativity];
-   for (UInt32 i = 0; i < m_associativity; i++)
-      m_lru_bits[i] = i;
 }
 
-CacheSetLRU::~CacheSetLRU()
+template <class Ages>
+CacheSetLRU<Ages>::~CacheSetLRU()
 {
-   delete [] m_lru_bits;
 }
 
+template <class Ages>
 UInt32
-CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
+CacheSetLRU<Ages>::getReplacementIndex(CacheCntlr *cntlr)
 {
    // First try to find an invalid block
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      if (!m_cache_block_info_array[i]->isValid())
+      if (!isValidWay(i))
       {
          // Mark our newly-inserted line as most-recently used
-         moveToMRU(i);
+         m_lru_bits.moveToMRU(i);
          return i;
       }
    }
@@ -39,13 +39,13 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
    for(UInt8 attempt = 0; attempt < m_num_attempts; ++attempt)
    {
       UInt32 index = 0;
-      UInt8 max_bits = 0;
+      UInt32 max_bits = 0;
       for (UInt32 i = 0; i < m_associativity; i++)
       {
-         if (m_lru_bits[i] > max_bits && isValidReplacement(i))
+         if (m_lru_bits.get(i) > max_bits && isValidReplacement(i))
          {
             index = i;
-            max_bits = m_lru_bits[i];
+            max_bits = m_lru_bits.get(i);
          }
       }
       LOG_ASSERT_ERROR(index < m_associativity, "Error Finding LRU bits");
@@ -61,14 +61,14 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
       {
          // Block is contained in lower-level cache, and we have more tries remaining.
          // Move this block to MRU and try again
-         moveToMRU(index);
+         m_lru_bits.moveToMRU(index);
          cntlr->incrementQBSLookupCost();
          continue;
       }
       else
       {
          // Mark our newly-inserted line as most-recently used
-         moveToMRU(index);
+         m_lru_bits.moveToMRU(index);
          m_set_info->incrementAttempt(attempt);
          return index;
       }
@@ -77,22 +77,26 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
    LOG_PRINT_ERROR("Should not reach here");
 }
 
+template <class Ages>
 void
-CacheSetLRU::updateReplacementIndex(UInt32 accessed_index)
+CacheSetLRU<Ages>::updateReplacementIndex(UInt32 accessed_index)
 {
-   m_set_info->increment(m_lru_bits[accessed_index]);
-   moveToMRU(accessed_index);
+   m_set_info->increment(m_lru_bits.get(accessed_index));
+   m_lru_bits.moveToMRU(accessed_index);
 }
 
-void
-CacheSetLRU::moveToMRU(UInt32 accessed_index)
+LRUAgesArray::LRUAgesArray(UInt32 associativity)
+   : m_associativity(associativity)
 {
+   LOG_ASSERT_ERROR(associativity <= 256, "LRU not implemented for associativity %d (max 256)", associativity);
+   m_ages = new UInt8[m_associativity];
    for (UInt32 i = 0; i < m_associativity; i++)
-   {
-      if (m_lru_bits[i] < m_lru_bits[accessed_index])
-         m_lru_bits[i] ++;
-   }
-   m_lru_bits[accessed_index] = 0;
+      m_ages[i] = i;
+}
+
+LRUAgesArray::~LRUAgesArray()
+{
+   delete [] m_ages;
 }
 
 CacheSetInfoLRU::CacheSetInfoLRU(String name, String cfgname, core_id_t core_id, UInt32 associativity, UInt8 num_attempts)
@@ -123,3 +127,9 @@ CacheSetInfoLRU::~CacheSetInfoLRU()
    if (m_attempts)
       delete [] m_attempts;
 }
+
+// One instantiation per associativity bucket, see CacheSet::createCacheSet
+template class CacheSetLRU<LRUAgesPacked<1> >;
+template class CacheSetLRU<LRUAgesPacked<2> >;
+template class CacheSetLRU<LRUAgesPacked<4> >;
+template class CacheSetLRU<LRUAgesArray>;
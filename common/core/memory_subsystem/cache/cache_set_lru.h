@@ -26,6 +26,68 @@ class CacheSetInfoLRU : public CacheSetInfo
       UInt64* m_attempts;
 };
 
+// Ages of the ways in a set, 0 is most-recently used. Works for any associativity up to 256.
+class LRUAgesArray
+{
+   public:
+      LRUAgesArray(UInt32 associativity);
+      ~LRUAgesArray();
+
+      UInt32 get(UInt32 way) const { return m_ages[way]; }
+      void moveToMRU(UInt32 way)
+      {
+         for (UInt32 i = 0; i < m_associativity; i++)
+         {
+            if (m_ages[i] < m_ages[way])
+               m_ages[i] ++;
+         }
+         m_ages[way] = 0;
+      }
+
+   private:
+      const UInt32 m_associativity;
+      UInt8* m_ages;
+};
+
+// Ages packed eight to a word, one byte lane per way, so moveToMRU ages all ways with a few word operations.
+// Holds up to 8 * WORDS ways, unused lanes hold the maximum lane value so they are never aged.
+template <UInt32 WORDS>
+class LRUAgesPacked
+{
+   public:
+      LRUAgesPacked(UInt32 associativity)
+      {
+         LOG_ASSERT_ERROR(associativity <= 8 * WORDS, "Associativity(%d) > %d", associativity, 8 * WORDS);
+         for (UInt32 w = 0; w < WORDS; w++)
+            m_ages[w] = ~LANE_HIGH;
+         for (UInt32 i = 0; i < associativity; i++)
+            set(i, i);
+      }
+
+      UInt32 get(UInt32 way) const { return (m_ages[way / 8] >> (8 * (way % 8))) & 0xff; }
+      void moveToMRU(UInt32 way)
+      {
+         // Per lane, (age | 0x80) - accessed_age keeps its top bit exactly when age >= accessed_age.
+         // Ages stay below 0x80 so no lane borrows from its neighbour.
+         const UInt64 accessed = get(way) * LANE_LOW;
+         for (UInt32 w = 0; w < WORDS; w++)
+            m_ages[w] += (~((m_ages[w] | LANE_HIGH) - accessed) & LANE_HIGH) >> 7;
+         set(way, 0);
+      }
+
+   private:
+      static const UInt64 LANE_LOW = 0x0101010101010101ULL;
+      static const UInt64 LANE_HIGH = 0x8080808080808080ULL;
+      UInt64 m_ages[WORDS];
+
+      void set(UInt32 way, UInt32 age)
+      {
+         m_ages[way / 8] = (m_ages[way / 8] & ~(0xffULL << (8 * (way % 8)))) | (UInt64(age) << (8 * (way % 8)));
+      }
+};
+
+// LRU replacement, the age store is chosen by CacheSet::createCacheSet based on associativity
+template <class Ages>
 class CacheSetLRU : public CacheSet
 {
    public:
@@ -38,9 +100,8 @@ class CacheSetLRU : public CacheSet
 
    protected:
       const UInt8 m_num_attempts;
-      UInt8* m_lru_bits;
+      Ages m_lru_bits;
       CacheSetInfoLRU* m_set_info;
-      void moveToMRU(UInt32 accessed_index);
 };
 
 #endif /* CACHE_SET_LRU_H */
@@ -3,6 +3,8 @@
 
 #include "cache_set.h"
 
+// Tree PLRU for 2^LEVELS ways, LEVELS from 1 to 6
+template <UInt32 LEVELS>
 class CacheSetPLRU : public CacheSet
 {
    public:
@@ -14,7 +16,9 @@ class CacheSetPLRU : public CacheSet
       void updateReplacementIndex(UInt32 accessed_index);
 
    private:
-      UInt8 b[8];
+      // Tree nodes in heap order (root is bit 1, the children of node n are 2n and 2n+1),
+      // a set bit means the next victim is in the right subtree
+      UInt64 m_tree;
 };
 
 #endif /* CACHE_SET_PLRU_H */
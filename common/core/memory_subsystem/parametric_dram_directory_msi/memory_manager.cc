@@ -12,6 +12,7 @@
 #include "config.hpp"
 #include "distribution.h"
 #include "topology_info.h"
+#include "clock_skew_minimization_object.h"
 
 #include <algorithm>
 
@@ -445,7 +446,8 @@ MemoryManager::handleMsgFromNetwork(NetPacket& packet)
 {
 MYLOG("begin");
    core_id_t sender = packet.sender;
-   PrL1PrL2DramDirectoryMSI::ShmemMsg* shmem_msg = PrL1PrL2DramDirectoryMSI::ShmemMsg::getShmemMsg((Byte*) packet.data, &m_dummy_shmem_perf);
+   // The message and its data stay in the transport buffer, which netPullFromTransport releases after this callback
+   PrL1PrL2DramDirectoryMSI::ShmemMsg* shmem_msg = PrL1PrL2DramDirectoryMSI::ShmemMsg::getShmemMsg((Byte*) packet.data);
    SubsecondTime msg_time = packet.time;
 
    getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_SIM_THREAD, msg_time);
@@ -521,17 +523,6 @@ MYLOG("begin");
                receiver_mem_component);
          break;
    }
-
-   // Delete the allocated Shared Memory Message
-   // First delete 'data_buf' if it is present
-   // LOG_PRINT("Finished handling Shmem Msg");
-
-   if (shmem_msg->getDataLength() > 0)
-   {
-      assert(shmem_msg->getDataBuf());
-      delete [] shmem_msg->getDataBuf();
-   }
-   delete shmem_msg;
 MYLOG("end");
 }
 
@@ -543,22 +534,23 @@ MYLOG("send msg %u %ul%u > %ul%u", msg_type, requester, sender_mem_component, re
    PrL1PrL2DramDirectoryMSI::ShmemMsg shmem_msg(msg_type, sender_mem_component, receiver_mem_component, requester, address, data_buf, data_length, perf);
    shmem_msg.setWhere(where);
 
-   Byte* msg_buf = shmem_msg.makeMsgBuf();
    SubsecondTime msg_time = getShmemPerfModel()->getElapsedTime(thread_num);
    perf->updateTime(msg_time);
 
+   // The directory taking a line away from another core is an interaction the barrier may want to know about
+   if (msg_type == PrL1PrL2DramDirectoryMSI::ShmemMsg::INV_REQ || msg_type == PrL1PrL2DramDirectoryMSI::ShmemMsg::FLUSH_REQ || msg_type == PrL1PrL2DramDirectoryMSI::ShmemMsg::WB_REQ)
+      Sim()->getClockSkewMinimizationServer()->notifyInteraction();
+
    if (m_enabled)
    {
       LOG_PRINT("Sending Msg: type(%u), address(0x%x), sender_mem_component(%u), receiver_mem_component(%u), requester(%i), sender(%i), receiver(%i)", msg_type, address, sender_mem_component, receiver_mem_component, requester, getCore()->getId(), receiver);
    }
 
+   // The message and its data are copied straight into the transport buffer
    NetPacket packet(msg_time, SHARED_MEM_1,
          m_core_id_master, receiver,
-         shmem_msg.getMsgLen(), (const void*) msg_buf);
-   getNetwork()->netSend(packet);
-
-   // Delete the Msg Buf
-   delete [] msg_buf;
+         shmem_msg.getMsgLen(), (const void*) &shmem_msg);
+   getNetwork()->netSend(packet, data_buf, data_length);
 }
 
 void
@@ -568,10 +560,13 @@ MYLOG("bcast msg");
    assert((data_buf == NULL) == (data_length == 0));
    PrL1PrL2DramDirectoryMSI::ShmemMsg shmem_msg(msg_type, sender_mem_component, receiver_mem_component, requester, address, data_buf, data_length, perf);
 
-   Byte* msg_buf = shmem_msg.makeMsgBuf();
    SubsecondTime msg_time = getShmemPerfModel()->getElapsedTime(thread_num);
    perf->updateTime(msg_time);
 
+   // The directory taking a line away from another core is an interaction the barrier may want to know about
+   if (msg_type == PrL1PrL2DramDirectoryMSI::ShmemMsg::INV_REQ || msg_type == PrL1PrL2DramDirectoryMSI::ShmemMsg::FLUSH_REQ || msg_type == PrL1PrL2DramDirectoryMSI::ShmemMsg::WB_REQ)
+      Sim()->getClockSkewMinimizationServer()->notifyInteraction();
+
    if (m_enabled)
    {
       LOG_PRINT("Sending Msg: type(%u), address(0x%x), sender_mem_component(%u), receiver_mem_component(%u), requester(%i), sender(%i), receiver(%i)", msg_type, address, sender_mem_component, receiver_mem_component, requester, getCore()->getId(), NetPacket::BROADCAST);
@@ -579,11 +574,8 @@ MYLOG("bcast msg");
 
    NetPacket packet(msg_time, SHARED_MEM_1,
          m_core_id_master, NetPacket::BROADCAST,
-         shmem_msg.getMsgLen(), (const void*) msg_buf);
-   getNetwork()->netSend(packet);
-
-   // Delete the Msg Buf
-   delete [] msg_buf;
+         shmem_msg.getMsgLen(), (const void*) &shmem_msg);
+   getNetwork()->netSend(packet, data_buf, data_length);
 }
 
 void
@@ -1,4 +1,3 @@
-#include <string.h>
 #include "shmem_msg.h"
 #include "shmem_perf.h"
 #include "log.h"
@@ -51,32 +50,14 @@ namespace PrL1PrL2DramDirectoryMSI
    {}
 
    ShmemMsg*
-   ShmemMsg::getShmemMsg(Byte* msg_buf, ShmemPerf* perf)
+   ShmemMsg::getShmemMsg(Byte* msg_buf)
    {
-      ShmemMsg* shmem_msg = new ShmemMsg(perf);
-      memcpy((void*) shmem_msg, msg_buf, sizeof(*shmem_msg));
-      if (shmem_msg->getDataLength() > 0)
-      {
-         shmem_msg->setDataBuf(new Byte[shmem_msg->getDataLength()]);
-         memcpy((void*) shmem_msg->getDataBuf(), msg_buf + sizeof(*shmem_msg), shmem_msg->getDataLength());
-      }
+      // The sender's data pointer came along with the message, point it to the copy right behind it
+      ShmemMsg* shmem_msg = (ShmemMsg*) msg_buf;
+      shmem_msg->setDataBuf(shmem_msg->getDataLength() > 0 ? msg_buf + sizeof(*shmem_msg) : NULL);
       return shmem_msg;
    }
 
-   Byte*
-   ShmemMsg::makeMsgBuf()
-   {
-      Byte* msg_buf = new Byte[getMsgLen()];
-      memcpy(msg_buf, (void*) this, sizeof(*this));
-      if (m_data_length > 0)
-      {
-         LOG_ASSERT_ERROR(m_data_buf != NULL, "m_data_buf(%p)", m_data_buf);
-         memcpy(msg_buf + sizeof(*this), (void*) m_data_buf, m_data_length);
-      }
-
-      return msg_buf;
-   }
-
    UInt32
    ShmemMsg::getMsgLen()
    {
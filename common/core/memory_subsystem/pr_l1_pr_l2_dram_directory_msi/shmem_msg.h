@@ -66,8 +66,9 @@ namespace PrL1PrL2DramDirectoryMSI
 
          ~ShmemMsg();
 
-         static ShmemMsg* getShmemMsg(Byte* msg_buf, ShmemPerf* perf);
-         Byte* makeMsgBuf();
+         // Use a message received from the network in place: msg_buf holds the ShmemMsg followed by its data,
+         // and must stay valid (until Network::releasePacket) for as long as the message is used
+         static ShmemMsg* getShmemMsg(Byte* msg_buf);
          UInt32 getMsgLen();
 
          // Modeling
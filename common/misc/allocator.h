@@ -11,7 +11,7 @@
 
 class Allocator
 {
-   private:
+   protected:
       struct DataElement
       {
           Allocator *allocator;
@@ -36,16 +36,34 @@ template <typename T, unsigned MaxItems = 0> class TypedAllocator : public Alloc
       UInt64 m_items;
       FSBAllocator_ElemAllocator<sizeof(DataElement) + sizeof(T), MaxItems, T> m_alloc;
 
-      // In ROB-SMT, DynamicMicroOps are allocated by their own thread but free'd in simulate() which can be called by anyone
+      // Each allocator belongs to one core and is mostly allocated from by the thread simulating that core, but other threads
+      // can allocate too (queuePseudoInstruction from DvfsManager::setCoreDomain or MagicServer::setFrequency), so alloc()
+      // holds m_lock, which is uncontended in the common case.
+      // In ROB-SMT, DynamicMicroOps are allocated by their own thread but free'd in simulate() which can be called by anyone:
+      // all frees are pushed onto a lock-free return list, which alloc() takes over as a whole once its magazine runs empty.
       Lock m_lock;
+      DataElement *m_magazine;
+      DataElement *m_returned;
+
+      static DataElement*& next(DataElement *elem) { return *(DataElement**)elem->data; }
+
+      void refill()
+      {
+         m_magazine = __atomic_exchange_n(&m_returned, (DataElement*)NULL, __ATOMIC_ACQUIRE);
+         for(DataElement *elem = m_magazine; elem; elem = next(elem))
+            --m_items;
+      }
 
    public:
       TypedAllocator()
          : m_items(0)
+         , m_magazine(NULL)
+         , m_returned(NULL)
       {}
 
       virtual ~TypedAllocator()
       {
+         refill();
          if (m_items)
          {
             int status;
@@ -59,17 +77,33 @@ template <typename T, unsigned MaxItems = 0> class TypedAllocator : public Alloc
       {
          ScopedLock sl(m_lock);
          //LOG_ASSERT_ERROR(bytes == sizeof(T), "");
+         if (!m_magazine)
+            refill();
+
+         DataElement *elem;
+         if (m_magazine)
+         {
+            elem = m_magazine;
+            m_magazine = next(elem);
+         }
+         else
+         {
+            elem = (DataElement *)m_alloc.allocate();
+            elem->allocator = this;
+         }
          ++m_items;
-         DataElement *elem = (DataElement *)m_alloc.allocate();
-         elem->allocator = this;
          return elem->data;
       }
 
       virtual void _dealloc(void* ptr)
       {
-         ScopedLock sl(m_lock);
-         --m_items;
-         m_alloc.deallocate((T*)ptr);
+         DataElement *elem = (DataElement *)ptr;
+         DataElement *head = __atomic_load_n(&m_returned, __ATOMIC_RELAXED);
+         do
+         {
+            next(elem) = head;
+         }
+         while (!__atomic_compare_exchange_n(&m_returned, &head, elem, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
       }
 };
 
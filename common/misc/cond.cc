@@ -70,3 +70,42 @@ void ConditionVariable::broadcast()
 
    m_lock.release();
 }
+
+WakeupEvent::WakeupEvent()
+   : m_futx(0)
+{
+}
+
+WakeupEvent::~WakeupEvent()
+{
+}
+
+void WakeupEvent::arm()
+{
+   __atomic_store_n(&m_futx, 0, __ATOMIC_RELAXED);
+}
+
+void WakeupEvent::wait()
+{
+   for(UInt32 i = 0; i < SPIN_COUNT; ++i)
+   {
+      if (__atomic_load_n(&m_futx, __ATOMIC_ACQUIRE))
+         return;
+      #if defined(__i386__) || defined(__x86_64__)
+      __builtin_ia32_pause();
+      #endif
+   }
+
+   while (!__atomic_load_n(&m_futx, __ATOMIC_ACQUIRE))
+   {
+      // Returns immediately if we were signaled in the mean time, restarts if interrupted by a signal
+      syscall(SYS_futex, (void*) &m_futx, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, 0, NULL, NULL, 0);
+   }
+}
+
+void WakeupEvent::signal()
+{
+   __atomic_store_n(&m_futx, 1, __ATOMIC_RELEASE);
+
+   syscall(SYS_futex, (void*) &m_futx, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+}
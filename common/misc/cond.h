@@ -27,4 +27,24 @@ class ConditionVariable
       #endif
 };
 
+// Wakes up one thread that waits without holding the lock that protects its wakeup condition.
+// The waiter calls arm() while still holding that lock, so a signal() that follows cannot be lost,
+// and then wait()s without the lock, which does not have to be re-acquired on wakeup.
+// Waiting spins for a short while before sleeping in the kernel.
+
+class WakeupEvent
+{
+   public:
+      WakeupEvent();
+      ~WakeupEvent();
+
+      void arm();
+      void wait();
+      void signal();
+
+   private:
+      static const UInt32 SPIN_COUNT = 4096;
+      volatile int m_futx;
+};
+
 #endif // COND_H
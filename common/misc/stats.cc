@@ -1,4 +1,5 @@
 #include "stats.h"
+#include "stats_columns.h"
 #include "simulator.h"
 #include "hooks_manager.h"
 #include "utils.h"
@@ -22,15 +23,22 @@ const char* db_create_stmts[] = {
    "CREATE TABLE `names` (nameid INTEGER, objectname TEXT, metricname TEXT);",
    "CREATE TABLE `prefixes` (prefixid INTEGER, prefixname TEXT);",
    "CREATE TABLE `values` (prefixid INTEGER, nameid INTEGER, core INTEGER, value INTEGER);",
+   // Values are stored in sim.stats.columns: snapshot <prefixid> holds <value> for (nameid, core) in column <columnid>
+   "CREATE TABLE `columns` (columnid INTEGER, nameid INTEGER, core INTEGER);",
+   // Snapshots <firstprefixid> up to <lastprefixid> are in the chunk at <chunkoffset> of sim.stats.columns,
+   // later ones are still in memory. Rewritten when a compaction moves the chunks.
+   "CREATE TABLE `chunks` (chunkoffset INTEGER, firstprefixid INTEGER, lastprefixid INTEGER);",
    "CREATE INDEX `idx_prefix_name` ON `prefixes`(`prefixname`);",
    "CREATE INDEX `idx_value_prefix` ON `values`(`prefixid`);",
+   "CREATE INDEX `idx_chunk_prefix` ON `chunks`(`firstprefixid`);",
    // Other users
    "CREATE TABLE `topology` (componentname TEXT, coreid INTEGER, masterid INTEGER);",
    "CREATE TABLE `event` (event INTEGER, time INTEGER, core INTEGER, thread INTEGER, value0 INTEGER, value1 INTEGER, description TEXT);",
 };
 const char db_insert_stmt_name[] = "INSERT INTO `names` (nameid, objectname, metricname) VALUES (?, ?, ?);";
 const char db_insert_stmt_prefix[] = "INSERT INTO `prefixes` (prefixid, prefixname) VALUES (?, ?);";
-const char db_insert_stmt_value[] = "INSERT INTO `values` (prefixid, nameid, core, value) VALUES (?, ?, ?, ?);";
+const char db_insert_stmt_column[] = "INSERT INTO `columns` (columnid, nameid, core) VALUES (?, ?, ?);";
+const char db_insert_stmt_chunk[] = "INSERT INTO `chunks` (chunkoffset, firstprefixid, lastprefixid) VALUES (?, ?, ?);";
 
 UInt64 getWallclockTimeCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
 {
@@ -44,6 +52,10 @@ StatsManager::StatsManager()
    : m_keyid(0)
    , m_prefixnum(0)
    , m_db(NULL)
+   , m_columns_written(0)
+   , m_columns(NULL)
+   , m_chunks_written(0)
+   , m_chunks_generation(0)
 {
    init();
 
@@ -52,16 +64,28 @@ StatsManager::StatsManager()
 
 StatsManager::~StatsManager()
 {
-   for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
-      for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
-         for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
-            delete it3->second;
+   for(std::vector<StatsMetricBase *>::iterator it = m_metrics.begin(); it != m_metrics.end(); ++it)
+      delete *it;
+
+   // Writes out the last, partial chunk
+   if (m_columns)
+   {
+      m_columns->flush();
+      if (m_db)
+      {
+         sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
+         recordChunks();
+         sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+      }
+   }
+   delete m_columns;
 
    if (m_db)
    {
       sqlite3_finalize(m_stmt_insert_name);
       sqlite3_finalize(m_stmt_insert_prefix);
-      sqlite3_finalize(m_stmt_insert_value);
+      sqlite3_finalize(m_stmt_insert_column);
+      sqlite3_finalize(m_stmt_insert_chunk);
       sqlite3_close(m_db);
    }
 }
@@ -88,7 +112,10 @@ StatsManager::init()
 
    sqlite3_prepare(m_db, db_insert_stmt_name, -1, &m_stmt_insert_name, NULL);
    sqlite3_prepare(m_db, db_insert_stmt_prefix, -1, &m_stmt_insert_prefix, NULL);
-   sqlite3_prepare(m_db, db_insert_stmt_value, -1, &m_stmt_insert_value, NULL);
+   sqlite3_prepare(m_db, db_insert_stmt_column, -1, &m_stmt_insert_column, NULL);
+   sqlite3_prepare(m_db, db_insert_stmt_chunk, -1, &m_stmt_insert_chunk, NULL);
+
+   m_columns = new StatsColumnWriter(Sim()->getConfig()->formatOutputFileName("sim.stats.columns"));
 
    sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
    for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
@@ -125,6 +152,49 @@ StatsManager::recordMetricName(UInt64 keyId, std::string objectName, std::string
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement");
 }
 
+void
+StatsManager::recordColumns()
+{
+   // Column records are written lazily, in the transaction of the first snapshot that has them
+   for( ; m_columns_written < m_metrics.size(); ++m_columns_written)
+   {
+      StatsMetricBase *metric = m_metrics[m_columns_written];
+      std::string _objectName(metric->objectName.c_str()), _metricName(metric->metricName.c_str());
+      int res;
+      sqlite3_reset(m_stmt_insert_column);
+      sqlite3_bind_int64(m_stmt_insert_column, 1, metric->column);
+      sqlite3_bind_int(m_stmt_insert_column, 2, m_objects[_objectName][_metricName].first);  // Metric ID
+      sqlite3_bind_int(m_stmt_insert_column, 3, metric->index);                              // Core ID
+      res = sqlite3_step(m_stmt_insert_column);
+      LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+   }
+}
+
+void
+StatsManager::recordChunks()
+{
+   // A compaction moved all chunks: index them again
+   if (m_chunks_generation != m_columns->getGeneration())
+   {
+      int res = sqlite3_exec(m_db, "DELETE FROM `chunks`", NULL, NULL, NULL);
+      LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+      m_chunks_written = 0;
+      m_chunks_generation = m_columns->getGeneration();
+   }
+
+   const std::vector<StatsColumnWriter::chunk_t> &chunks = m_columns->getChunks();
+   for( ; m_chunks_written < chunks.size(); ++m_chunks_written)
+   {
+      int res;
+      sqlite3_reset(m_stmt_insert_chunk);
+      sqlite3_bind_int64(m_stmt_insert_chunk, 1, chunks[m_chunks_written].offset);
+      sqlite3_bind_int64(m_stmt_insert_chunk, 2, chunks[m_chunks_written].first_snapshot);
+      sqlite3_bind_int64(m_stmt_insert_chunk, 3, chunks[m_chunks_written].last_snapshot);
+      res = sqlite3_step(m_stmt_insert_chunk);
+      LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+   }
+}
+
 void
 StatsManager::recordStats(String prefix)
 {
@@ -136,6 +206,12 @@ StatsManager::recordStats(String prefix)
    int res;
    int prefixid = ++m_prefixnum;
 
+   m_snapshot.resize(m_metrics.size());
+   for(UInt64 column = 0; column < m_metrics.size(); ++column)
+      m_snapshot[column] = m_metrics[column]->recordMetric();
+   // The snapshot stays in memory until its chunk is full, readStats() serves it from there
+   m_columns->append(prefixid, m_snapshot);
+
    res = sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
    LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 
@@ -145,25 +221,51 @@ StatsManager::recordStats(String prefix)
    res = sqlite3_step(m_stmt_insert_prefix);
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 
-   for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
+   recordColumns();
+   recordChunks();
+
+   res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+   LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+}
+
+bool
+StatsManager::readStats(UInt64 prefixid, std::vector<UInt64> &values)
+{
+   return m_columns->read(prefixid, values);
+}
+
+void
+StatsManager::deleteStats(String prefix)
+{
+   LOG_ASSERT_ERROR(m_db, "m_db not yet set up !?");
+
+   int res;
+   res = sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
+   LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+
+   sqlite3_stmt *stmt;
+   sqlite3_prepare(m_db, "SELECT prefixid FROM `prefixes` WHERE prefixname = ?;", -1, &stmt, NULL);
+   sqlite3_bind_text(stmt, 1, prefix.c_str(), -1, SQLITE_TRANSIENT);
+   while ((res = sqlite3_step(stmt)) == SQLITE_ROW)
+      m_columns->remove(sqlite3_column_int64(stmt, 0));
+   LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+   sqlite3_finalize(stmt);
+
+   const char *delete_stmts[] = {
+      "DELETE FROM `values` WHERE prefixid IN (SELECT prefixid FROM `prefixes` WHERE prefixname = ?);",
+      "DELETE FROM `prefixes` WHERE prefixname = ?;",
+   };
+   for(unsigned int i = 0; i < sizeof(delete_stmts)/sizeof(delete_stmts[0]); ++i)
    {
-      for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
-      {
-         for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
-         {
-            if (!it3->second->isDefault())
-            {
-               sqlite3_reset(m_stmt_insert_value);
-               sqlite3_bind_int(m_stmt_insert_value, 1, prefixid);
-               sqlite3_bind_int(m_stmt_insert_value, 2, it2->second.first);   // Metric ID
-               sqlite3_bind_int(m_stmt_insert_value, 3, it3->second->index);  // Core ID
-               sqlite3_bind_int64(m_stmt_insert_value, 4, it3->second->recordMetric());
-               res = sqlite3_step(m_stmt_insert_value);
-               LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
-            }
-         }
-      }
+      sqlite3_prepare(m_db, delete_stmts[i], -1, &stmt, NULL);
+      sqlite3_bind_text(stmt, 1, prefix.c_str(), -1, SQLITE_TRANSIENT);
+      res = sqlite3_step(stmt);
+      LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+      sqlite3_finalize(stmt);
    }
+
+   recordChunks();
+
    res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
    LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 }
@@ -176,6 +278,8 @@ StatsManager::registerMetric(StatsMetricBase *metric)
    LOG_ASSERT_ERROR(m_objects[_objectName][_metricName].second.count(metric->index) == 0,
       "Duplicate statistic %s.%s[%d]", _objectName.c_str(), _metricName.c_str(), metric->index);
    m_objects[_objectName][_metricName].second[metric->index] = metric;
+   metric->column = m_metrics.size();
+   m_metrics.push_back(metric);
 
    if (m_objects[_objectName][_metricName].first == 0)
    {
@@ -234,6 +338,58 @@ StatsManager::logEvent(event_type_t event, SubsecondTime time, core_id_t core_id
    sqlite3_finalize(stmt);
 }
 
+StatsDelta::StatsDelta(UInt32 num_indices)
+   : m_num_indices(num_indices)
+   , m_unresolved(0)
+   , m_first(true)
+{
+}
+
+UInt32
+StatsDelta::add(String objectName, String metricName)
+{
+   UInt32 row = m_names.size();
+   m_names.push_back(std::make_pair(objectName, metricName));
+   m_metrics.resize(m_metrics.size() + m_num_indices, NULL);
+   m_values.resize(m_metrics.size(), 0);
+   m_deltas.resize(m_metrics.size(), 0);
+   m_unresolved += m_num_indices;
+   return row;
+}
+
+void
+StatsDelta::resolve()
+{
+   // Statistics can be registered late (by scripts, or lazily by components), look up the missing ones again
+   m_unresolved = 0;
+   for(UInt32 row = 0; row < m_names.size(); ++row)
+      for(UInt32 index = 0; index < m_num_indices; ++index)
+         if (!m_metrics[row * m_num_indices + index])
+         {
+            m_metrics[row * m_num_indices + index] = Sim()->getStatsManager()->getMetricObject(m_names[row].first, index, m_names[row].second);
+            if (!m_metrics[row * m_num_indices + index])
+               ++m_unresolved;
+         }
+}
+
+bool
+StatsDelta::update()
+{
+   if (m_unresolved)
+      resolve();
+
+   for(UInt32 i = 0; i < m_metrics.size(); ++i)
+   {
+      UInt64 value = m_metrics[i] ? m_metrics[i]->recordMetric() : 0;
+      m_deltas[i] = value - m_values[i];
+      m_values[i] = value;
+   }
+
+   bool first = m_first;
+   m_first = false;
+   return !first;
+}
+
 StatHist &
 StatHist::operator += (StatHist & stat)
 {
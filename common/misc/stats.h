@@ -4,16 +4,20 @@
 #include "itostr.h"
 
 #include <cstring>
+#include <vector>
 #include <sqlite3.h>
 
+class StatsColumnWriter;
+
 class StatsMetricBase
 {
    public:
       String objectName;
       UInt32 index;
       String metricName;
+      UInt64 column; // Position in the StatsManager registry and in every snapshot
       StatsMetricBase(String _objectName, UInt32 _index, String _metricName) :
-         objectName(_objectName), index(_index), metricName(_metricName)
+         objectName(_objectName), index(_index), metricName(_metricName), column(0)
       {}
       virtual ~StatsMetricBase() {}
       virtual UInt64 recordMetric() = 0;
@@ -72,6 +76,10 @@ class StatsManager
       ~StatsManager();
       void init();
       void recordStats(String prefix);
+      // Values of a snapshot that is not in sim.stats.columns yet, indexed by column; false once it is written out
+      bool readStats(UInt64 prefixid, std::vector<UInt64> &values);
+      // Drop all snapshots named prefix, from sim.stats.sqlite3 and sim.stats.columns
+      void deleteStats(String prefix);
       void registerMetric(StatsMetricBase *metric);
       StatsMetricBase *getMetricObject(String objectName, UInt32 index, String metricName);
       void logTopology(String component, core_id_t core_id, core_id_t master_id);
@@ -86,7 +94,16 @@ class StatsManager
       sqlite3 *m_db;
       sqlite3_stmt *m_stmt_insert_name;
       sqlite3_stmt *m_stmt_insert_prefix;
-      sqlite3_stmt *m_stmt_insert_value;
+      sqlite3_stmt *m_stmt_insert_column;
+      sqlite3_stmt *m_stmt_insert_chunk;
+
+      // Flat registry: snapshots are taken by walking it in order, and their values go to the columnar store
+      std::vector<StatsMetricBase *> m_metrics;
+      UInt64 m_columns_written;
+      std::vector<UInt64> m_snapshot;
+      StatsColumnWriter *m_columns;
+      UInt64 m_chunks_written;
+      UInt64 m_chunks_generation;
 
       // Use std::string here because String (__versa_string) does not provide a hash function for STL containers with gcc < 4.6
       typedef std::unordered_map<UInt64, StatsMetricBase *> StatsIndexList;
@@ -99,6 +116,8 @@ class StatsManager
       int busy_handler(int count);
 
       void recordMetricName(UInt64 keyId, std::string objectName, std::string metricName);
+      void recordColumns();
+      void recordChunks();
 };
 
 template <class T> void registerStatsMetric(String objectName, UInt32 index, String metricName, T *metric)
@@ -107,6 +126,37 @@ template <class T> void registerStatsMetric(String objectName, UInt32 index, Str
 }
 
 
+// Bulk view on statistics for native periodic observers: a [metric][index] matrix of values, refreshed in one sweep
+class StatsDelta
+{
+   public:
+      StatsDelta(UInt32 num_indices);
+
+      // Track objectName.metricName for indices 0 .. num_indices-1 and return its row. Indices without such a statistic read as zero.
+      UInt32 add(String objectName, String metricName);
+      // Read all values. Returns false on the first call, when no deltas are available yet
+      bool update();
+
+      UInt32 getNumIndices() const { return m_num_indices; }
+      UInt32 getNumRows() const { return m_names.size(); }
+      const UInt64* getValues(UInt32 row) const { return &m_values[row * m_num_indices]; }
+      const UInt64* getDeltas(UInt32 row) const { return &m_deltas[row * m_num_indices]; }
+      // All rows at once, row-major
+      const std::vector<UInt64>& getDeltas() const { return m_deltas; }
+
+   private:
+      const UInt32 m_num_indices;
+      std::vector<std::pair<String, String> > m_names;
+      std::vector<StatsMetricBase *> m_metrics;  // NULL while not registered (yet)
+      UInt32 m_unresolved;
+      std::vector<UInt64> m_values;
+      std::vector<UInt64> m_deltas;
+      bool m_first;
+
+      void resolve();
+};
+
+
 class StatHist {
   private:
     static const int HIST_MAX = 20;
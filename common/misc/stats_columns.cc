@@ -0,0 +1,277 @@
+#include "stats_columns.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+const char StatsColumnWriter::MAGIC[8] = { 'S', 'N', 'I', 'P', 'S', 'T', 'C', 'L' };
+
+// The file is grown in steps of at least this size, and mapped again each time
+static const size_t GROW_SIZE = 16 << 20;
+
+StatsColumnWriter::StatsColumnWriter(String filename, UInt32 chunk_snapshots)
+   : m_chunk_snapshots(chunk_snapshots)
+   , m_map(NULL)
+   , m_capacity(0)
+   , m_size(0)
+   , m_generation(0)
+   , m_num_live(0)
+   , m_num_removed(0)
+{
+   m_fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+   LOG_ASSERT_ERROR(m_fd >= 0, "Cannot create %s", filename.c_str());
+
+   file_header_t header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, MAGIC, sizeof(header.magic));
+   header.version = VERSION;
+   header.size = sizeof(header);
+   write(&header, sizeof(header));
+}
+
+StatsColumnWriter::~StatsColumnWriter()
+{
+   flush();
+   if (m_map)
+      munmap(m_map, m_capacity);
+   // Drop the unused tail of the last growth step
+   if (ftruncate(m_fd, m_size) != 0)
+      LOG_PRINT_WARNING("Cannot truncate statistics file");
+   close(m_fd);
+}
+
+void
+StatsColumnWriter::append(UInt64 snapshot, const std::vector<UInt64> &values)
+{
+   LOG_ASSERT_ERROR((m_pending_ids.empty() || snapshot > m_pending_ids.back())
+                    && (m_chunks.empty() || snapshot > m_chunks.back().last_snapshot),
+                    "Statistics snapshots must be increasing");
+
+   m_pending_ids.push_back(snapshot);
+   m_pending.push_back(values);
+   if (m_pending.size() == m_chunk_snapshots)
+      flush();
+}
+
+bool
+StatsColumnWriter::read(UInt64 snapshot, std::vector<UInt64> &values) const
+{
+   std::vector<UInt64>::const_iterator it = std::lower_bound(m_pending_ids.begin(), m_pending_ids.end(), snapshot);
+   if (it == m_pending_ids.end() || *it != snapshot)
+      return false;
+   values = m_pending[it - m_pending_ids.begin()];
+   return true;
+}
+
+void
+StatsColumnWriter::remove(UInt64 snapshot)
+{
+   std::vector<UInt64>::iterator it = std::lower_bound(m_pending_ids.begin(), m_pending_ids.end(), snapshot);
+   if (it != m_pending_ids.end() && *it == snapshot)
+   {
+      m_pending.erase(m_pending.begin() + (it - m_pending_ids.begin()));
+      m_pending_ids.erase(it);
+      return;
+   }
+
+   std::vector<chunk_t>::iterator chunk = std::lower_bound(m_chunks.begin(), m_chunks.end(), snapshot,
+      [](const chunk_t &chunk, UInt64 snapshot) { return chunk.last_snapshot < snapshot; });
+   // Snapshot ids in a chunk need not be consecutive, only count ids we have not seen yet
+   if (chunk != m_chunks.end() && chunk->first_snapshot <= snapshot && m_removed.insert(snapshot).second)
+   {
+      ++chunk->num_removed;
+      --m_num_live;
+      ++m_num_removed;
+   }
+
+   // Rewriting costs about as much as the live snapshots, so this amortizes to a constant per removal
+   if (m_num_removed >= m_chunk_snapshots && m_num_removed > m_num_live)
+      compact();
+}
+
+void
+StatsColumnWriter::flush()
+{
+   if (m_pending.empty())
+      return;
+
+   writeChunk(m_pending_ids, m_pending);
+   publish();
+
+   m_pending_ids.clear();
+   m_pending.clear();
+}
+
+void
+StatsColumnWriter::writeChunk(const std::vector<UInt64> &ids, const std::vector<std::vector<UInt64> > &rows)
+{
+   UInt32 num_columns = 0;
+   for(std::vector<std::vector<UInt64> >::const_iterator it = rows.begin(); it != rows.end(); ++it)
+      num_columns = std::max(num_columns, (UInt32)it->size());
+
+   // Encode each column as the deltas between consecutive snapshots, starting from zero in every chunk
+   std::vector<UInt32> offsets(num_columns + 1);
+   m_buffer.clear();
+   for(UInt32 column = 0; column < num_columns; ++column)
+   {
+      offsets[column] = m_buffer.size();
+      UInt64 last = 0;
+      for(std::vector<std::vector<UInt64> >::const_iterator it = rows.begin(); it != rows.end(); ++it)
+      {
+         UInt64 value = column < it->size() ? (*it)[column] : 0;
+         SInt64 delta = value - last;
+         last = value;
+         // Zigzag, so small negative deltas stay small, then varint
+         UInt64 encoded = (UInt64(delta) << 1) ^ UInt64(delta >> 63);
+         while (encoded >= 0x80)
+         {
+            m_buffer.push_back(UInt8(encoded) | 0x80);
+            encoded >>= 7;
+         }
+         m_buffer.push_back(UInt8(encoded));
+      }
+   }
+   offsets[num_columns] = m_buffer.size();
+
+   chunk_header_t header;
+   header.num_snapshots = ids.size();
+   header.num_columns = num_columns;
+   header.size = ids.size() * sizeof(UInt64) + offsets.size() * sizeof(UInt32) + m_buffer.size();
+   // Pad to keep the next chunk header and snapshot list aligned
+   UInt32 padding = (8 - header.size % 8) % 8;
+   header.size += padding;
+
+   chunk_t chunk;
+   chunk.offset = m_size;
+   chunk.first_snapshot = ids.front();
+   chunk.last_snapshot = ids.back();
+   chunk.num_snapshots = ids.size();
+   chunk.num_removed = 0;
+   m_chunks.push_back(chunk);
+   m_num_live += ids.size();
+
+   reserve(sizeof(header) + header.size);
+   write(&header, sizeof(header));
+   write(ids.data(), ids.size() * sizeof(UInt64));
+   write(offsets.data(), offsets.size() * sizeof(UInt32));
+   write(m_buffer.data(), m_buffer.size());
+   static const UInt8 zeros[8] = { 0 };
+   write(zeros, padding);
+}
+
+void
+StatsColumnWriter::readChunk(const chunk_t &chunk, std::vector<UInt64> &ids, std::vector<std::vector<UInt64> > &rows) const
+{
+   const chunk_header_t *header = (const chunk_header_t *)(m_map + chunk.offset);
+   const UInt64 *snapshots = (const UInt64 *)(header + 1);
+   const UInt32 *offsets = (const UInt32 *)(snapshots + header->num_snapshots);
+   const UInt8 *data = (const UInt8 *)(offsets + header->num_columns + 1);
+
+   ids.assign(snapshots, snapshots + header->num_snapshots);
+   rows.assign(header->num_snapshots, std::vector<UInt64>(header->num_columns));
+   for(UInt32 column = 0; column < header->num_columns; ++column)
+   {
+      const UInt8 *ptr = data + offsets[column];
+      UInt64 value = 0;
+      for(UInt32 idx = 0; idx < header->num_snapshots; ++idx)
+      {
+         UInt64 encoded = 0;
+         for(UInt32 shift = 0; ; shift += 7)
+         {
+            encoded |= UInt64(*ptr & 0x7f) << shift;
+            if (*ptr++ < 0x80)
+               break;
+         }
+         // Undo zigzag, then the delta against the previous snapshot
+         value += (encoded >> 1) ^ -(encoded & 1);
+         rows[idx][column] = value;
+      }
+   }
+}
+
+void
+StatsColumnWriter::compact()
+{
+   // Collect the live snapshots of all written chunks, their values read back the same after the rewrite
+   std::vector<UInt64> live_ids;
+   std::vector<std::vector<UInt64> > live_rows;
+   for(std::vector<chunk_t>::const_iterator chunk = m_chunks.begin(); chunk != m_chunks.end(); ++chunk)
+   {
+      if (chunk->num_removed == chunk->num_snapshots)
+         continue;
+      std::vector<UInt64> ids;
+      std::vector<std::vector<UInt64> > rows;
+      readChunk(*chunk, ids, rows);
+      for(UInt32 idx = 0; idx < ids.size(); ++idx)
+      {
+         if (m_removed.count(ids[idx]) == 0)
+         {
+            live_ids.push_back(ids[idx]);
+            live_rows.push_back(rows[idx]);
+         }
+      }
+   }
+
+   // Rewrite them after the file header, in chunks of the usual size. Readers see no chunks until that is done.
+   m_size = sizeof(file_header_t);
+   ++m_generation;
+   ((file_header_t*)m_map)->generation = m_generation;
+   publish();
+   m_chunks.clear();
+   m_removed.clear();
+   m_num_live = 0;
+   m_num_removed = 0;
+   for(UInt64 start = 0; start < live_ids.size(); start += m_chunk_snapshots)
+   {
+      UInt64 end = std::min(start + m_chunk_snapshots, (UInt64)live_ids.size());
+      writeChunk(std::vector<UInt64>(live_ids.begin() + start, live_ids.begin() + end),
+                 std::vector<std::vector<UInt64> >(live_rows.begin() + start, live_rows.begin() + end));
+   }
+   publish();
+
+   // Give back the space of the garbage, keeping one growth step
+   if (m_capacity > m_size + GROW_SIZE)
+   {
+      munmap(m_map, m_capacity);
+      m_map = NULL;
+      m_capacity = 0;
+      size_t size = m_size;
+      m_size = 0;
+      reserve(size + GROW_SIZE);
+      m_size = size;
+   }
+}
+
+void
+StatsColumnWriter::publish()
+{
+   // Publish the chunks to readers only once all of them are in place
+   __sync_synchronize();
+   ((file_header_t*)m_map)->size = m_size;
+}
+
+void
+StatsColumnWriter::write(const void *data, size_t size)
+{
+   reserve(size);
+   memcpy(m_map + m_size, data, size);
+   m_size += size;
+}
+
+void
+StatsColumnWriter::reserve(size_t size)
+{
+   if (m_size + size <= m_capacity)
+      return;
+
+   if (m_map)
+      munmap(m_map, m_capacity);
+   m_capacity = std::max(m_capacity + GROW_SIZE, m_size + size);
+   int res = ftruncate(m_fd, m_capacity);
+   LOG_ASSERT_ERROR(res == 0, "Cannot grow statistics file to %lu bytes", m_capacity);
+   m_map = (char*)mmap(NULL, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+   LOG_ASSERT_ERROR(m_map != MAP_FAILED, "Cannot map statistics file");
+}
@@ -0,0 +1,95 @@
+#ifndef __STATS_COLUMNS_H
+#define __STATS_COLUMNS_H
+
+#include "fixed_types.h"
+
+#include <set>
+#include <vector>
+
+// Columnar store for statistics snapshots (sim.stats.columns)
+//
+// A snapshot holds the value of every registered statistic, indexed by the position of that statistic
+// in the StatsManager registry (its column). Snapshots are collected in an open chunk, which is written out
+// once it holds chunk_snapshots snapshots, or on flush(). Until then, read() returns them from memory.
+// Within a chunk, each column is stored on its own as the zigzag/varint-encoded deltas between
+// consecutive snapshots, so a reader can extract one metric without decoding any of the others.
+//
+// File layout (host byte order):
+//   file_header_t                                                                (size: bytes of valid data, header included)
+//   chunk_header_t, UInt64 snapshots[num_snapshots], UInt32 offsets[num_columns + 1], column data   (repeated)
+// snapshots lists the (increasing, not necessarily consecutive) snapshot ids in the chunk.
+// offsets[c] is the start of column c relative to the column data, offsets[num_columns] its total size.
+// A column not present in a chunk (registered after that chunk was written) reads as all zeros.
+// The file is grown ahead of the data and is only cut to size at the end, so while the simulation runs,
+// readers must stop at file_header_t::size rather than at the end of the file.
+//
+// Removed snapshots are dropped from the open chunk, or counted as garbage in the chunk that holds them.
+// Once written chunks hold more garbage than live snapshots, they are all rewritten without it. This moves
+// chunks around, getGeneration() (also in file_header_t) tells when their offsets have to be looked up again.
+
+class StatsColumnWriter
+{
+   public:
+      static const char MAGIC[8];
+      static const UInt32 VERSION = 3;
+
+      typedef struct {
+         char magic[8];
+         UInt32 version;
+         UInt32 generation;  // Incremented when chunks are moved by a compaction
+         UInt64 size;        // Updated after each chunk is complete
+      } file_header_t;
+
+      typedef struct {
+         UInt32 num_snapshots;
+         UInt32 num_columns;
+         UInt64 size;  // Size of the snapshot list, offset table and column data that follow, padded to 8 bytes
+      } chunk_header_t;
+
+      typedef struct {
+         UInt64 offset;  // Of the chunk_header_t in the file
+         UInt64 first_snapshot;
+         UInt64 last_snapshot;
+         UInt32 num_snapshots;
+         UInt32 num_removed;
+      } chunk_t;
+
+      StatsColumnWriter(String filename, UInt32 chunk_snapshots = 64);
+      ~StatsColumnWriter();
+
+      // Snapshot ids must be increasing
+      void append(UInt64 snapshot, const std::vector<UInt64> &values);
+      // Returns false if the snapshot is not in the open chunk
+      bool read(UInt64 snapshot, std::vector<UInt64> &values) const;
+      void remove(UInt64 snapshot);
+      void flush();
+
+      const std::vector<chunk_t>& getChunks() const { return m_chunks; }
+      UInt64 getGeneration() const { return m_generation; }
+
+   private:
+      const UInt32 m_chunk_snapshots;
+      int m_fd;
+      char *m_map;
+      size_t m_capacity;
+      size_t m_size;
+
+      std::vector<UInt64> m_pending_ids;
+      std::vector<std::vector<UInt64> > m_pending;
+      std::vector<UInt8> m_buffer;
+
+      std::vector<chunk_t> m_chunks;
+      UInt64 m_generation;
+      UInt64 m_num_live;     // Snapshots in written chunks that were not removed
+      UInt64 m_num_removed;  // Snapshots in written chunks that were removed
+      std::set<UInt64> m_removed;
+
+      void writeChunk(const std::vector<UInt64> &ids, const std::vector<std::vector<UInt64> > &rows);
+      void readChunk(const chunk_t &chunk, std::vector<UInt64> &ids, std::vector<std::vector<UInt64> > &rows) const;
+      void compact();
+      void publish();
+      void write(const void *data, size_t size);
+      void reserve(size_t size);
+};
+
+#endif // __STATS_COLUMNS_H
@@ -50,6 +50,10 @@ Network::~Network()
    delete [] _callbackObjs;
    delete [] _callbacks;
 
+   // Packets nobody received still hold their transport buffers
+   for (NetQueue::iterator it = _netQueue.begin(); it != _netQueue.end(); ++it)
+      releasePacket(*it);
+
    delete _transport;
 
    LOG_PRINT("Destroyed.");
@@ -95,8 +99,7 @@ void Network::netPullFromTransport()
          // if this isn't a broadcast message, then we shouldn't process it further
          if (packet.receiver != NetPacket::BROADCAST)
          {
-            if (packet.length > 0)
-               delete [] (Byte*) packet.data;
+            releasePacket(packet);
             continue;
          }
       }
@@ -117,8 +120,7 @@ void Network::netPullFromTransport()
 
          callback(_callbackObjs[packet.type], packet);
 
-         if (packet.length > 0)
-            delete [] (Byte*) packet.data;
+         releasePacket(packet);
       }
 
       // synchronous I/O support
@@ -142,14 +144,25 @@ void Network::forwardPacket(NetPacket& packet)
    netSend(packet);
 }
 
+void Network::releasePacket(const NetPacket& packet)
+{
+   _transport->release((Byte*) packet.data - sizeof(NetPacket));
+}
+
 NetworkModel* Network::getNetworkModelFromPacketType(PacketType packet_type)
 {
    return _models[g_type_to_static_network_map[packet_type]];
 }
 
 SInt32 Network::netSend(NetPacket& packet)
+{
+   return netSend(packet, NULL, 0);
+}
+
+SInt32 Network::netSend(NetPacket& packet, const void *trailer, UInt32 trailer_length)
 {
    assert(packet.type >= 0 && packet.type < NUM_PACKET_TYPES);
+   assert(trailer_length <= packet.length);
 
    NetworkModel *model = _models[g_type_to_static_network_map[packet.type]];
 
@@ -158,7 +171,8 @@ SInt32 Network::netSend(NetPacket& packet)
    std::vector<NetworkModel::Hop> hopVec;
    model->routePacket(packet, hopVec);
 
-   Byte *buffer = packet.makeBuffer();
+   // Header as sent, the payload is copied straight from packet.data by the transport
+   NetPacket header = packet;
    SubsecondTime start_time = packet.time;
 
    for (UInt32 i = 0; i < hopVec.size(); i++)
@@ -188,21 +202,17 @@ SInt32 Network::netSend(NetPacket& packet)
          }
       }
 
-      NetPacket* buff_pkt = (NetPacket*) buffer;
-
-      if (_core->getId() == buff_pkt->sender)
-         buff_pkt->start_time = start_time;
+      if (_core->getId() == header.sender)
+         header.start_time = start_time;
 
-      buff_pkt->time = hopVec[i].time;
-      buff_pkt->receiver = hopVec[i].final_dest;
+      header.time = hopVec[i].time;
+      header.receiver = hopVec[i].final_dest;
 
-      _transport->send(hopVec[i].next_dest, buffer, packet.bufferSize());
+      _transport->send(hopVec[i].next_dest, &header, sizeof(header), packet.data, packet.length - trailer_length, trailer, trailer_length);
 
       LOG_PRINT("Sent packet");
    }
 
-   delete [] buffer;
-
    return packet.length;
 }
 
@@ -510,14 +520,8 @@ NetPacket::NetPacket(Byte *buffer)
    memcpy(this, buffer, sizeof(*this));
 
    // LOG_ASSERT_ERROR(length > 0, "type(%u), sender(%i), receiver(%i), length(%u)", type, sender, receiver, length);
-   if (length > 0)
-   {
-      Byte* data_buffer = new Byte[length];
-      memcpy(data_buffer, buffer + sizeof(*this), length);
-      data = data_buffer;
-   }
-
-   delete [] buffer;
+   // The payload is not copied, it stays in the transport buffer until Network::releasePacket
+   data = buffer + sizeof(*this);
 }
 
 // This implementation is slightly wasteful because there is no need
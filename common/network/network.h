@@ -83,7 +83,14 @@ class Network
       // -- Main interface -- //
 
       SInt32 netSend(NetPacket& packet);
+      // Same, but the last trailer_length bytes of the payload are at trailer rather than at the end of packet.data:
+      // both parts are copied straight into the transport buffer, the receiver sees them as one payload
+      SInt32 netSend(NetPacket& packet, const void *trailer, UInt32 trailer_length);
+      // Packets returned by netRecv (and its wrappers below) point into a transport buffer:
+      // pass them to releasePacket when done. Their data was not allocated with new [],
+      // so delete [] on it corrupts the heap.
       NetPacket netRecv(const NetMatch &match, UInt64 timeout_ns = 0);
+      void releasePacket(const NetPacket& packet);
 
       // -- Wrappers -- //
 
@@ -9,6 +9,7 @@
 #include "dvfs_manager.h"
 #include "stats.h"
 #include "config.hpp"
+#include "core_manager.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -25,9 +26,14 @@ const char* OutputDirectionString(NetworkModelEMeshHopByHop::OutputDirection dir
    return output_direction_names[direction];
 }
 
+NetworkModelEMeshHopByHop::RouteTable *NetworkModelEMeshHopByHop::s_route_tables[NUM_STATIC_NETWORKS] = { NULL };
+Lock NetworkModelEMeshHopByHop::s_route_tables_lock;
+
 NetworkModelEMeshHopByHop::NetworkModelEMeshHopByHop(Network* net, EStaticNetwork net_type):
    NetworkModel(net, net_type),
    m_enabled(false),
+   m_net_type(net_type),
+   m_route_table(NULL),
    m_total_bytes_sent(0),
    m_total_packets_sent(0),
    m_total_bytes_received(0),
@@ -84,6 +90,9 @@ NetworkModelEMeshHopByHop::NetworkModelEMeshHopByHop(Network* net, EStaticNetwor
 
    computeMeshDimensions(m_mesh_width, m_mesh_height);
 
+   // Non-master nodes route through the table as well, from their master onwards
+   acquireRouteTable();
+
    if (m_core_id % m_concentration != 0 || m_core_id >= m_concentration * m_mesh_width * m_mesh_height)
    {
       m_fake_node = true;
@@ -95,6 +104,8 @@ NetworkModelEMeshHopByHop::NetworkModelEMeshHopByHop(Network* net, EStaticNetwor
 
 NetworkModelEMeshHopByHop::~NetworkModelEMeshHopByHop()
 {
+   releaseRouteTable();
+
    if (m_fake_node)
       return;
 
@@ -123,12 +134,117 @@ NetworkModelEMeshHopByHop::createQueueModels(String name)
    m_ejection_port_queue_model = QueueModel::create(name+".link-out", m_core_id, m_queue_model_type, min_processing_time);
 }
 
+void
+NetworkModelEMeshHopByHop::acquireRouteTable()
+{
+   ScopedLock sl(s_route_tables_lock);
+
+   m_route_table = s_route_tables[m_net_type];
+   if (!m_route_table)
+   {
+      // Routing only depends on the configuration, so the first node builds the table for all of them.
+      // This takes O(N^2) space in total, rather than O(N^2 * (W+H)) for a full route per node and destination.
+      m_route_table = new RouteTable();
+      m_route_table->num_cores = Config::getSingleton()->getTotalCores();
+      m_route_table->next.resize(m_route_table->num_cores * m_route_table->num_cores);
+      m_route_table->direction.resize(m_route_table->num_cores * m_route_table->num_cores);
+      m_route_table->models.resize(m_route_table->num_cores, NULL);
+      m_route_table->users = 0;
+
+      for (core_id_t from = 0; from < m_route_table->num_cores; from++)
+      {
+         for (core_id_t dest = 0; dest < m_route_table->num_cores; dest++)
+         {
+            OutputDirection direction;
+            m_route_table->next[from * m_route_table->num_cores + dest] = getNextDest(from, dest, direction);
+            m_route_table->direction[from * m_route_table->num_cores + dest] = direction;
+         }
+      }
+
+      s_route_tables[m_net_type] = m_route_table;
+   }
+   m_route_table->users++;
+}
+
+void
+NetworkModelEMeshHopByHop::releaseRouteTable()
+{
+   ScopedLock sl(s_route_tables_lock);
+
+   if (--m_route_table->users == 0)
+   {
+      delete m_route_table;
+      s_route_tables[m_net_type] = NULL;
+   }
+   m_route_table = NULL;
+}
+
+NetworkModelEMeshHopByHop*
+NetworkModelEMeshHopByHop::getRouterModel(core_id_t router, PacketType pkt_type)
+{
+   // Other cores' networks do not exist yet when we are constructed, look up each router's model on its first packet.
+   // Racing threads find the same model, so the store needs no lock.
+   NetworkModelEMeshHopByHop *model = __atomic_load_n(&m_route_table->models[router], __ATOMIC_ACQUIRE);
+   if (!model)
+   {
+      model = dynamic_cast<NetworkModelEMeshHopByHop*>(
+         Sim()->getCoreManager()->getCoreFromID(router)->getNetwork()->getNetworkModelFromPacketType(pkt_type));
+      LOG_ASSERT_ERROR(model != NULL, "Router %d is not an emesh_hop_by_hop node", router);
+      __atomic_store_n(&m_route_table->models[router], model, __ATOMIC_RELEASE);
+   }
+   return model;
+}
+
 void
 NetworkModelEMeshHopByHop::routePacket(const NetPacket &pkt, std::vector<Hop> &nextHops)
+{
+   core_id_t requester;
+   UInt32 pkt_length;
+   routeFirstHop(pkt, nextHops, requester, pkt_length);
+
+   // Take unicasts the rest of the way here, rather than have Network::netSend
+   // call routePacket on every router along the way
+   for (std::vector<Hop>::iterator it = nextHops.begin(); it != nextHops.end(); ++it)
+   {
+      if (it->final_dest != NetPacket::BROADCAST && it->next_dest != it->final_dest)
+         followRoute(*it, pkt.type, pkt_length, requester);
+   }
+}
+
+void
+NetworkModelEMeshHopByHop::followRoute(Hop &hop, PacketType pkt_type, UInt32 pkt_length, core_id_t requester)
+{
+   // Our own hop is already in hop.time. Each router's queues are protected by its own lock, which is taken
+   // one router at a time and never while holding ours. As with hop-by-hop forwarding, only the first hop
+   // adds to the packet's queue_delay.
+   SubsecondTime time = hop.time;
+   core_id_t num_cores = m_route_table->num_cores;
+   core_id_t router = hop.next_dest;
+   for (SInt32 num_hops = 1; router != hop.final_dest; num_hops++)
+   {
+      LOG_ASSERT_ERROR(num_hops <= m_mesh_width + m_mesh_height + 1,
+         "Route from %d to %d does not converge", m_core_id, hop.final_dest);
+
+      OutputDirection direction = (OutputDirection)m_route_table->direction[router * num_cores + hop.final_dest];
+      if (direction < NUM_OUTPUT_DIRECTIONS)
+      {
+         NetworkModelEMeshHopByHop *model = getRouterModel(router, pkt_type);
+         ScopedLock sl(model->m_lock);
+         time += model->computeLatency(direction, time, pkt_length, requester, NULL);
+      }
+      router = m_route_table->next[router * num_cores + hop.final_dest];
+   }
+
+   hop.next_dest = hop.final_dest;
+   hop.time = time;
+}
+
+void
+NetworkModelEMeshHopByHop::routeFirstHop(const NetPacket &pkt, std::vector<Hop> &nextHops, core_id_t &requester, UInt32 &pkt_length)
 {
    ScopedLock sl(m_lock);
 
-   core_id_t requester = INVALID_CORE_ID;
+   requester = INVALID_CORE_ID;
 
    if (pkt.type == SHARED_MEM_1)
       requester = getNetwork()->getCore()->getMemoryManager()->getShmemRequester(pkt.data);
@@ -138,7 +254,7 @@ NetworkModelEMeshHopByHop::routePacket(const NetPacket &pkt, std::vector<Hop> &n
    LOG_ASSERT_ERROR((requester >= 0) && (requester < (core_id_t) Config::getSingleton()->getTotalCores()),
          "requester(%i)", requester);
 
-   UInt32 pkt_length = getNetwork()->getModeledLength(pkt);
+   pkt_length = getNetwork()->getModeledLength(pkt);
 
    LOG_PRINT("pkt length(%u)", pkt_length);
 
@@ -388,6 +504,12 @@ NetworkModelEMeshHopByHop::computeProcessingTime(UInt32 pkt_length)
 
 SInt32
 NetworkModelEMeshHopByHop::getNextDest(SInt32 final_dest, OutputDirection& direction)
+{
+   return getNextDest(m_core_id, final_dest, direction);
+}
+
+SInt32
+NetworkModelEMeshHopByHop::getNextDest(SInt32 from, SInt32 final_dest, OutputDirection& direction)
 {
    // Do dimension-order routing
    // Curently, do store-and-forward routing
@@ -399,22 +521,22 @@ NetworkModelEMeshHopByHop::getNextDest(SInt32 final_dest, OutputDirection& direc
       direction = DESTINATION;
       return final_dest;
    }
-   else if (m_core_id / m_concentration == final_dest / m_concentration)
+   else if (from / m_concentration == final_dest / m_concentration)
    {
       // Destination is self, a peer on our concentrated node
       direction = DESTINATION;
       return final_dest;
    }
-   else if (m_fake_node)
+   else if (from % m_concentration != 0 || from >= m_concentration * m_mesh_width * m_mesh_height)
    {
       // We are a concentrated node but not the master: first send to master
       direction = PEER;
-      return m_core_id - m_core_id % m_concentration;
+      return from - from % m_concentration;
    }
 
    SInt32 sx, sy, dx, dy;
 
-   computePosition(m_core_id, sx, sy);
+   computePosition(from, sx, sy);
    computePosition(final_dest, dx, dy);
 
    if ((sx > dx) ^ (m_wrap_around && abs(sx - dx) > (m_mesh_width+1) / 2))
@@ -441,7 +563,7 @@ NetworkModelEMeshHopByHop::getNextDest(SInt32 final_dest, OutputDirection& direc
    {
       // A send to itself
       direction = SELF;
-      return m_core_id;
+      return from;
    }
 }
 
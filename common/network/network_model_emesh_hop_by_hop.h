@@ -26,6 +26,19 @@ class NetworkModelEMeshHopByHop : public NetworkModel
       } OutputDirection;
 
    private:
+      // Dimension-order next hops from every node towards every destination, shared by all nodes of a static network.
+      // From node n, a packet for destination d goes to next[n * num_cores + d] through output direction[n * num_cores + d].
+      struct RouteTable
+      {
+         core_id_t num_cores;
+         std::vector<core_id_t> next;
+         std::vector<UInt8> direction;
+         std::vector<NetworkModelEMeshHopByHop*> models; // Each router's network model, resolved on first use
+         UInt32 users;
+      };
+      static RouteTable *s_route_tables[NUM_STATIC_NETWORKS];
+      static Lock s_route_tables_lock;
+
       // Fields
       SInt32 m_mesh_width;
       SInt32 m_mesh_height;
@@ -36,6 +49,9 @@ class NetworkModelEMeshHopByHop : public NetworkModel
 
       bool m_enabled;
 
+      EStaticNetwork m_net_type;
+      RouteTable *m_route_table;
+
       // Lock
       Lock m_lock;
 
@@ -56,6 +72,13 @@ class NetworkModelEMeshHopByHop : public NetworkModel
       SubsecondTime computeLatency(OutputDirection direction, SubsecondTime pkt_time, UInt32 pkt_length, core_id_t requester, subsecond_time_t *queue_delay_stats);
       SubsecondTime computeProcessingTime(UInt32 pkt_length);
       core_id_t getNextDest(core_id_t final_dest, OutputDirection& direction);
+      core_id_t getNextDest(core_id_t from, core_id_t final_dest, OutputDirection& direction);
+
+      void acquireRouteTable();
+      void releaseRouteTable();
+      NetworkModelEMeshHopByHop* getRouterModel(core_id_t router, PacketType pkt_type);
+      void routeFirstHop(const NetPacket &pkt, std::vector<Hop> &nextHops, core_id_t &requester, UInt32 &pkt_length);
+      void followRoute(Hop &hop, PacketType pkt_type, UInt32 pkt_length, core_id_t requester);
 
       // Injection & Ejection Port Queue Models
       SubsecondTime computeInjectionPortQueueDelay(core_id_t pkt_receiver, SubsecondTime pkt_time, UInt32 pkt_length);
@@ -98,6 +98,18 @@ ContentionModel::hasFreeSlot(SubsecondTime t_start, UInt64 tag)
    return false;
 }
 
+SubsecondTime
+ContentionModel::getFreeSlotTime()
+{
+   SubsecondTime t_free = SubsecondTime::MaxTime();
+   for (UInt32 i = 0; i < m_num_outstanding; ++i)
+   {
+      if (m_time[i].first < t_free)
+         t_free = m_time[i].first;
+   }
+   return t_free;
+}
+
 bool
 ContentionModel::hasTag(UInt64 tag)
 {
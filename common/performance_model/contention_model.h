@@ -35,6 +35,7 @@ class ContentionModel {
       UInt32 getNumUsed(SubsecondTime t_start);
       SubsecondTime getTagCompletionTime(UInt64 tag);
       bool hasFreeSlot(SubsecondTime t_start, UInt64 tag = -1);
+      SubsecondTime getFreeSlotTime(); // Earliest time at which hasFreeSlot() succeeds, if no further requests are made
       bool hasFreeSlot(uint64_t t_start, UInt64 tag = -1);
       bool hasTag(UInt64 tag);
 };
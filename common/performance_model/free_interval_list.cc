@@ -0,0 +1,123 @@
+#include "free_interval_list.h"
+
+#include <algorithm>
+
+static bool startsAfter(SubsecondTime time, const FreeIntervalList::Interval &interval)
+{
+   return time < interval.first;
+}
+
+static bool endsBefore(const FreeIntervalList::Interval &interval, SubsecondTime time)
+{
+   return interval.second < time;
+}
+
+FreeIntervalList::FreeIntervalList(UInt32 max_size, SubsecondTime min_processing_time, SubsecondTime end_time)
+   : m_max_size(max_size)
+   , m_min_processing_time(min_processing_time)
+   , m_intervals(2 * (max_size + 2))
+   , m_first(0)
+   , m_last(0)
+   , m_num_inverted(0)
+{
+   m_intervals[m_last++] = Interval(SubsecondTime::Zero(), end_time);
+}
+
+SubsecondTime
+FreeIntervalList::allocate(SubsecondTime pkt_time, SubsecondTime processing_time)
+{
+   UInt32 index = find(pkt_time, processing_time);
+   if (index == m_last)
+      return SubsecondTime::MaxTime();
+
+   Interval interval = m_intervals[index];
+   Interval pieces[2];
+   UInt32 num_pieces = 0;
+   SubsecondTime queue_delay;
+
+   if ((pkt_time >= interval.first) && ((pkt_time + processing_time) <= interval.second))
+   {
+      // The request fits, keep what is left on either side of it
+      queue_delay = SubsecondTime::Zero();
+      if ((pkt_time - interval.first) >= m_min_processing_time)
+         pieces[num_pieces++] = Interval(interval.first, pkt_time);
+      if ((interval.second - (pkt_time + processing_time)) >= m_min_processing_time)
+         pieces[num_pieces++] = Interval(pkt_time + processing_time, interval.second);
+   }
+   else
+   {
+      // The interval starts after the request, which waits for it even if it does not fit (see QueueModelHistoryList)
+      queue_delay = interval.first - pkt_time;
+      if ((interval.second - (interval.first + processing_time)) >= m_min_processing_time)
+         pieces[num_pieces++] = Interval(interval.first + processing_time, interval.second);
+   }
+
+   replace(index, pieces, num_pieces);
+
+   if (size() > m_max_size)
+      popFront();
+
+   return queue_delay;
+}
+
+UInt32
+FreeIntervalList::find(SubsecondTime pkt_time, SubsecondTime processing_time) const
+{
+   SubsecondTime pkt_end = pkt_time + processing_time;
+
+   if (m_num_inverted)
+   {
+      for (UInt32 index = m_first; index < m_last; index++)
+      {
+         const Interval &interval = m_intervals[index];
+         if (((pkt_time >= interval.first) && (pkt_end <= interval.second)) || (pkt_time < interval.first))
+            return index;
+      }
+      return m_last;
+   }
+
+   // All intervals before the first one that starts after pkt_time start no later than pkt_time,
+   // so the first of those that ends at or after pkt_end holds the request. If there is none,
+   // the request goes to the interval starting after it.
+   const Interval *begin = &m_intervals[0] + m_first;
+   const Interval *later = std::upper_bound(begin, &m_intervals[0] + m_last, pkt_time, startsAfter);
+   const Interval *fits = std::lower_bound(begin, later, pkt_end, endsBefore);
+   return fits - &m_intervals[0];
+}
+
+void
+FreeIntervalList::replace(UInt32 index, const Interval *pieces, UInt32 num_pieces)
+{
+   m_num_inverted -= isInverted(m_intervals[index]);
+   for (UInt32 i = 0; i < num_pieces; i++)
+      m_num_inverted += isInverted(pieces[i]);
+
+   if (num_pieces == 0)
+   {
+      std::copy(m_intervals.begin() + index + 1, m_intervals.begin() + m_last, m_intervals.begin() + index);
+      --m_last;
+   }
+   else if (num_pieces == 2)
+   {
+      if (m_last == m_intervals.size())
+      {
+         // Compact, dropped intervals have freed up space at the start
+         std::copy(m_intervals.begin() + m_first, m_intervals.begin() + m_last, m_intervals.begin());
+         index -= m_first;
+         m_last -= m_first;
+         m_first = 0;
+      }
+      std::copy_backward(m_intervals.begin() + index + 1, m_intervals.begin() + m_last, m_intervals.begin() + m_last + 1);
+      ++m_last;
+   }
+
+   for (UInt32 i = 0; i < num_pieces; i++)
+      m_intervals[index + i] = pieces[i];
+}
+
+void
+FreeIntervalList::popFront()
+{
+   m_num_inverted -= isInverted(m_intervals[m_first]);
+   ++m_first;
+}
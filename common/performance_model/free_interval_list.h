@@ -0,0 +1,49 @@
+#ifndef __FREE_INTERVAL_LIST_H__
+#define __FREE_INTERVAL_LIST_H__
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+
+#include <vector>
+
+// Free intervals of a queue in time order, the interval store of QueueModelHistoryList.
+//
+// The intervals live in one contiguous buffer. Dropping the oldest interval advances m_first,
+// the buffer is only compacted when an insertion runs into its end.
+// Intervals normally are disjoint, so both their starts and their ends are sorted and the interval a request
+// goes to is found by binary search. Requests that do not fit the interval they go to can leave behind an
+// interval that ends before it starts, which breaks that order: while one of those is stored, lookups scan
+// the intervals in order instead, so results are always those of a linear walk.
+
+class FreeIntervalList
+{
+public:
+   typedef std::pair<SubsecondTime,SubsecondTime> Interval;
+
+   FreeIntervalList(UInt32 max_size, SubsecondTime min_processing_time, SubsecondTime end_time);
+
+   UInt32 size() const { return m_last - m_first; }
+   const Interval& front() const { return m_intervals[m_first]; }
+   const Interval& back() const { return m_intervals[m_last - 1]; }
+
+   // Take processing_time out of the first interval that either holds the whole request or starts after pkt_time,
+   // and drop the oldest interval if the list grew beyond its maximum size.
+   // Returns the queue delay, or SubsecondTime::MaxTime() if there is no such interval.
+   SubsecondTime allocate(SubsecondTime pkt_time, SubsecondTime processing_time);
+
+private:
+   const UInt32 m_max_size;
+   const SubsecondTime m_min_processing_time;
+
+   std::vector<Interval> m_intervals;
+   UInt32 m_first;
+   UInt32 m_last;
+   UInt32 m_num_inverted; // Number of stored intervals that end before they start
+
+   UInt32 find(SubsecondTime pkt_time, SubsecondTime processing_time) const;
+   void replace(UInt32 index, const Interval *pieces, UInt32 num_pieces);
+   void popFront();
+   static bool isInverted(const Interval &interval) { return interval.second < interval.first; }
+};
+
+#endif /* __FREE_INTERVAL_LIST_H__ */
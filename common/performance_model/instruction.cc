@@ -6,25 +6,52 @@
 #include "branch_predictor.h"
 #include "config.hpp"
 
+#include <decoder.h>
+
 // Instruction
 
 Instruction::StaticInstructionCosts Instruction::m_instruction_costs;
 
 Instruction::Instruction(InstructionType type, OperandList &operands)
    : m_type(type)
+   , m_decoded_inst(NULL)
+   , m_decoded_disas(NULL)
    , m_uops(NULL)
    , m_addr(0)
-   , m_operands(operands)
 {
+   // Take over the operands instead of copying them: callers build the list only to construct the Instruction
+   m_operands.swap(operands);
 }
 
 Instruction::Instruction(InstructionType type)
    : m_type(type)
+   , m_decoded_inst(NULL)
+   , m_decoded_disas(NULL)
    , m_uops(NULL)
    , m_addr(0)
 {
 }
 
+const String& Instruction::getDisassembly(void) const
+{
+   if (m_decoded_inst == NULL)
+      return m_disas;
+
+   // Instructions can be shared between threads: the first string to be published wins, others are dropped
+   String *disas = __atomic_load_n(&m_decoded_disas, __ATOMIC_ACQUIRE);
+   if (disas == NULL)
+   {
+      char disassembly[64];
+      m_decoded_inst->disassembly_to_str(disassembly, sizeof(disassembly));
+      String *formatted = new String(disassembly);
+      if (__atomic_compare_exchange_n(&m_decoded_disas, &disas, formatted, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+         disas = formatted;
+      else
+         delete formatted;
+   }
+   return *disas;
+}
+
 InstructionType Instruction::getType() const
 {
     return m_type;
@@ -9,6 +9,7 @@
 
 class Core;
 class MicroOp;
+namespace dl { class DecodedInst; }
 
 enum InstructionType
 {
@@ -45,7 +46,7 @@ public:
 
    Instruction(InstructionType type);
 
-   virtual ~Instruction() { };
+   virtual ~Instruction() { delete m_decoded_disas; };
    virtual SubsecondTime getCost(Core *core) const;
 
    InstructionType getType() const;
@@ -69,7 +70,9 @@ public:
    bool isAtomic() const { return m_atomic; }
 
    void setDisassembly(String str) { m_disas = str; }
-   const String& getDisassembly(void) const { return m_disas; }
+   // Format the disassembly from the decoded instruction only when it is first asked for (by a tracer)
+   void setDecodedInstruction(const dl::DecodedInst *decoded_inst) { m_decoded_inst = decoded_inst; }
+   const String& getDisassembly(void) const;
 
    void setMicroOps(const std::vector<const MicroOp *> *uops)
    { m_uops = uops; }
@@ -83,6 +86,8 @@ private:
 
    InstructionType m_type;
    String m_disas;
+   const dl::DecodedInst *m_decoded_inst;
+   mutable String *m_decoded_disas; // Formatted from m_decoded_inst on first use, published atomically
 
    const std::vector<const MicroOp *> *m_uops;
 
@@ -41,6 +41,9 @@ RobTimer::RobTimer(
       , rob(window_size + 255)
       , m_num_in_rob(0)
       , m_rs_entries_used(0)
+      , m_not_issued(window_size)
+      , m_not_issued_stores(window_size)
+      , m_ready(window_size)
       , m_rob_contention(
          Sim()->getCfg()->getBoolArray("perf_model/core/rob_timer/issue_contention", core->getId())
          ? core_model->createRobContentionModel(core)
@@ -239,6 +242,27 @@ RobTimer::RobEntry* RobTimer::RobEntry::getDependant(size_t idx) const
    }
 }
 
+RobTimer::SequenceSet::SequenceSet(uint64_t size)
+{
+   uint64_t capacity = 64;
+   while (capacity < size)
+      capacity <<= 1;
+   bits.resize(capacity / 64, 0);
+   mask = capacity - 1;
+}
+
+uint64_t RobTimer::SequenceSet::findNext(uint64_t from, uint64_t end) const
+{
+   while (from < end)
+   {
+      uint64_t word = bits[(from & mask) >> 6] >> (from & 63);
+      if (word)
+         return std::min(from + __builtin_ctzll(word), end);
+      from += 64 - (from & 63);
+   }
+   return end;
+}
+
 RobTimer::RobEntry *RobTimer::findEntryBySequenceNumber(UInt64 sequenceNumber)
 {
    // Assumption: MicroOps in the ROB are numbered sequentially, none of them are removed halfway
@@ -439,6 +463,7 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
 {
    SubsecondTime next_event = SubsecondTime::MaxTime();
    SubsecondTime *cpiFrontEnd = NULL;
+   bool rs_full = false;
 
    if (frontend_stalled_until <= now)
    {
@@ -488,6 +513,7 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
          if (m_rs_entries_used == rsEntries)
          {
             cpiFrontEnd = &m_cpiRSFull;
+            rs_full = true;
             break;
          }
 
@@ -503,6 +529,12 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
          entry->ready = std::max(entry->ready, (now + 1ul).getElapsedTime());
          next_event = std::min(next_event, entry->ready);
 
+         m_not_issued.set(uop.getSequenceNumber());
+         if (uop.getMicroOp()->isStore())
+            m_not_issued_stores.set(uop.getSequenceNumber());
+         if (entry->ready != SubsecondTime::MaxTime())
+            wakeUp(entry);
+
          #ifdef DEBUG_PERCYCLE
             std::cout<<"DISPATCH "<<entry->uop->getMicroOp()->toShortString()<<std::endl;
          #endif
@@ -558,12 +590,20 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
    }
 
 
-   if (m_num_in_rob == windowSize)
-      return next_event; // front-end is effectively stalled so wait for another event
+   if (m_num_in_rob == windowSize || rs_full)
+      return next_event; // front-end is effectively stalled until something commits or issues, so wait for another event
    else
       return std::min(frontend_stalled_until, next_event);
 }
 
+void RobTimer::wakeUp(RobEntry *entry)
+{
+   if (entry->ready <= now)
+      m_ready.set(entry->uop->getSequenceNumber());
+   else
+      m_ready_times.push(Event(entry->ready, entry->uop->getSequenceNumber()));
+}
+
 void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
 {
    RobEntry *entry = &rob[idx];
@@ -630,6 +670,12 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
    entry->done = cycle_done;
    next_event = std::min(next_event, entry->done);
 
+   m_not_issued.clear(uop.getSequenceNumber());
+   m_not_issued_stores.clear(uop.getSequenceNumber());
+   m_ready.clear(uop.getSequenceNumber());
+   m_done_times.push(Event(entry->done, uop.getSequenceNumber()));
+   const uint64_t end = rob.front().uop->getSequenceNumber() + m_num_in_rob;
+
    --m_rs_entries_used;
 
    #ifdef DEBUG_PERCYCLE
@@ -648,8 +694,13 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
       // If all dependencies are resolved, mark the uop ready
       if (depEntry->uop->getDependenciesLength() == 0)
       {
+         bool waiting = depEntry->ready == SubsecondTime::MaxTime();
          depEntry->ready = depEntry->readyMax;
          //std::cout<<"    ready @ "<<depEntry->ready<<std::endl;
+
+         // Dependants that were not dispatched yet are scheduled when they are
+         if (waiting && depEntry->uop->getSequenceNumber() < end)
+            wakeUp(depEntry);
       }
 
       // For stores, check if their address has been produced
@@ -703,27 +754,53 @@ SubsecondTime RobTimer::doIssue()
    if (m_rob_contention)
       m_rob_contention->initCycle(now);
 
-   for(uint64_t i = 0; i < m_num_in_rob; ++i)
+   while (!m_ready_times.empty() && m_ready_times.top().first <= now)
    {
+      m_ready.set(m_ready_times.top().second);
+      m_ready_times.pop();
+   }
+
+   // Visit the micro-ops in the same order as a walk over the whole window would, skipping the ones that
+   // would not do anything: those that are done, and (out-of-order) those that are not ready yet.
+   // Micro-ops that become ready while issuing are younger than the one that woke them, and are still visited.
+   const SequenceSet &candidates = inorder ? m_not_issued : m_ready;
+   const uint64_t first = m_num_in_rob ? rob.front().uop->getSequenceNumber() : 0;
+   const uint64_t end = first + m_num_in_rob;
+   uint64_t next_store = first;
+
+   for(uint64_t seq = candidates.findNext(first, end); seq < end; seq = candidates.findNext(seq + 1, end))
+   {
+      uint64_t i = seq - first;
       RobEntry *entry = &rob.at(i);
       DynamicMicroOp *uop = entry->uop;
 
-
-      if (entry->done != SubsecondTime::MaxTime())
+      // The walk would have cleared head_of_queue at any older micro-op it could not issue,
+      // and set have_unresolved_store at any older store that is waiting for its address
+      head_of_queue = m_not_issued.findNext(first, seq) == seq;
+      if (m_no_address_disambiguation && uop->getMicroOp()->isLoad())
       {
-         next_event = std::min(next_event, entry->done);
-         continue;                     // already done
+         while (!have_unresolved_store && (next_store = m_not_issued_stores.findNext(next_store, seq)) < seq)
+         {
+            if (rob.at(next_store - first).addressReady > now)
+               have_unresolved_store = true;
+            else
+               ++next_store;
+         }
       }
 
-      next_event = std::min(next_event, entry->ready);
-
 
       // See if we can issue this instruction
 
       bool canIssue = false;
+      // If not, when the reason it is blocked goes away. MaxTime if an older micro-op has to issue first,
+      // which will have its own event.
+      SubsecondTime retry = SubsecondTime::MaxTime();
 
       if (entry->ready > now)
+      {
          canIssue = false;          // blocked by dependency
+         retry = entry->ready;
+      }
 
       else if ((no_more_load && uop->getMicroOp()->isLoad()) || (no_more_store && uop->getMicroOp()->isStore()))
          canIssue = false;          // blocked by mfence
@@ -733,7 +810,11 @@ SubsecondTime RobTimer::doIssue()
          if (head_of_queue && last_store_done <= now)
             canIssue = true;
          else
+         {
+            if (head_of_queue)
+               next_event = std::min(next_event, last_store_done);
             break;
+         }
       }
 
       else if (uop->getMicroOp()->isMemBarrier())
@@ -741,22 +822,39 @@ SubsecondTime RobTimer::doIssue()
          if (head_of_queue && last_store_done <= now)
             canIssue = true;
          else
+         {
             // Don't issue any memory operations following a memory barrier
             no_more_load = no_more_store = true;
             // FIXME: L/SFENCE
+            if (head_of_queue)
+               retry = last_store_done;
+         }
       }
 
       else if (!m_rob_contention && num_issued == dispatchWidth)
+      {
          canIssue = false;          // no issue contention: issue width == dispatch width
+         retry = now;
+      }
 
       else if (uop->getMicroOp()->isLoad() && !load_queue.hasFreeSlot(now))
+      {
          canIssue = false;          // load queue full
+         retry = load_queue.getFreeSlotTime();
+      }
 
       else if (uop->getMicroOp()->isLoad() && m_no_address_disambiguation && have_unresolved_store)
+      {
          canIssue = false;          // preceding store with unknown address
+         retry = rob.at(next_store - first).addressReady;
+      }
 
       else if (uop->getMicroOp()->isStore() && (!head_of_queue || !store_queue.hasFreeSlot(now)))
+      {
          canIssue = false;          // store queue full
+         if (head_of_queue)
+            retry = store_queue.getFreeSlotTime();
+      }
 
       else
          canIssue = true;           // issue!
@@ -764,7 +862,10 @@ SubsecondTime RobTimer::doIssue()
 
       // canIssue already marks issue ports as in use, so do this one last
       if (canIssue && m_rob_contention && ! m_rob_contention->tryIssue(*uop))
+      {
          canIssue = false;          // blocked by structural hazard
+         retry = now;
+      }
 
 
       if (canIssue)
@@ -802,10 +903,7 @@ SubsecondTime RobTimer::doIssue()
       }
       else
       {
-         head_of_queue = false;     // Subsequent instructions are not at the head of the ROB
-
-         if (uop->getMicroOp()->isStore() && entry->addressReady > now)
-            have_unresolved_store = true;
+         next_event = std::min(next_event, retry);
 
          if (inorder)
             // In-order: only issue from head of the ROB
@@ -825,6 +923,19 @@ SubsecondTime RobTimer::doIssue()
       }
    }
 
+   // Issuing frees reservation station entries and may end a front-end stall: dispatch could continue next cycle
+   if (num_issued > 0)
+      next_event = std::min(next_event, now.getElapsedTime());
+
+   // Micro-ops that become ready later, and those that complete later (which changes the CPI component
+   // and the outstanding loads being accounted for)
+   if (!m_ready_times.empty())
+      next_event = std::min(next_event, m_ready_times.top().first);
+   while (!m_done_times.empty() && (rob.size() == 0 || m_done_times.top().second < rob.front().uop->getSequenceNumber()))
+      m_done_times.pop();
+   if (!m_done_times.empty())
+      next_event = std::min(next_event, m_done_times.top().first);
+
    return next_event;
 }
 
@@ -10,6 +10,7 @@
 #include "stats.h"
 
 #include <deque>
+#include <queue>
 
 class RobTimer
 {
@@ -45,6 +46,25 @@ private:
          SubsecondTime done;
    };
 
+   // Set of in-flight micro-ops, indexed by sequence number modulo a power of two that is at least the window size
+   class SequenceSet
+   {
+      private:
+         std::vector<uint64_t> bits;
+         uint64_t mask;
+
+      public:
+         SequenceSet(uint64_t size);
+
+         void set(uint64_t sequenceNumber) { bits[(sequenceNumber & mask) >> 6] |= 1ull << (sequenceNumber & 63); }
+         void clear(uint64_t sequenceNumber) { bits[(sequenceNumber & mask) >> 6] &= ~(1ull << (sequenceNumber & 63)); }
+         // Oldest sequence number in [from, end) that is in the set, or end if there is none
+         uint64_t findNext(uint64_t from, uint64_t end) const;
+   };
+
+   typedef std::pair<SubsecondTime, uint64_t> Event; // time, sequence number
+   typedef std::priority_queue<Event, std::vector<Event>, std::greater<Event> > EventQueue;
+
    const uint64_t dispatchWidth;
    const uint64_t commitWidth;
    const uint64_t windowSize;
@@ -60,6 +80,14 @@ private:
    Rob rob;
    uint64_t m_num_in_rob;
    uint64_t m_rs_entries_used;
+
+   // Issue scheduling: rather than walking the whole window every cycle, doIssue only visits
+   // dispatched micro-ops that have not issued yet and, when issuing out-of-order, only those that are ready
+   SequenceSet m_not_issued;
+   SequenceSet m_not_issued_stores;
+   SequenceSet m_ready;
+   EventQueue m_ready_times;  //< Dispatched micro-ops that become ready after now
+   EventQueue m_done_times;   //< Issued micro-ops that have not yet been committed
    RobContention *m_rob_contention;
 
    ComponentTime now;
@@ -146,6 +174,7 @@ private:
    SubsecondTime doCommit(uint64_t& instructionsExecuted);
 
    void issueInstruction(uint64_t idx, SubsecondTime &next_event);
+   void wakeUp(RobEntry *entry);
 
 public:
 
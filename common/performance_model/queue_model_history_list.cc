@@ -7,8 +7,13 @@
 #include "stats.h"
 #include "config.hpp"
 
+#include <cstring>
+
+const char QueueModelHistoryList::RECORD_MAGIC[8] = { 'S', 'N', 'I', 'P', 'Q', 'M', 'H', 'L' };
+
 QueueModelHistoryList::QueueModelHistoryList(String name, UInt32 id, SubsecondTime min_processing_time):
    m_min_processing_time(min_processing_time),
+   m_record_file(NULL),
    m_utilized_time(SubsecondTime::Zero()),
    m_total_queue_delay(SubsecondTime::Zero()),
    m_total_requests(0),
@@ -27,10 +32,12 @@ QueueModelHistoryList::QueueModelHistoryList(String name, UInt32 id, SubsecondTi
    // Assumptions
    // 1) Simulation Time will not exceed 2^63.
    UInt32 max_list_size = 0;
+   bool record = false;
    try
    {
       m_analytical_model_enabled = Sim()->getCfg()->getBool("queue_model/history_list/analytical_model_enabled");
       max_list_size = Sim()->getCfg()->getInt("queue_model/history_list/max_list_size");
+      record = Sim()->getCfg()->getBool("queue_model/history_list/record");
    }
    catch(...)
    {
@@ -39,7 +46,21 @@ QueueModelHistoryList::QueueModelHistoryList(String name, UInt32 id, SubsecondTi
    m_max_free_interval_list_size = max_list_size;
    m_average_delay = MovingAverage<SubsecondTime>::createAvgType(MovingAverage<SubsecondTime>::ARITHMETIC_MEAN, max_list_size);
    SubsecondTime max_simulation_time = SubsecondTime::FS() << 63;
-   m_free_interval_list.push_back(std::pair<const SubsecondTime,SubsecondTime>(SubsecondTime::Zero(), max_simulation_time));
+   m_free_interval_list = new FreeIntervalList(max_list_size, m_min_processing_time, max_simulation_time);
+
+   if (record)
+   {
+      String filename = Sim()->getConfig()->formatOutputFileName(String("queue-") + name + "-" + itostr(id) + ".trace");
+      m_record_file = fopen(filename.c_str(), "wb");
+      LOG_ASSERT_ERROR(m_record_file, "Cannot open %s", filename.c_str());
+
+      record_header_t header;
+      memcpy(header.magic, RECORD_MAGIC, sizeof(header.magic));
+      header.min_processing_time = m_min_processing_time.getFS();
+      header.max_list_size = max_list_size;
+      header.analytical_model_enabled = m_analytical_model_enabled;
+      fwrite(&header, sizeof(header), 1, m_record_file);
+   }
 
    registerStatsMetric(name, id, "num-requests", &m_total_requests);
    registerStatsMetric(name, id, "num-requests-analytical", &m_total_requests_using_analytical_model);
@@ -49,21 +70,30 @@ QueueModelHistoryList::QueueModelHistoryList(String name, UInt32 id, SubsecondTi
 
 QueueModelHistoryList::~QueueModelHistoryList()
 {
+   if (m_record_file)
+      fclose(m_record_file);
+   delete m_free_interval_list;
    delete m_average_delay;
 }
 
 SubsecondTime
 QueueModelHistoryList::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester)
 {
-   LOG_ASSERT_ERROR(m_free_interval_list.size() >= 1,
+   LOG_ASSERT_ERROR(m_free_interval_list->size() >= 1,
          "Free Interval list size < 1");
 
+   if (m_record_file)
+   {
+      UInt64 request[2] = { pkt_time.getFS(), processing_time.getFS() };
+      fwrite(request, sizeof(request), 1, m_record_file);
+   }
+
    SubsecondTime queue_delay;
 
    // Check if it is an old packet
    // If yes, use analytical model
    // If not, use the history list based queue model
-   std::pair<SubsecondTime,SubsecondTime> oldest_interval = m_free_interval_list.front();
+   const FreeIntervalList::Interval& oldest_interval = m_free_interval_list->front();
    if (m_analytical_model_enabled && ((pkt_time + processing_time) <= oldest_interval.first))
    {
       // Increment the number of requests that use the analytical model
@@ -88,7 +118,7 @@ QueueModelHistoryList::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime p
 float
 QueueModelHistoryList::getQueueUtilization()
 {
-   std::pair<SubsecondTime,SubsecondTime> newest_interval = m_free_interval_list.back();
+   const FreeIntervalList::Interval& newest_interval = m_free_interval_list->back();
    SubsecondTime total_time = newest_interval.first;
 
    if (total_time == SubsecondTime::Zero())
@@ -140,57 +170,21 @@ QueueModelHistoryList::computeUsingAnalyticalModel(SubsecondTime pkt_time, Subse
 SubsecondTime
 QueueModelHistoryList::computeUsingHistoryList(SubsecondTime pkt_time, SubsecondTime processing_time)
 {
-   LOG_ASSERT_ERROR(m_free_interval_list.size() <= m_max_free_interval_list_size,
-         "Free Interval list size(%u) > %u", m_free_interval_list.size(), m_max_free_interval_list_size);
-   SubsecondTime queue_delay = SubsecondTime::MaxTime();
-
-   FreeIntervalList::iterator curr_it;
-   for (curr_it = m_free_interval_list.begin(); curr_it != m_free_interval_list.end(); curr_it ++)
-   {
-      std::pair<SubsecondTime,SubsecondTime> interval = (*curr_it);
-
-      if ((pkt_time >= interval.first) && ((pkt_time + processing_time) <= interval.second))
-      {
-         queue_delay = SubsecondTime::Zero();
-         // Adjust the data structure accordingly
-         curr_it = m_free_interval_list.erase(curr_it);
-         if ((pkt_time - interval.first) >= m_min_processing_time)
-         {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first, pkt_time));
-         }
-         if ((interval.second - (pkt_time + processing_time)) >= m_min_processing_time)
-         {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(pkt_time + processing_time, interval.second));
-         }
-         break;
-      }
-      // WH: The request comes before this free part, but doesn't fit. It doesn't make sense to me to
-      //     demand a fit and move this request down even further. In reality, this request would have most
-      //     likely executed at interval.first, while later request would/could be delayed. But it's too late
-      //     for that now.
-      //     (If we assume all wait times are additive then the average works out by shifting it down,
-      //      but since this is an interactive simulation all delays propagate through the system
-      //      so this won't be accurate.)
-      else if ((pkt_time < interval.first) /*&& ((interval.first + processing_time) <= interval.second)*/)
-      {
-         queue_delay = interval.first - pkt_time;
-         // Adjust the data structure accordingly
-         curr_it = m_free_interval_list.erase(curr_it);
-         if ((interval.second - (interval.first + processing_time)) >= m_min_processing_time)
-         {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first + processing_time, interval.second));
-         }
-         break;
-      }
-   }
+   LOG_ASSERT_ERROR(m_free_interval_list->size() <= m_max_free_interval_list_size,
+         "Free Interval list size(%u) > %u", m_free_interval_list->size(), m_max_free_interval_list_size);
+
+   // Goes to the first free interval that either holds the whole request, or starts after it.
+   // WH: The request comes before this free part, but doesn't fit. It doesn't make sense to me to
+   //     demand a fit and move this request down even further. In reality, this request would have most
+   //     likely executed at interval.first, while later request would/could be delayed. But it's too late
+   //     for that now.
+   //     (If we assume all wait times are additive then the average works out by shifting it down,
+   //      but since this is an interactive simulation all delays propagate through the system
+   //      so this won't be accurate.)
+   SubsecondTime queue_delay = m_free_interval_list->allocate(pkt_time, processing_time);
 
    LOG_ASSERT_ERROR(queue_delay != SubsecondTime::MaxTime(), "queue delay(%s), free interval not found", itostr(queue_delay).c_str());
 
-   if (m_free_interval_list.size() > m_max_free_interval_list_size)
-   {
-      m_free_interval_list.erase(m_free_interval_list.begin());
-   }
-
    LOG_PRINT("HistoryList: pkt_time(%s), processing_time(%s), queue_delay(%s)", itostr(pkt_time).c_str(), itostr(processing_time).c_str(), itostr(queue_delay).c_str());
 
    return queue_delay;
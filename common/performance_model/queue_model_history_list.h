@@ -1,16 +1,25 @@
 #ifndef __QUEUE_MODEL_HISTORY_LIST_H__
 #define __QUEUE_MODEL_HISTORY_LIST_H__
 
-#include <list>
-
 #include "queue_model.h"
 #include "fixed_types.h"
 #include "moving_average.h"
+#include "free_interval_list.h"
+
+#include <cstdio>
 
 class QueueModelHistoryList : public QueueModel
 {
 public:
-   typedef std::list<std::pair<SubsecondTime,SubsecondTime> > FreeIntervalList;
+   // Requests are recorded as this header followed by (pkt_time, processing_time) pairs in fs,
+   // for replay by test/queue-model-history-list
+   typedef struct {
+      char magic[8];
+      UInt64 min_processing_time; // fs
+      UInt32 max_list_size;
+      UInt32 analytical_model_enabled;
+   } record_header_t;
+   static const char RECORD_MAGIC[8];
 
    QueueModelHistoryList(String name, UInt32 id, SubsecondTime min_processing_time);
    ~QueueModelHistoryList();
@@ -24,7 +33,8 @@ private:
    SubsecondTime m_min_processing_time;
    UInt32 m_max_free_interval_list_size;
 
-   FreeIntervalList m_free_interval_list;
+   FreeIntervalList* m_free_interval_list;
+   FILE* m_record_file;
 
    // Tracks queue utilization
    SubsecondTime m_utilized_time;
@@ -0,0 +1,131 @@
+#include "hotspot_engine.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// By explicit path, a plain "util.h" would pick up cheetah/util.h from the common/ include directories
+extern "C" {
+#include "hotspot/flp.h"
+#include "hotspot/package.h"
+#include "hotspot/temperature.h"
+#include "hotspot/temperature_block.h"
+#include "hotspot/temperature_grid.h"
+#include "hotspot/util.h"
+}
+
+/** HotSpotEngine
+ * Build the RC model once, the same way the hotspot binary does on every invocation:
+ * read the configuration, (optionally) run the package model, read the floorplan and populate R and C.
+ */
+HotSpotEngine::HotSpotEngine(const std::string &floorplanFilename, const std::string &hotspotConfigFilename)
+    : model(NULL), flp(NULL), temp(NULL), power(NULL), table(NULL), tableSize(0), naturalConvection(false), firstCall(true), epochs(0) {
+
+    std::vector<char> configFile(hotspotConfigFilename.begin(), hotspotConfigFilename.end());
+    configFile.push_back('\0');
+    std::vector<char> floorplanFile(floorplanFilename.begin(), floorplanFilename.end());
+    floorplanFile.push_back('\0');
+
+    table = new str_pair[MAX_ENTRIES];
+    tableSize = read_str_pairs(table, MAX_ENTRIES, configFile.data());
+    tableSize = str_pairs_remove_duplicates(table, tableSize);
+
+    thermal_config_t thermalConfig = default_thermal_config();
+    thermal_config_add_from_strs(&thermalConfig, table, tableSize);
+
+    char packageModelUsed[] = "package_model_used";
+    if ((get_str_index(table, tableSize, packageModelUsed) >= 0) && thermalConfig.package_model_used) {
+        double avgSinkTemp = thermalConfig.ambient + SMALL_FOR_CONVEC;
+        naturalConvection = package_model(&thermalConfig, table, tableSize, avgSinkTemp);
+    }
+
+    flp = read_flp(floorplanFile.data(), FALSE);
+    model = alloc_RC_model(&thermalConfig, flp, FALSE);
+    populate_R_model(model, flp);
+    populate_C_model(model, flp);
+
+    temp = hotspot_vector(model);
+    power = hotspot_vector(model);
+    set_temp(model, temp, model->config->init_temp);
+
+    // Map the power-dissipating units to their position in HotSpot's vectors
+    if (model->type == BLOCK_MODEL) {
+        for (int i = 0; i < model->block->flp->n_units; i++) {
+            unitNames.push_back(model->block->flp->units[i].name);
+            modelIndex.push_back(i);
+        }
+    } else {
+        int base = 0;
+        for (int l = 0; l < model->grid->n_layers; l++) {
+            flp_t *layerFlp = model->grid->layers[l].flp;
+            if (model->grid->layers[l].has_power) {
+                for (int i = 0; i < layerFlp->n_units; i++) {
+                    unitNames.push_back(layerFlp->units[i].name);
+                    modelIndex.push_back(base + i);
+                }
+            }
+            base += layerFlp->n_units;
+        }
+    }
+    temperatures.resize(unitNames.size());
+    updateTemperatures();
+
+    std::cout << "[HotSpotEngine] Built " << (model->type == BLOCK_MODEL ? "block" : "grid") << " model with " << unitNames.size() << " units from " << floorplanFilename << std::endl;
+}
+
+HotSpotEngine::~HotSpotEngine() {
+    free_dvector(temp);
+    free_dvector(power);
+    delete_RC_model(model);
+    free_flp(flp, FALSE);
+    delete [] table;
+}
+
+/** getUnitIndex
+ * Return the index of the given unit or -1 if it is not part of the floorplan.
+ */
+int HotSpotEngine::getUnitIndex(const std::string &unitName) const {
+    for (unsigned int i = 0; i < unitNames.size(); i++) {
+        if (unitNames[i] == unitName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/** computeTemperatures
+ * Equivalent of one hotspot invocation with '-init_file' set to the previous result.
+ */
+void HotSpotEngine::computeTemperatures(const std::vector<double> &powers, double seconds) {
+    if (powers.size() != unitNames.size()) {
+        std::cout << "[HotSpotEngine] [Error]: no. of units in floorplan (" << unitNames.size() << ") and power values (" << powers.size() << ") differ" << std::endl;
+        exit(1);
+    }
+
+    for (unsigned int i = 0; i < powers.size(); i++) {
+        power[modelIndex[i]] = powers[i];
+    }
+
+    if (naturalConvection) {
+        double avgSinkTemp = calc_sink_temp(model, temp);
+        naturalConvection = package_model(model->config, table, tableSize, avgSinkTemp);
+        populate_R_model(model, flp);
+    }
+
+    // the grid model remembers its internal grid temperatures from the first non-null call
+    if (model->type == BLOCK_MODEL || firstCall) {
+        compute_temp(model, power, temp, seconds);
+    } else {
+        compute_temp(model, power, NULL, seconds);
+    }
+    firstCall = false;
+    epochs++;
+
+    updateTemperatures();
+}
+
+void HotSpotEngine::updateTemperatures() {
+    for (unsigned int i = 0; i < unitNames.size(); i++) {
+        temperatures[i] = temp[modelIndex[i]] - 273.15;
+    }
+}
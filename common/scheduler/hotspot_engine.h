@@ -0,0 +1,55 @@
+/**
+ * hotspot_engine
+ * This header implements an in-process HotSpot thermal model. The RC model is built once from
+ * the floorplan and the HotSpot configuration, and its temperature state is kept in memory across epochs.
+ */
+
+#ifndef __HOTSPOT_ENGINE_H
+#define __HOTSPOT_ENGINE_H
+
+#include <string>
+#include <vector>
+
+// HotSpot types are only used by hotspot_engine.cc (its headers define MIN/MAX/TRUE/FALSE)
+struct RC_model_t_st;
+struct flp_t_st;
+struct str_pair_st;
+
+class HotSpotEngine {
+public:
+    HotSpotEngine(const std::string &floorplanFilename, const std::string &hotspotConfigFilename);
+    ~HotSpotEngine();
+
+    // Advance the transient model by 'seconds' with the given power (in W, indexed like getUnitNames())
+    void computeTemperatures(const std::vector<double> &powers, double seconds);
+
+    // Names of the power-dissipating units, in floorplan order (this is also the order of the power log columns)
+    const std::vector<std::string>& getUnitNames() const { return unitNames; }
+    int getUnitIndex(const std::string &unitName) const;
+
+    // Latest temperatures (in degree C), indexed like getUnitNames()
+    const std::vector<double>& getTemperatures() const { return temperatures; }
+    double getTemperatureOfUnit(int unitIndex) const { return temperatures.at(unitIndex); }
+
+    unsigned long getNumberOfEpochs() const { return epochs; }
+
+private:
+    struct RC_model_t_st *model;
+    struct flp_t_st *flp;
+    double *temp;
+    double *power;
+    struct str_pair_st *table;
+    int tableSize;
+    bool naturalConvection;
+    bool firstCall;
+    unsigned long epochs;
+
+    // for every unit (in unitNames order), the index into HotSpot's temp/power vectors
+    std::vector<int> modelIndex;
+    std::vector<std::string> unitNames;
+    std::vector<double> temperatures;
+
+    void updateTemperatures();
+};
+
+#endif
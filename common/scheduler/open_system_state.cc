@@ -0,0 +1,192 @@
+/**
+ * open_system_state
+ * This class implements the task and core bookkeeping of the open scheduler.
+ */
+
+#include "open_system_state.h"
+
+OpenSystemState::OpenSystemState(int numberOfCores)
+    : activeCoreRequirement(0),
+      queuedByPriority(QueueOrder{&tasks}),
+      activeByPriority(ActiveOrder{&tasks}),
+      freeCoreMask((numberOfCores + 63) / 64, 0),
+      freeCores(numberOfCores) {
+    for (int state = 0; state < NUM_TASK_STATES; state++) {
+        tasksInState[state] = 0;
+        head[state] = -1;
+        tail[state] = -1;
+    }
+    for (int coreId = 0; coreId < numberOfCores; coreId++) {
+        cores.push_back(SystemCore(coreId));
+        freeCoreMask[coreId / 64] |= 1ULL << (coreId % 64);
+    }
+}
+
+int OpenSystemState::addTask(String taskName, int taskCoreRequirement) {
+    int taskID = tasks.size();
+    tasks.push_back(OpenTask(taskID, taskName, taskCoreRequirement));
+    link(taskID);
+    return taskID;
+}
+
+/** QueueOrder
+ * Highest priority first, then earliest arrival.
+ */
+bool OpenSystemState::QueueOrder::operator()(int t1, int t2) const {
+    const OpenTask &p1 = (*tasks)[t1];
+    const OpenTask &p2 = (*tasks)[t2];
+    if (p1.priority != p2.priority) {
+        return p1.priority > p2.priority;
+    } else if (p1.taskArrivalTime != p2.taskArrivalTime) {
+        return p1.taskArrivalTime < p2.taskArrivalTime;
+    } else {
+        return t1 < t2;
+    }
+}
+
+/** ActiveOrder
+ * Lowest priority first, then the latest task, which is the first to be preempted.
+ */
+bool OpenSystemState::ActiveOrder::operator()(int t1, int t2) const {
+    const OpenTask &p1 = (*tasks)[t1];
+    const OpenTask &p2 = (*tasks)[t2];
+    if (p1.priority != p2.priority) {
+        return p1.priority < p2.priority;
+    } else {
+        return t1 > t2;
+    }
+}
+
+/** setTaskState
+ * Move a task to another state and update the counters of both states.
+ */
+void OpenSystemState::setTaskState(int taskID, TaskState state) {
+    OpenTask &task = tasks.at(taskID);
+    if (task.state == state) {
+        return;
+    }
+
+    unlink(taskID);
+    if (task.state == TASK_IN_QUEUE) {
+        queuedByPriority.erase(taskID);
+    } else if (task.state == TASK_ACTIVE) {
+        activeByPriority.erase(taskID);
+        activeCoreRequirement -= task.taskCoreRequirement;
+    }
+
+    task.state = state;
+    link(taskID);
+    if (state == TASK_IN_QUEUE) {
+        queuedByPriority.insert(taskID);
+    } else if (state == TASK_ACTIVE) {
+        activeByPriority.insert(taskID);
+        activeCoreRequirement += task.taskCoreRequirement;
+    }
+}
+
+int OpenSystemState::getHighestPriorityQueuedTask() const {
+    return queuedByPriority.empty() ? -1 : *queuedByPriority.begin();
+}
+
+int OpenSystemState::getLowestPriorityActiveTask() const {
+    return activeByPriority.empty() ? -1 : *activeByPriority.begin();
+}
+
+/** link
+ * Insert a task into the list of its state. Tasks mostly change state in order of task ID, so the position
+ * is searched from the tail and is found immediately in the common case.
+ */
+void OpenSystemState::link(int taskID) {
+    OpenTask &task = tasks[taskID];
+    int prev = tail[task.state];
+    while (prev != -1 && prev > taskID) {
+        prev = tasks[prev].prev;
+    }
+    int next = (prev == -1) ? head[task.state] : tasks[prev].next;
+
+    task.prev = prev;
+    task.next = next;
+    if (prev == -1) {
+        head[task.state] = taskID;
+    } else {
+        tasks[prev].next = taskID;
+    }
+    if (next == -1) {
+        tail[task.state] = taskID;
+    } else {
+        tasks[next].prev = taskID;
+    }
+    tasksInState[task.state]++;
+}
+
+void OpenSystemState::unlink(int taskID) {
+    OpenTask &task = tasks[taskID];
+    if (task.prev == -1) {
+        head[task.state] = task.next;
+    } else {
+        tasks[task.prev].next = task.next;
+    }
+    if (task.next == -1) {
+        tail[task.state] = task.prev;
+    } else {
+        tasks[task.next].prev = task.prev;
+    }
+    task.prev = -1;
+    task.next = -1;
+    tasksInState[task.state]--;
+}
+
+void OpenSystemState::assignTask(int coreId, int taskID) {
+    SystemCore &core = cores.at(coreId);
+    bool wasFree = core.assignedTaskID == -1;
+    bool isFree = taskID == -1;
+    core.assignedTaskID = taskID;
+
+    if (wasFree && !isFree) {
+        freeCoreMask[coreId / 64] &= ~(1ULL << (coreId % 64));
+        freeCores--;
+    } else if (!wasFree && isFree) {
+        freeCoreMask[coreId / 64] |= 1ULL << (coreId % 64);
+        freeCores++;
+    }
+}
+
+void OpenSystemState::assignThread(int coreId, int threadID) {
+    cores.at(coreId).assignedThreadID = threadID;
+}
+
+void OpenSystemState::assignCore(int coreId, const SystemCore &assignment) {
+    // Copy first, the assignment may refer to a core that is changed below
+    int taskID = assignment.assignedTaskID;
+    int threadID = assignment.assignedThreadID;
+    assignTask(coreId, taskID);
+    assignThread(coreId, threadID);
+}
+
+bool OpenSystemState::verify() const {
+    int counted[NUM_TASK_STATES] = { 0 };
+    int coreRequirement = 0;
+    for (const OpenTask &task : tasks) {
+        counted[task.state]++;
+        if (task.state == TASK_ACTIVE) {
+            coreRequirement += task.taskCoreRequirement;
+        }
+    }
+    for (int state = 0; state < NUM_TASK_STATES; state++) {
+        if (counted[state] != tasksInState[state]) {
+            return false;
+        }
+    }
+
+    int free = 0;
+    for (const SystemCore &core : cores) {
+        if ((core.assignedTaskID == -1) != isCoreFree(core.coreID)) {
+            return false;
+        }
+        free += (core.assignedTaskID == -1);
+    }
+
+    return coreRequirement == activeCoreRequirement && free == freeCores
+        && queuedByPriority.size() == (size_t)tasksInState[TASK_IN_QUEUE]
+        && activeByPriority.size() == (size_t)tasksInState[TASK_ACTIVE];
+}
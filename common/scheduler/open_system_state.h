@@ -0,0 +1,113 @@
+/**
+ * open_system_state
+ * This header implements the task and core bookkeeping of the open scheduler.
+ * Every task is in exactly one state. The tasks of a state are linked in an intrusive list ordered by task ID,
+ * and the counters the scheduler checks every period are maintained on each transition instead of recounted.
+ */
+
+#ifndef __OPEN_SYSTEM_STATE_H
+#define __OPEN_SYSTEM_STATE_H
+
+#include "fixed_types.h"
+
+#include <set>
+#include <vector>
+
+enum TaskState {
+    TASK_WAITING_TO_SCHEDULE, // not yet arrived, or arrived but not yet fetched into the queue
+    TASK_IN_QUEUE,
+    TASK_ACTIVE,
+    TASK_COMPLETED,
+    NUM_TASK_STATES
+};
+
+struct OpenTask {
+    OpenTask(int taskID, String taskName, int taskCoreRequirement)
+        : taskID(taskID), taskName(taskName), taskCoreRequirement(taskCoreRequirement) {}
+
+    int taskID;
+    String taskName;
+    int taskCoreRequirement;
+    UInt64 taskArrivalTime = 0; // may only change while the task is waiting to schedule
+    UInt64 taskStartTime = 0;
+    UInt64 taskDepartureTime = 0;
+    int priority = 0; // may only change while the task is waiting to schedule
+
+    TaskState state = TASK_WAITING_TO_SCHEDULE;
+    int prev = -1; // neighbours in the list of tasks with the same state
+    int next = -1;
+};
+
+struct SystemCore {
+    SystemCore(int coreID) : coreID(coreID) {}
+
+    int coreID;
+    int assignedTaskID = -1; // -1 means core assigned to no task
+    int assignedThreadID = -1; // -1 means core assigned to no thread
+};
+
+class OpenSystemState {
+public:
+    OpenSystemState(int numberOfCores);
+
+    // Tasks
+    int addTask(String taskName, int taskCoreRequirement);
+    int getNumberOfTasks() const { return tasks.size(); }
+    OpenTask& getTask(int taskID) { return tasks.at(taskID); }
+    const OpenTask& getTask(int taskID) const { return tasks.at(taskID); }
+
+    void setTaskState(int taskID, TaskState state);
+    int getNumberOfTasks(TaskState state) const { return tasksInState[state]; }
+    int getTotalCoreRequirementsOfActiveTasks() const { return activeCoreRequirement; }
+
+    // Walk the tasks in a state in order of task ID: for (int t = firstTask(s); t != -1; t = nextTask(t))
+    int firstTask(TaskState state) const { return head[state]; }
+    int nextTask(int taskID) const { return tasks[taskID].next; }
+
+    // Queued task with the highest priority (earliest arrival on ties), -1 if the queue is empty
+    int getHighestPriorityQueuedTask() const;
+    // Active task with the lowest priority, -1 if no task is active
+    int getLowestPriorityActiveTask() const;
+
+    // Cores
+    int getNumberOfCores() const { return cores.size(); }
+    const SystemCore& getCore(int coreId) const { return cores.at(coreId); }
+    int getNumberOfFreeCores() const { return freeCores; }
+    bool isCoreFree(int coreId) const { return (freeCoreMask[coreId / 64] >> (coreId % 64)) & 1; }
+
+    void assignTask(int coreId, int taskID); // -1 releases the core
+    void assignThread(int coreId, int threadID); // -1 releases the thread
+    void assignCore(int coreId, const SystemCore &assignment); // copy the task and thread of another core
+
+    // Cross-check the incremental counters against a full recount, return false on a mismatch
+    bool verify() const;
+
+private:
+    struct QueueOrder {
+        const std::vector<OpenTask> *tasks;
+        bool operator()(int t1, int t2) const;
+    };
+    struct ActiveOrder {
+        const std::vector<OpenTask> *tasks;
+        bool operator()(int t1, int t2) const;
+    };
+
+    std::vector<OpenTask> tasks;
+    int tasksInState[NUM_TASK_STATES];
+    int head[NUM_TASK_STATES];
+    int tail[NUM_TASK_STATES];
+    int activeCoreRequirement;
+
+    // Only kept in order of priority, FIFO queuing uses the task lists
+    std::set<int, QueueOrder> queuedByPriority;
+    std::set<int, ActiveOrder> activeByPriority;
+
+    std::vector<SystemCore> cores;
+    std::vector<UInt64> freeCoreMask;
+    int freeCores;
+
+    void link(int taskID);
+    void unlink(int taskID);
+};
+
+#endif
@@ -1,10 +1,6 @@
 #include "performance_counters.h"
 
-#include <fstream>
-#include <sstream>
 #include <algorithm>
-#include <numeric>
-#include <iostream>
 
 using namespace std;
 
@@ -12,80 +8,35 @@ PerformanceCounters::PerformanceCounters(const char* output_dir,
         std::string instPowerFileNameParam,
         std::string instTemperatureFileNameParam,
         std::string instCPIStackFileNameParam,
-        std::string instRvalueFileNameParam) :
-            instPowerFileName(instPowerFileNameParam),
-            instTemperatureFileName(instTemperatureFileNameParam),
-            instCPIStackFileName(instCPIStackFileNameParam) {
-
-    //gkothar1: fix log file path names
-    std::string temp = instPowerFileName;
-    instPowerFileName = std::string(output_dir);
-    instPowerFileName.append("/");
-    instPowerFileName.append(temp);
-
-    temp = instTemperatureFileName;
-    instTemperatureFileName = std::string(output_dir);
-    instTemperatureFileName.append("/");
-    instTemperatureFileName.append(temp);
-
-    temp = instCPIStackFileName;
-    instCPIStackFileName = std::string(output_dir);
-    instCPIStackFileName.append("/");
-    instCPIStackFileName.append(temp);
-
-    instRvalueFileName = std::string(output_dir) + "/" +
-        instRvalueFileNameParam;
+        std::string instRvalueFileNameParam,
+        unsigned int heartbeatWindow) :
+            power(std::string(output_dir) + "/" + instPowerFileNameParam),
+            temperature(std::string(output_dir) + "/" + instTemperatureFileNameParam),
+            rvalue(std::string(output_dir) + "/" + instRvalueFileNameParam),
+            cpiStack(std::string(output_dir) + "/" + instCPIStackFileNameParam),
+            heartbeats(heartbeatWindow) {
 }
 
-/** Return a vector of all the values that match the prefix pattern. */
-vector<double> getValues(string filename, string prefix) {
-    ifstream LogFile(filename);
-    string header;
-    string footer;
-    vector<double> v;
-
-    if (LogFile.good()) {
-        getline(LogFile, header);
-        getline(LogFile, footer);
-    }
-
-    std::istringstream issHeader(header);
-    std::istringstream issFooter(footer);
-    std::string token;
-
-    while(getline(issHeader, token, '\t')) {
-        std::string value;
-        getline(issFooter, value, '\t');
-        if (token.find(prefix) == 0) {
-            v.push_back(stod(value));
-        }
-    }
-
-    return v;
+/** publishPower
+ * Publish the power of the native power model, which replaces the power log.
+ */
+void PerformanceCounters::publishPower(const vector<string> &components, const vector<double> &powers) {
+    power.publish(components, powers);
 }
 
-/** Return the value of a component in the instantanious `logfile`.
- * Return -1 if the component is not found and throw an exception if
- * the component is found multiple times.
+/** publishTemperatures
+ * Publish the temperatures of the internal thermal engine, which replace the temperature log.
  */
-double getValue(string logfile, string component) {
-    vector<double> values = getValues(logfile, component);
-
-    if (values.size() < 1) {
-        return -1;
-    } else if (values.size() > 1) {
-        throw std::runtime_error{"ERROR: Duplicate components found in " + \
-            logfile};
-    }
-
-    return values[0];
+void PerformanceCounters::publishTemperatures(const vector<string> &components, const vector<double> &temperatures) {
+    temperature.publish(components, temperatures);
 }
 
 /** getPowerOfComponent
     Returns the latest power consumption of a component being tracked using base.cfg. Return -1 if power value not found.
 */
 double PerformanceCounters::getPowerOfComponent (string component) const {
-    return getValue(instPowerFileName, component);
+    int index = power.getIndex(component);
+    return (index == -1) ? -1 : power.getValue(index);
 }
 
 /** getPowerOfCore
@@ -95,14 +46,32 @@ double PerformanceCounters::getPowerOfComponent (string component) const {
  * usage of all the subcomponents of the core.
  */
 double PerformanceCounters::getPowerOfCore(int coreId) const {
-    string prefix = "C_" + std::to_string(coreId) + "_";
-    vector<double> power_values = getValues(instPowerFileName, prefix);
+    const vector<int> &components = power.getIndicesOfCore(coreId);
 
-    if (power_values.size() == 0) {
+    if (components.size() == 0) {
         return -1;
     }
 
-    return std::accumulate(power_values.begin(), power_values.end(), 0.0);
+    double sum = 0;
+    for (int index : components) {
+        sum += power.getValue(index);
+    }
+    return sum;
+}
+
+/** getPowerOfComponents
+ * Return the latest power consumption of each of the given components
+ * (0 if a component is not tracked).
+ */
+vector<double> PerformanceCounters::getPowerOfComponents(const vector<string> &components) const {
+    vector<double> v(components.size(), 0);
+    for (unsigned int i = 0; i < components.size(); i++) {
+        int index = power.getIndex(components[i]);
+        if (index != -1) {
+            v[i] = power.getValue(index);
+        }
+    }
+    return v;
 }
 
 /** getPeakTemperature
@@ -110,14 +79,11 @@ double PerformanceCounters::getPowerOfCore(int coreId) const {
  * temperature value is found.
 */
 double PerformanceCounters::getPeakTemperature () const {
-    // The pattern 'C_' will match all components in the logfile.
-    vector<double> temperatures = getValues(instTemperatureFileName, "C_");
-
-    if (temperatures.size() == 0) {
-        return -1;
+    double peak = -1;
+    for (int coreId = 0; coreId < temperature.getNumberOfCores(); coreId++) {
+        peak = std::max(peak, getTemperatureOfCore(coreId));
     }
-
-    return *std::max_element(temperatures.begin(), temperatures.end());
+    return peak;
 }
 
 
@@ -125,7 +91,8 @@ double PerformanceCounters::getPeakTemperature () const {
     Returns the latest temperature of a component being tracked using base.cfg. Return -1 if power value not found.
 */
 double PerformanceCounters::getTemperatureOfComponent (string component) const {
-    return getValue(instTemperatureFileName, component);
+    int index = temperature.getIndex(component);
+    return (index == -1) ? -1 : temperature.getValue(index);
 }
 
 /** getTemperatureOfCore
@@ -135,14 +102,17 @@ double PerformanceCounters::getTemperatureOfComponent (string component) const {
  * taking the maximum of all the subcomponents of the core.
  */
 double PerformanceCounters::getTemperatureOfCore(int coreId) const {
-    string prefix = "C_" + std::to_string(coreId) + "_";
-    vector<double> temperatures = getValues(instTemperatureFileName, prefix);
+    const vector<int> &components = temperature.getIndicesOfCore(coreId);
 
-    if (temperatures.size() == 0) {
+    if (components.size() == 0) {
         return -1;
     }
 
-    return *std::max_element(temperatures.begin(), temperatures.end());
+    double max = temperature.getValue(components.front());
+    for (int index : components) {
+        max = std::max(max, temperature.getValue(index));
+    }
+    return max;
 }
 
 /**
@@ -150,35 +120,7 @@ double PerformanceCounters::getTemperatureOfCore(int coreId) const {
  * Available performance metrics can be checked in InstantaneousPerformanceCounters.log
  */
 double PerformanceCounters::getCPIStackPartOfCore(int coreId, std::string metric) const {
-    ifstream cpiStackLogFile(instCPIStackFileName);
-    string line;
-    std::istringstream issLine;
-
-    // first find the line in the logfile that contains the desired metric
-    bool metricFound = false;
-    while (!metricFound) {
-        if (cpiStackLogFile.good()) {
-            getline(cpiStackLogFile, line);
-            issLine.str(line);
-            issLine.clear();
-            std::string m;
-            getline(issLine, m, '\t');
-            metricFound = (m == metric);
-        } else {
-            return -1;
-        }
-    }
-    
-    // then split the coreId-th value from this line (first value is metric name, but already consumed above)
-    std::string value;
-    for (int i = 0; i < coreId + 1; i++) {
-        getline(issLine, value, '\t');
-        if ((i == 0) && (value == "-")) {
-            return 0;
-        }
-    }
-
-    return stod(value);
+    return cpiStack.getValue(metric, coreId);
 }
 
 /**
@@ -232,7 +174,8 @@ double PerformanceCounters::getIPSOfCore(int coreId) const {
     Return -1 if rvalue value not found.
 */
 double PerformanceCounters::getRvalueOfComponent (std::string component) const {
-    return getValue(instRvalueFileName, component);
+    int index = rvalue.getIndex(component);
+    return (index == -1) ? -1 : rvalue.getValue(index);
 }
 
 /** getRvalueOfCore
@@ -242,50 +185,43 @@ double PerformanceCounters::getRvalueOfComponent (std::string component) const {
  * values of its subcomponents.
  */
 double PerformanceCounters::getRvalueOfCore (int coreId) const {
-    string prefix = "C_" + std::to_string(coreId) + "_";
-    vector<double> r_values = getValues(instRvalueFileName, prefix);
+    const vector<int> &components = rvalue.getIndicesOfCore(coreId);
 
-    if (r_values.size() == 0) {
+    if (components.size() == 0) {
         return -1;
     }
 
-    return *std::min_element(r_values.begin(), r_values.end());
+    double min = rvalue.getValue(components.front());
+    for (int index : components) {
+        min = std::min(min, rvalue.getValue(index));
+    }
+    return min;
 }
 
-int PerformanceCounters::getLastBeat(int appId) const {
-	std::string target = std::to_string(appId) + ".hb.log";
-	std::ifstream appIdHbLogfile(target);
-	if (!appIdHbLogfile.is_open()) {
-		std::cerr << "[PerformanceCounters] Could not open hb logfile " << target << endl;
-		return -1;
-	}
-
-	std::string header;
-	std::getline(appIdHbLogfile, header);
-
-	std::string line;
-	std::string footer;
-	while (std::getline(appIdHbLogfile, line)) {
-		footer = line;
-	}
-
-	if (footer == "") {
-		return 0; // No heartbeat data logged yet.
-	}
-
-	std::istringstream issHeader(header);
-	std::istringstream issFooter(footer);
-	std::string token;
-	while (std::getline(issHeader, token, '\t')) {
-		std::string value;
-		std::getline(issFooter, value, '\t');
+/** notifyHeartbeat
+ * Record a heartbeat of the application (timestamp in ns), reported through the SIM_CMD_HEARTBEAT magic instruction.
+ */
+void PerformanceCounters::notifyHeartbeat(int appId, long timestamp, long tag) {
+    heartbeats.beat(appId, timestamp, tag);
+}
 
-		if (token == "Timestamp") {
-			return std::stoi(value);
-		}
-	}
+/** getLastBeat
+ * Return the timestamp (in ns) of the last heartbeat of the application, or 0 if it did not beat yet.
+ */
+long PerformanceCounters::getLastBeat(int appId) const {
+    return heartbeats.getLastBeat(appId);
+}
 
-	std::cerr << "[PerformanceCounters] Could not find timestamp column in hb file " << target << endl;
+/** getHeartRate
+ * Return the heart rate (in beats per second) of the application over the last scheduler/open/hb_window beats.
+ */
+double PerformanceCounters::getHeartRate(int appId) const {
+    return heartbeats.getWindowRate(appId);
+}
 
-  return -1;
+/** getGlobalHeartRate
+ * Return the heart rate (in beats per second) of the application since its first heartbeat.
+ */
+double PerformanceCounters::getGlobalHeartRate(int appId) const {
+    return heartbeats.getGlobalRate(appId);
 }
@@ -6,14 +6,17 @@
 #ifndef __PERFORMANCECOUNTERS_H
 #define __PERFORMANCECOUNTERS_H
 
+#include "telemetry.h"
+
 #include <string>
 #include <vector>
 
 class PerformanceCounters {
 public:
-    PerformanceCounters(const char* output_dir, std::string instPowerFileNameParam, std::string instTemperatureFileNameParam, std::string instCPIStackFileNameParam, std::string instRvalueFileNameParam);
+    PerformanceCounters(const char* output_dir, std::string instPowerFileNameParam, std::string instTemperatureFileNameParam, std::string instCPIStackFileNameParam, std::string instRvalueFileNameParam, unsigned int heartbeatWindow);
     double getPowerOfComponent (std::string component) const;
     double getPowerOfCore(int coreId) const;
+    std::vector<double> getPowerOfComponents(const std::vector<std::string> &components) const;
     double getPeakTemperature () const;
     double getTemperatureOfComponent (std::string component) const;
     double getTemperatureOfCore (int coreId) const;
@@ -27,17 +30,22 @@ public:
     double getRvalueOfCore (int coreId) const;
 
     void notifyFreqsOfCores(std::vector<int> frequencies);
+    void publishPower(const std::vector<std::string> &components, const std::vector<double> &powers);
+    void publishTemperatures(const std::vector<std::string> &components, const std::vector<double> &temperatures);
 
-    int getLastBeat(int appId) const;
+    void notifyHeartbeat(int appId, long timestamp, long tag);
+    long getLastBeat(int appId) const;
+    double getHeartRate(int appId) const;
+    double getGlobalHeartRate(int appId) const;
 
 private:
     std::vector<int> frequencies;
 
-    std::string outputDir;
-    std::string instPowerFileName;
-    std::string instTemperatureFileName;
-    std::string instCPIStackFileName;
-    std::string instRvalueFileName;
+    ComponentTelemetry power;
+    ComponentTelemetry temperature;
+    ComponentTelemetry rvalue;
+    CoreMetricTelemetry cpiStack;
+    HeartbeatTelemetry heartbeats;
 };
 
 #endif
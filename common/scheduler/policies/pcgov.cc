@@ -1,12 +1,14 @@
 #include "pcgov.h"
+#include <algorithm>
 #include <iomanip>
 #include <limits>
 #include <tuple>
 #include "powermodel.h"
 using namespace std;
-PCGov::PCGov(ThermalComponentModel *thermalModel, PerformanceCounters *performanceCounters, int coreRows, int coreColumns, int minFrequency, int maxFrequency, int frequencyStepSize, float delta)
+PCGov::PCGov(ThermalComponentModel *thermalModel, PerformanceCounters *performanceCounters, int coreRows, int coreColumns, int minFrequency, int maxFrequency, int frequencyStepSize, float delta, unsigned int mappingThreads, unsigned long searchNodes)
     : thermalModel(thermalModel), performanceCounters(performanceCounters), coreRows(coreRows), coreColumns(coreColumns),
-      minFrequency(minFrequency), maxFrequency(maxFrequency), frequencyStepSize(frequencyStepSize), delta(delta)
+      minFrequency(minFrequency), maxFrequency(maxFrequency), frequencyStepSize(frequencyStepSize), delta(delta),
+      mappingThreads(mappingThreads), searchNodes(searchNodes)
 {
     // get core AMD info
     for (int y = 0; y < coreColumns; y++)
@@ -20,6 +22,7 @@ PCGov::PCGov(ThermalComponentModel *thermalModel, PerformanceCounters *performan
             powerBudgets.push_back(thermalModel->getInactivePower());
         }
     }
+    amdThresholds.assign(uniqueAMDs.begin(), uniqueAMDs.end());
 }
 
 int PCGov::manhattanDistance(int y1, int x1, int y2, int x2)
@@ -51,53 +54,154 @@ float PCGov::getCoreAMD(int coreY, int coreX)
  */
 vector<tuple<float, float, vector<int>>> PCGov::getMappingCandidates(int taskCoreRequirement, const vector<bool> &availableCores, const vector<bool> &activeCores)
 {
-    // get the candidates
+    if (workerPool == NULL) {
+        workerPool = new WorkerPool(mappingThreads);
+        scratch.resize(workerPool->getNumberOfWorkers());
+        for (Scratch &s : scratch) {
+            s.headroom = thermalModel->createHeadroom();
+        }
+    }
+
+    // the candidates of the AMD thresholds are independent: evaluate them in parallel, then keep them in order of AMD
+    vector<tuple<float, float, vector<int>>> results(amdThresholds.size());
+    vector<char> found(amdThresholds.size(), false);
+    workerPool->run(amdThresholds.size(), [&](unsigned int worker, unsigned int threshold) {
+        found[threshold] = getMappingCandidate(scratch.at(worker), amdThresholds.at(threshold), taskCoreRequirement, availableCores, activeCores, results[threshold]);
+    });
+
     vector<tuple<float, float, vector<int>>> candidates;
-    for (const float &amdMax : uniqueAMDs)
-    {
-        // get the candidate for the given AMD_max
-        vector<int> availableCoresAMD;
-        for (unsigned int i = 0; i < coreRows * coreColumns; i++) {
-            if (availableCores.at(i) && (amds.at(i) <= amdMax))
+    for (unsigned int threshold = 0; threshold < amdThresholds.size(); threshold++) {
+        if (found[threshold]) {
+            candidates.push_back(results[threshold]);
+        }
+    }
+
+    return candidates;
+}
+
+/** getMappingCandidate
+
+ * Get the candidate for the given AMD_max, return false if there is none.
+
+ */
+bool PCGov::getMappingCandidate(Scratch &s, float amdMax, int taskCoreRequirement, const vector<bool> &availableCores, const vector<bool> &activeCores, tuple<float, float, vector<int>> &candidate)
+{
+    s.availableCores.clear();
+    for (unsigned int i = 0; i < coreRows * coreColumns; i++) {
+        if (availableCores.at(i) && (amds.at(i) <= amdMax))
+        {
+            s.availableCores.push_back(i);
+        }
+    }
+    if ((int)s.availableCores.size() < taskCoreRequirement) {
+        return false;
+    }
+
+    s.activeCores.assign(activeCores.begin(), activeCores.end());
+    int amtActiveCores = count(activeCores.begin(), activeCores.end(), true);
+    s.selectedCores.clear();
+    float mappingTSP = 0;
+    while ((int)s.selectedCores.size() < taskCoreRequirement) {
+        // greedily select one core, the lowest one on ties
+        thermalModel->tspForManyCandidates(s.activeCores, amtActiveCores, s.availableCores, *s.headroom, s.tsps);
+        float bestTSP = 0;
+        int bestIndex = -1;
+        for (unsigned int i = 0; i < s.tsps.size(); i++)
+        {
+            if ((s.tsps.at(i) > bestTSP) || (bestIndex != -1 && s.tsps.at(i) == bestTSP && s.availableCores.at(i) < s.availableCores.at(bestIndex)))
             {
-                availableCoresAMD.push_back(i);
+                bestTSP = s.tsps.at(i);
+                bestIndex = i;
             }
         }
-        
-        if ((int)availableCoresAMD.size() >= taskCoreRequirement) {
-            vector<int> selectedCores;
-            vector<bool> activeCoresCandidate = activeCores;
-            float mappingTSP = 0;
-            float maxUsedAMD = 0;
-            while ((int)selectedCores.size() < taskCoreRequirement) {
-                // greedily select one core
-                vector<double> tsps = thermalModel->tspForManyCandidates(activeCoresCandidate, availableCoresAMD);
-                float bestTSP = 0;
-                int bestIndex = 0;
-                for (unsigned int i = 0; i < tsps.size(); i++)
-                {
-                    if (tsps.at(i) > bestTSP)
-                    {
-                        bestTSP = tsps.at(i);
-                        bestIndex = i;
-                    }
-                }
-                activeCoresCandidate[availableCoresAMD.at(bestIndex)] = true;
-                selectedCores.push_back(availableCoresAMD.at(bestIndex));
-                mappingTSP = bestTSP;
-                maxUsedAMD = max(maxUsedAMD, amds.at(availableCoresAMD.at(bestIndex)));
-                availableCoresAMD.erase(availableCoresAMD.begin() + bestIndex);
-            }
-            
-            if (maxUsedAMD == amdMax) {
-                // add the mapping to the list of mappings
-                tuple<float, float, vector<int>> mapping(amdMax, mappingTSP, selectedCores);
-                candidates.push_back(mapping);
-            }
+        if (bestIndex == -1) {
+            bestIndex = min_element(s.availableCores.begin(), s.availableCores.end()) - s.availableCores.begin();
         }
+        int core = s.availableCores.at(bestIndex);
+        s.activeCores[core] = true;
+        amtActiveCores++;
+        s.selectedCores.push_back(core);
+        mappingTSP = bestTSP;
+        // the order of the remaining cores does not matter
+        s.availableCores[bestIndex] = s.availableCores.back();
+        s.availableCores.pop_back();
     }
 
-    return candidates;
+    if (searchNodes > 0) {
+        // improve on the greedy mapping with an exact search, within the node budget
+        s.bestCores = s.selectedCores;
+        for (int core : s.selectedCores) {
+            s.activeCores[core] = false;
+            s.availableCores.push_back(core);
+        }
+        sort(s.availableCores.begin(), s.availableCores.end());
+        s.selectedCores.clear();
+        unsigned long nodes = 0;
+        branchAndBound(s, 0, 0, amtActiveCores - taskCoreRequirement, taskCoreRequirement, mappingTSP, nodes);
+        s.selectedCores.swap(s.bestCores);
+    }
+
+    float maxUsedAMD = 0;
+    for (int core : s.selectedCores) {
+        maxUsedAMD = max(maxUsedAMD, amds.at(core));
+    }
+    if (maxUsedAMD != amdMax) {
+        return false;
+    }
+
+    // add the mapping to the list of mappings
+    candidate = tuple<float, float, vector<int>>(amdMax, mappingTSP, s.selectedCores);
+    return true;
+}
+
+/** branchAndBound
+
+ * Search the combinations of the remaining available cores (from index first on) for a mapping with a higher TSP than bestTSP.
+
+ * Activating a core never raises the TSP while it is above the inactive power, so the TSP of a partial mapping bounds all its completions.
+
+ */
+void PCGov::branchAndBound(Scratch &s, unsigned int depth, unsigned int first, int amtActiveCores, int taskCoreRequirement, float &bestTSP, unsigned long &nodes)
+{
+    if (depth == 0 && (int)s.levelCandidates.size() < taskCoreRequirement) {
+        // allocate all levels up front, the references below must stay valid during the recursion
+        s.levelCandidates.resize(taskCoreRequirement);
+        s.levelTSPs.resize(taskCoreRequirement);
+        s.levelOrder.resize(taskCoreRequirement);
+    }
+    vector<int> &candidates = s.levelCandidates[depth];
+    vector<double> &tsps = s.levelTSPs[depth];
+    vector<int> &order = s.levelOrder[depth];
+
+    // leave enough cores for the deeper levels
+    unsigned int end = s.availableCores.size() - (taskCoreRequirement - depth - 1);
+    candidates.assign(s.availableCores.begin() + first, s.availableCores.begin() + end);
+    thermalModel->tspForManyCandidates(s.activeCores, amtActiveCores, candidates, *s.headroom, tsps);
+
+    // most promising cores first, so the bound prunes early
+    order.resize(candidates.size());
+    for (unsigned int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [&](int a, int b) { return tsps[a] > tsps[b]; });
+
+    for (int i : order) {
+        if (tsps[i] <= bestTSP || nodes >= searchNodes) {
+            break;
+        }
+        nodes++;
+        int core = candidates[i];
+        s.selectedCores.push_back(core);
+        if ((int)depth + 1 == taskCoreRequirement) {
+            bestTSP = tsps[i];
+            s.bestCores = s.selectedCores;
+        } else {
+            s.activeCores[core] = true;
+            branchAndBound(s, depth + 1, first + i + 1, amtActiveCores + 1, taskCoreRequirement, bestTSP, nodes);
+            s.activeCores[core] = false;
+        }
+        s.selectedCores.pop_back();
+    }
 }
 
 /** map
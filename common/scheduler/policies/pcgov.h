@@ -38,6 +38,8 @@
 
 #include "thermalComponentModel.h"
 
+#include "worker_pool.h"
+
 #include "mappingpolicy.h"
 
 #include "dvfspolicy.h"
@@ -46,7 +48,9 @@ class PCGov : public MappingPolicy, public DVFSPolicy
 {
 
 public:
-    PCGov(ThermalComponentModel *thermalModel, PerformanceCounters *performanceCounters, int coreRows, int coreColumns, int minFrequency, int maxFrequency, int frequencyStepSize, float delta);
+    // mappingThreads: helper threads that evaluate the AMD thresholds in parallel (created on the first mapping)
+    // searchNodes: 0 for the greedy search of the paper, otherwise the node budget of a branch-and-bound search per threshold
+    PCGov(ThermalComponentModel *thermalModel, PerformanceCounters *performanceCounters, int coreRows, int coreColumns, int minFrequency, int maxFrequency, int frequencyStepSize, float delta, unsigned int mappingThreads = 0, unsigned long searchNodes = 0);
 
     virtual std::vector<int> map(String taskName, int taskCoreRequirement, const std::vector<bool> &availableCores, const std::vector<bool> &activeCores);
 
@@ -88,6 +92,29 @@ private:
 
     std::vector<std::tuple<float, float, std::vector<int>>> getMappingCandidates(int taskCoreRequirement, const std::vector<bool> &availableCores, const std::vector<bool> &activeCores);
 
+    // Buffers of one worker, reused across thresholds and mappings
+    struct Scratch
+    {
+        ThermalHeadroom *headroom;
+        std::vector<bool> activeCores;
+        std::vector<int> availableCores;
+        std::vector<int> selectedCores;
+        std::vector<double> tsps;
+        std::vector<int> bestCores;
+        std::vector<std::vector<int>> levelCandidates; // branch-and-bound, per depth
+        std::vector<std::vector<double>> levelTSPs;
+        std::vector<std::vector<int>> levelOrder;
+    };
+
+    unsigned int mappingThreads;
+    unsigned long searchNodes;
+    WorkerPool *workerPool = NULL;
+    std::vector<Scratch> scratch;
+    std::vector<float> amdThresholds; // uniqueAMDs in ascending order
+
+    bool getMappingCandidate(Scratch &s, float amdMax, int taskCoreRequirement, const std::vector<bool> &availableCores, const std::vector<bool> &activeCores, std::tuple<float, float, std::vector<int>> &candidate);
+    void branchAndBound(Scratch &s, unsigned int depth, unsigned int first, int amtActiveCores, int taskCoreRequirement, float &bestTSP, unsigned long &nodes);
+
     int manhattanDistance(int y1, int x1, int y2, int x2);
 
     float getCoreAMD(int coreY, int coreX);
@@ -0,0 +1,335 @@
+#include "power_estimator.h"
+#include "simulator.h"
+#include "magic_server.h"
+#include "stats.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+
+/** PowerEstimator
+ * Load the energy table and expand the per-core components into the power log columns (C_<core>_<component>).
+ */
+PowerEstimator::PowerEstimator(const string &energyTableFilename, int numberOfCores)
+    : numberOfCores(numberOfCores), referenceVdd(0), metricsResolved(false), lastTime(SubsecondTime::Zero()), epochs(0) {
+
+    readEnergyTable(energyTableFilename);
+
+    // shared components first and per-core components core by core, like tools/mcpat.py writes the power log.
+    // Extra components (e.g. DRAM) only contribute to the energy statistics and come last.
+    for (unsigned int c = 0; c < components.size(); c++) {
+        if (components[c].scope == SCOPE_SHARED) {
+            componentNames.push_back(components[c].name);
+            columnComponent.push_back(c);
+            columnCore.push_back(-1);
+        }
+    }
+    for (int core = 0; core < numberOfCores; core++) {
+        for (unsigned int c = 0; c < components.size(); c++) {
+            if (components[c].scope == SCOPE_CORE) {
+                componentNames.push_back("C_" + to_string(core) + "_" + components[c].name);
+                columnComponent.push_back(c);
+                columnCore.push_back(core);
+            }
+        }
+    }
+    numberOfLoggedComponents = componentNames.size();
+    for (unsigned int c = 0; c < components.size(); c++) {
+        if (components[c].scope == SCOPE_EXTRA) {
+            componentNames.push_back(components[c].name);
+            columnComponent.push_back(c);
+            columnCore.push_back(-1);
+        }
+    }
+    powers.resize(componentNames.size(), 0);
+
+    for (unsigned int i = 0; i < componentNames.size(); i++) {
+        const string &name = components[columnComponent[i]].name;
+        if (columnCore[i] == -1) {
+            columnEnergyClass.push_back(name == "DRAM" ? ENERGY_DRAM : ENERGY_PROCESSOR);
+        } else if (name == "IC") {
+            columnEnergyClass.push_back(ENERGY_L1I);
+        } else if (name == "DC") {
+            columnEnergyClass.push_back(ENERGY_L1D);
+        } else if (name == "L2") {
+            columnEnergyClass.push_back(ENERGY_L2);
+        } else {
+            columnEnergyClass.push_back(ENERGY_CORE);
+        }
+    }
+    registerEnergyStatistics();
+
+    cout << "[PowerEstimator] Loaded " << components.size() << " components, " << events.size() << " events and " << levels.size() << " DVFS levels from " << energyTableFilename << endl;
+}
+
+/** readEnergyTable
+ * Parse the table written by tools/mcpat_energy_table.py.
+ */
+void PowerEstimator::readEnergyTable(const string &energyTableFilename) {
+    ifstream tableFile(energyTableFilename);
+    if (!tableFile.good()) {
+        cout << "[PowerEstimator] [Error]: Cannot open energy table " << energyTableFilename << endl;
+        exit(1);
+    }
+
+    int tableCores = -1;
+    string line;
+    while (getline(tableFile, line)) {
+        istringstream iss(line);
+        string keyword;
+        if (!(iss >> keyword) || (keyword[0] == '#')) {
+            continue;
+        }
+
+        if (keyword == "cores") {
+            iss >> tableCores;
+        } else if (keyword == "reference_vdd") {
+            iss >> referenceVdd;
+        } else if (keyword == "component") {
+            string scope;
+            Component component;
+            iss >> scope >> component.name;
+            component.scope = (scope == "core") ? SCOPE_CORE : ((scope == "shared") ? SCOPE_SHARED : SCOPE_EXTRA);
+            components.push_back(component);
+        } else if (keyword == "event") {
+            string scope;
+            Event event;
+            iss >> scope >> event.objectName >> event.metricName >> event.subtractMetricName;
+            event.scope = (scope == "core") ? SCOPE_CORE : SCOPE_SHARED;
+            events.push_back(event);
+        } else if (keyword == "level") {
+            Level level;
+            iss >> level.frequency >> level.vdd;
+            level.staticPower.resize(components.size());
+            for (unsigned int c = 0; c < components.size(); c++) {
+                iss >> level.staticPower[c];
+            }
+            levels.push_back(level);
+        } else if (keyword == "energy") {
+            string name;
+            iss >> name;
+            if (energies.empty()) {
+                energies.resize(components.size(), vector<double>(events.size(), 0));
+            }
+            bool found = false;
+            for (unsigned int c = 0; c < components.size(); c++) {
+                if (components[c].name == name) {
+                    for (unsigned int e = 0; e < events.size(); e++) {
+                        iss >> energies[c][e];
+                    }
+                    found = true;
+                }
+            }
+            if (!found) {
+                cout << "[PowerEstimator] [Error]: Energy values for unknown component " << name << endl;
+                exit(1);
+            }
+        } else {
+            cout << "[PowerEstimator] [Error]: Unknown keyword '" << keyword << "' in energy table" << endl;
+            exit(1);
+        }
+
+        if (iss.fail() && !iss.eof()) {
+            cout << "[PowerEstimator] [Error]: Malformed line in energy table: " << line << endl;
+            exit(1);
+        }
+    }
+
+    if (tableCores != numberOfCores) {
+        cout << "[PowerEstimator] [Error]: Energy table was characterized for " << tableCores << " cores instead of " << numberOfCores << endl;
+        exit(1);
+    }
+    if (levels.empty() || (referenceVdd <= 0)) {
+        cout << "[PowerEstimator] [Error]: Energy table has no DVFS levels or reference vdd" << endl;
+        exit(1);
+    }
+    if (energies.empty()) {
+        energies.resize(components.size(), vector<double>(events.size(), 0));
+    }
+    for (unsigned int l = 1; l < levels.size(); l++) {
+        if (levels[l].frequency > levels[l - 1].frequency) {
+            cout << "[PowerEstimator] [Error]: DVFS levels in energy table are not sorted from high to low frequency" << endl;
+            exit(1);
+        }
+    }
+}
+
+/** resolveMetrics
+ * Look up the statistics once. This is done on the first update, when all components have registered their metrics.
+ */
+void PowerEstimator::resolveMetrics() {
+    for (Event &event : events) {
+        for (int index = 0; index < numberOfCores; index++) {
+            event.metrics.push_back(Sim()->getStatsManager()->getMetricObject(event.objectName.c_str(), index, event.metricName.c_str()));
+            event.subtractMetrics.push_back(event.subtractMetricName.empty() ? NULL :
+                Sim()->getStatsManager()->getMetricObject(event.objectName.c_str(), index, event.subtractMetricName.c_str()));
+        }
+        event.lastValues.resize(numberOfCores, 0);
+        for (int index = 0; index < numberOfCores; index++) {
+            event.lastValues[index] = readEvent(event, index);
+        }
+    }
+    metricsResolved = true;
+}
+
+/** registerEnergyStatistics
+ * Provide the energy-static and energy-dynamic statistics that scripts/energystats.py provides when McPAT is used.
+ */
+void PowerEstimator::registerEnergyStatistics() {
+    const char *objectNames[] = { "core", "L1-I", "L1-D", "L2", "processor", "dram" };
+    for (int energyClass = ENERGY_CORE; energyClass <= ENERGY_DRAM; energyClass++) {
+        int indices = (energyClass == ENERGY_PROCESSOR || energyClass == ENERGY_DRAM) ? 1 : numberOfCores;
+        staticEnergy[energyClass].resize(indices, 0);
+        dynamicEnergy[energyClass].resize(indices, 0);
+        for (int index = 0; index < indices; index++) {
+            registerStatsMetric(objectNames[energyClass], index, "energy-static", &staticEnergy[energyClass][index]);
+            registerStatsMetric(objectNames[energyClass], index, "energy-dynamic", &dynamicEnergy[energyClass][index]);
+        }
+    }
+}
+
+UInt64 PowerEstimator::readEvent(const Event &event, int index) const {
+    if (event.metrics[index] == NULL) {
+        return 0;
+    }
+    UInt64 value = event.metrics[index]->recordMetric();
+    if (event.subtractMetrics[index] != NULL) {
+        value -= event.subtractMetrics[index]->recordMetric();
+    }
+    return value;
+}
+
+/** getLevel
+ * Return the DVFS level of the given frequency (in MHz): the highest level at or below it, like energystats.py does for vdd.
+ */
+const PowerEstimator::Level& PowerEstimator::getLevel(int frequency) const {
+    for (const Level &level : levels) {
+        if (frequency >= level.frequency) {
+            return level;
+        }
+    }
+    return levels.back();
+}
+
+/** update
+ * P = static(level) + (vdd / referenceVdd)^2 * sum(energy per event * events per second)
+ */
+void PowerEstimator::update(SubsecondTime time) {
+    if (!metricsResolved) {
+        resolveMetrics();
+        lastTime = time;
+        return;
+    }
+    if (time <= lastTime) {
+        return;
+    }
+    double seconds = (time - lastTime).getFS() * 1e-15;
+
+    // per-core DVFS levels; shared components follow the fastest core
+    vector<const Level*> coreLevels;
+    int maxFrequency = 0;
+    for (int core = 0; core < numberOfCores; core++) {
+        int frequency = Sim()->getMagicServer()->getFrequency(core);
+        coreLevels.push_back(&getLevel(frequency));
+        maxFrequency = max(maxFrequency, frequency);
+    }
+    const Level &sharedLevel = getLevel(maxFrequency);
+
+    // event rates (per second) in the last interval
+    vector<vector<double>> coreRates(numberOfCores, vector<double>(events.size(), 0));
+    vector<double> sharedRates(events.size(), 0);
+    for (unsigned int e = 0; e < events.size(); e++) {
+        Event &event = events[e];
+        for (int index = 0; index < numberOfCores; index++) {
+            UInt64 value = readEvent(event, index);
+            // a counter can go backwards (statistics reset, or a subtracted metric growing faster than its base):
+            // count no events then, and continue from the new value
+            SInt64 delta = (SInt64)(value - event.lastValues[index]);
+            double rate = max(delta, (SInt64)0) / seconds;
+            event.lastValues[index] = value;
+            if (event.scope == SCOPE_CORE) {
+                coreRates[index][e] = rate;
+            } else {
+                sharedRates[e] += rate;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < componentNames.size(); i++) {
+        const vector<double> &energy = energies[columnComponent[i]];
+        int core = columnCore[i];
+        double staticPower;
+        double dynamicPower = 0;
+
+        if (core != -1) {
+            staticPower = coreLevels[core]->staticPower[columnComponent[i]];
+            double vddScale = coreLevels[core]->vdd / referenceVdd;
+            for (unsigned int e = 0; e < events.size(); e++) {
+                dynamicPower += energy[e] * ((events[e].scope == SCOPE_CORE) ? coreRates[core][e] : sharedRates[e]);
+            }
+            dynamicPower *= vddScale * vddScale;
+        } else {
+            // activity of every core is seen by a shared component, at the vdd of that core
+            staticPower = sharedLevel.staticPower[columnComponent[i]];
+            double sharedVddScale = sharedLevel.vdd / referenceVdd;
+            for (unsigned int e = 0; e < events.size(); e++) {
+                if (events[e].scope == SCOPE_CORE) {
+                    for (int c = 0; c < numberOfCores; c++) {
+                        double vddScale = coreLevels[c]->vdd / referenceVdd;
+                        dynamicPower += energy[e] * coreRates[c][e] * vddScale * vddScale;
+                    }
+                } else {
+                    dynamicPower += energy[e] * sharedRates[e] * sharedVddScale * sharedVddScale;
+                }
+            }
+        }
+        dynamicPower = max(0.0, dynamicPower);
+        powers[i] = staticPower + dynamicPower;
+
+        // energy in fJ: W * fs
+        UInt64 deltaStatic = (UInt64)(staticPower * (time - lastTime).getFS());
+        UInt64 deltaDynamic = (UInt64)(dynamicPower * (time - lastTime).getFS());
+        EnergyClass energyClass = columnEnergyClass[i];
+        int index = (core == -1) ? 0 : core;
+        staticEnergy[energyClass][index] += deltaStatic;
+        dynamicEnergy[energyClass][index] += deltaDynamic;
+        if (energyClass != ENERGY_DRAM && energyClass != ENERGY_PROCESSOR) {
+            staticEnergy[ENERGY_PROCESSOR][0] += deltaStatic;
+            dynamicEnergy[ENERGY_PROCESSOR][0] += deltaDynamic;
+        }
+    }
+
+    lastTime = time;
+    epochs++;
+}
+
+/** getComponentIndex
+ * Return the index of the given component or -1 if it is not modeled.
+ */
+int PowerEstimator::getComponentIndex(const string &componentName) const {
+    for (unsigned int i = 0; i < componentNames.size(); i++) {
+        if (componentNames[i] == componentName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/** getPowerOfCore
+ * Sum of the power of all components of the given core, or -1 if the core is not modeled.
+ */
+double PowerEstimator::getPowerOfCore(int coreId) const {
+    if ((coreId < 0) || (coreId >= numberOfCores)) {
+        return -1;
+    }
+    double power = 0;
+    for (unsigned int i = 0; i < componentNames.size(); i++) {
+        if (columnCore[i] == coreId) {
+            power += powers[i];
+        }
+    }
+    return power;
+}
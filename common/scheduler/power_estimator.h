@@ -0,0 +1,91 @@
+/**
+ * power_estimator
+ * This header implements a native power model that replaces the per-interval McPAT invocation.
+ * McPAT is characterized once (tools/mcpat_energy_table.py) into a table of static power per DVFS level and
+ * dynamic energy per simulator event. Every epoch, the power of each component is computed from the stat deltas.
+ */
+
+#ifndef __POWER_ESTIMATOR_H
+#define __POWER_ESTIMATOR_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+
+#include <string>
+#include <vector>
+
+class StatsMetricBase;
+
+class PowerEstimator {
+public:
+    PowerEstimator(const std::string &energyTableFilename, int numberOfCores);
+
+    // Compute the power of the interval since the previous call (in W) and accumulate the energy statistics
+    void update(SubsecondTime time);
+
+    // Names of the components (L3, C_0_FPU, ..., DRAM). The first getNumberOfLoggedComponents() are the power log columns
+    const std::vector<std::string>& getComponentNames() const { return componentNames; }
+    unsigned int getNumberOfLoggedComponents() const { return numberOfLoggedComponents; }
+    int getComponentIndex(const std::string &componentName) const;
+
+    // Latest power (in W), indexed like getComponentNames()
+    const std::vector<double>& getPowers() const { return powers; }
+    double getPowerOfComponent(int componentIndex) const { return powers.at(componentIndex); }
+    double getPowerOfCore(int coreId) const;
+
+    unsigned long getNumberOfEpochs() const { return epochs; }
+
+private:
+    enum Scope { SCOPE_CORE, SCOPE_SHARED, SCOPE_EXTRA };
+
+    struct Component {
+        std::string name;
+        Scope scope;
+    };
+    struct Event {
+        std::string objectName;
+        std::string metricName;
+        std::string subtractMetricName; // optional: the event is metricName - subtractMetricName
+        Scope scope;
+        std::vector<StatsMetricBase*> metrics; // per index (core), NULL if not registered
+        std::vector<StatsMetricBase*> subtractMetrics;
+        std::vector<UInt64> lastValues;
+    };
+    struct Level {
+        int frequency; // in MHz
+        double vdd;
+        std::vector<double> staticPower; // per table component
+    };
+
+    int numberOfCores;
+    double referenceVdd;
+    std::vector<Component> components;
+    std::vector<Event> events;
+    std::vector<Level> levels; // sorted from high to low frequency
+    std::vector<std::vector<double>> energies; // [component][event], in J per event at the reference vdd
+
+    // expanded log columns: table component and core (-1 for shared components)
+    std::vector<std::string> componentNames;
+    std::vector<int> columnComponent;
+    std::vector<int> columnCore;
+    std::vector<double> powers;
+    unsigned int numberOfLoggedComponents;
+
+    bool metricsResolved;
+    SubsecondTime lastTime;
+    unsigned long epochs;
+
+    // energy statistics, in the same units as scripts/energystats.py (fJ)
+    enum EnergyClass { ENERGY_CORE, ENERGY_L1I, ENERGY_L1D, ENERGY_L2, ENERGY_PROCESSOR, ENERGY_DRAM };
+    std::vector<EnergyClass> columnEnergyClass;
+    std::vector<UInt64> staticEnergy[6];
+    std::vector<UInt64> dynamicEnergy[6];
+
+    void readEnergyTable(const std::string &energyTableFilename);
+    void resolveMetrics();
+    void registerEnergyStatistics();
+    const Level& getLevel(int frequency) const;
+    UInt64 readEvent(const Event &event, int index) const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define __SCHEDULER_H
 
 #include "fixed_types.h"
+#include "subsecond_time.h"
 #include "thread_manager.h"
 
 class Scheduler
@@ -16,6 +17,7 @@ class Scheduler
       virtual void threadYield(thread_id_t thread_id) {}
       virtual bool threadSetAffinity(thread_id_t calling_thread_id, thread_id_t thread_id, size_t cpusetsize, const cpu_set_t *mask) { return false; }
       virtual bool threadGetAffinity(thread_id_t thread_id, size_t cpusetsize, cpu_set_t *mask) { return false; }
+      virtual void appHeartbeat(app_id_t app_id, thread_id_t thread_id, SubsecondTime time, UInt64 tag) {}
 
    protected:
       ThreadManager *m_thread_manager;
@@ -23,14 +23,11 @@
 #include <iomanip>
 #include <random>
 #include <vector>
-#include <queue>
 #include <iostream>
 #include <bits/stdc++.h>
 
 using namespace std;
 
-int k=0;
-
 String queuePolicy; //Stores Queuing Policy for Open System from base.cfg.
 String distribution; //Stores the arrival distribution of the open workload from base.cfg.
 
@@ -44,87 +41,6 @@ int numberOfCores; //Stores the number of cores in the system.
 
 int coreRequirementTranslation (String compositionString);
 
-//This data structure maintains the state of the tasks.
-struct openTask {
-
-	openTask(int taskIDInput, String taskNameInput) : taskID(taskIDInput), taskName(taskNameInput) {}
-
-	int taskID;
-        String taskName;
-	bool waitingToSchedule = true;
-	bool waitingInQueue = false;
-	bool active = false;
-	bool completed = false;
-	int taskCoreRequirement = coreRequirementTranslation(taskName);
-	UInt64 taskArrivalTime;
-	UInt64 taskStartTime;
-	UInt64 taskDepartureTime; 
-	int priority;
-	
-};
-
-vector <openTask> openTasks;
-
-struct ComparePriority {															//custom comparator for waitingTaskQ
-			bool operator()(openTask p1, openTask p2){
-			// return "true" if "p1" is ordered
-			// before "p2", for example:
-				if(p1.priority == p2.priority){
-					return p1.taskArrivalTime > p2.taskArrivalTime;
-				}
-				else{
-					return p1.priority < p2.priority;
-				}
-			}
-		};
-
-struct ComparePriorityAQ {															//custom comparator for ActiveTaskQ
-			bool operator()(openTask p1, openTask p2){
-			// return "true" if "p1" is ordered
-			// before "p2", for example:
-				return p1.priority > p2.priority;
-			}
-		};
-
-void showAQ(priority_queue<openTask, vector<openTask>, ComparePriorityAQ> gq)		//display taskID of tasks in ActiveTaskQ
-{
-    priority_queue<openTask, vector<openTask>, ComparePriorityAQ> g = gq;
-    while (!g.empty()) {
-        cout << g.top().taskID;
-        g.pop();
-    }
-    cout << '\n';
-};
-
-void showtaskID(priority_queue<openTask, vector<openTask>, ComparePriority> gq)		//display taskID of tasks in waitingTaskQ
-{
-    priority_queue<openTask, vector<openTask>, ComparePriority> g = gq;
-    while (!g.empty()) {
-        cout << g.top().taskID;
-        g.pop();
-    }
-    cout << '\n';
-};
-
-
-priority_queue<openTask, vector<openTask>, ComparePriority> waitingTaskQ;			//This priority queue holds the tasks in waiting queue in order of priority (with highest priority at top)
-priority_queue<openTask, vector<openTask>, ComparePriorityAQ> ActiveTaskQ;		//This priority queue holds the tasks that are active in order of priority (with lowest priority at top)
-
-		
-//This data structure maintains the state of the cores.
-struct systemCore {
-
-	systemCore(int coreIDInput) : coreID(coreIDInput) {}
-
-	int coreID;
-	int assignedTaskID = -1; // -1 means core assigned to no task
-	int assignedThreadID = -1;// -1 means core assigned to no thread.
-};
-
-vector <systemCore> systemCores;
-
-
-
 /** SchedulerOpen
     Constructor for Open Scheduler
 */
@@ -151,8 +67,14 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 	}
 
 
+	int heartbeatWindow = Sim()->getCfg()->getInt("scheduler/open/hb_window");
+	if (heartbeatWindow < 1) {
+		cout << "\n[Scheduler] [Error]: scheduler/open/hb_window must be at least 1" << endl;
+		exit (1);
+	}
 	performanceCounters = new PerformanceCounters(Sim()->getCfg()->getString("general/output_dir").c_str(),
-		"InstantaneousPower.log", "InstantaneousTemperature.log", "InstantaneousCPIStack.log", "InstantaneousRvalue.log");
+		"InstantaneousPower.log", "InstantaneousTemperature.log", "InstantaneousCPIStack.log", "InstantaneousRvalue.log",
+		heartbeatWindow);
 
 	mappingEpoch = atol (Sim()->getCfg()->getString("scheduler/open/epoch").c_str());
 	queuePolicy = Sim()->getCfg()->getString("scheduler/open/queuePolicy").c_str();
@@ -185,16 +107,13 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 	// thermalModel = new ThermalModel((unsigned int)coreRows, (unsigned int)coreColumns, Sim()->getCfg()->getString("periodic_thermal/thermal_model"), ambientTemperature, maxTemperature, inactivePower, tdp);
 	thermalModel = NULL;
 
-	//Initialize the cores in the system.
-	for (int coreIterator=0; coreIterator < numberOfCores; coreIterator++) {
-		systemCores.push_back (coreIterator);
-	}
-
-	//Initialize the task state array.
+	//Initialize the cores in the system and the task state array.
+	openSystem = new OpenSystemState(numberOfCores);
 	String benchmarks = Sim()->getCfg()->getString("traceinput/benchmarks");
 	String benchmarksDelimiter = "+";
 	for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-		openTasks.push_back (openTask (taskIterator,benchmarks.substr(0, benchmarks.find(benchmarksDelimiter))));
+		String taskName = benchmarks.substr(0, benchmarks.find(benchmarksDelimiter));
+		openSystem->addTask(taskName, coreRequirementTranslation(taskName));
 		benchmarks.erase(0, benchmarks.find(benchmarksDelimiter) + benchmarksDelimiter.length());		
 	}						
 
@@ -203,16 +122,16 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 
 		if(randomPriority == true){
 			for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-				openTasks[taskIterator].priority = rand()%10;
+				openSystem->getTask(taskIterator).priority = rand()%10;
 				
-				cout << "[Scheduler]: Setting Priority for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << openTasks[taskIterator].priority << endl;
+				cout << "[Scheduler]: Setting Priority for Task " << taskIterator << " (" + openSystem->getTask(taskIterator).taskName + ")" << " to " << openSystem->getTask(taskIterator).priority << endl;
 			}
 		}
 		else{
 			for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
 			UInt64 priorityvalue = Sim()->getCfg()->getIntArray("scheduler/open/explicitPriorityValues", taskIterator);
-			cout << "[Scheduler]: Setting Priority for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << priorityvalue << endl;
-			openTasks[taskIterator].priority = priorityvalue;
+			cout << "[Scheduler]: Setting Priority for Task " << taskIterator << " (" + openSystem->getTask(taskIterator).taskName + ")" << " to " << priorityvalue << endl;
+			openSystem->getTask(taskIterator).priority = priorityvalue;
 			
 			}
 		}
@@ -224,15 +143,15 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 		UInt64 time = 0;
 		for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
 			if (taskIterator % arrivalRate == 0 && taskIterator != 0) time += arrivalInterval;  
-			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << time << +" ns" << endl;
-			openTasks[taskIterator].taskArrivalTime = time;
+			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openSystem->getTask(taskIterator).taskName + ")" << " to " << time << +" ns" << endl;
+			openSystem->getTask(taskIterator).taskArrivalTime = time;
 							
 		}
 	} else if (distribution == "explicit") {
 		for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
 			UInt64 time = Sim()->getCfg()->getIntArray("scheduler/open/explicitArrivalTimes", taskIterator);
-			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << time << +" ns" << endl;
-			openTasks[taskIterator].taskArrivalTime = time;
+			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openSystem->getTask(taskIterator).taskName + ")" << " to " << time << +" ns" << endl;
+			openSystem->getTask(taskIterator).taskArrivalTime = time;
 			
 		}
 	} else if (distribution == "poisson") {
@@ -255,8 +174,8 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
 			if (taskIterator % arrivalRate == 0 && taskIterator != 0) {
 				time += (UInt64)expdistribution(generator);
 			}
-			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openTasks[taskIterator].taskName + ")" << " to " << time << +" ns" << endl;
-			openTasks[taskIterator].taskArrivalTime = time;
+			cout << "[Scheduler]: Setting Arrival Time for Task " << taskIterator << " (" + openSystem->getTask(taskIterator).taskName + ")" << " to " << time << +" ns" << endl;
+			openSystem->getTask(taskIterator).taskArrivalTime = time;
 				
 		}
 
@@ -266,15 +185,178 @@ SchedulerOpen::SchedulerOpen(ThreadManager *thread_manager)
  		exit (1);
 	}
 
-	for(int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++){
-		waitingTaskQ.push(openTasks[taskIterator]);
-		cout << "Pushing Task " << taskIterator << " to the waitingTaskQ" << endl;
+	mappingLog = Sim()->getCfg()->getString("scheduler/open/mapping_log").c_str();
+	if (mappingLog == "file") {
+		mappingLogFile.open((std::string(Sim()->getCfg()->getString("general/output_dir").c_str()) + "/OpenMapping.log").c_str());
+		mappingLogFile << "time";
+		for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
+			mappingLogFile << "\tC_" << coreCounter;
+		}
+		mappingLogFile << endl;
+	} else if (mappingLog != "none" && mappingLog != "console") {
+		cout << "\n[Scheduler] [Error]: Unknown mapping log: '" << mappingLog << "'" << endl;
+ 		exit (1);
 	}
-	
+
+	powerEpoch = Sim()->getCfg()->getInt("periodic_thermal/sampling_interval");
+	initPowerModel();
+	initThermalEngine();
 	initMappingPolicy(Sim()->getCfg()->getString("scheduler/open/logic").c_str());
 	initDVFSPolicy(Sim()->getCfg()->getString("scheduler/open/dvfs/logic").c_str());
 	initMigrationPolicy(Sim()->getCfg()->getString("scheduler/open/migration/logic").c_str());
 	initPerforationPolicy("", numberOfTasks);
+
+	//Queue the first occurrence of every epoch and the arrival of every task.
+	//Epochs first run once a full epoch has passed, there is nothing to measure at the start of the simulation.
+	arrivalScheduling = Sim()->getCfg()->getBool("scheduler/open/arrival_scheduling");
+	scheduleEvent(statusEpoch, EVENT_STATUS);
+	scheduleEvent(powerEpoch, EVENT_POWER);
+	if (hotspotEngine != NULL) {
+		scheduleEvent(thermalEpoch, EVENT_THERMAL);
+	}
+	if (migrationPolicy != NULL) {
+		scheduleEvent(migrationEpoch, EVENT_MIGRATION);
+	}
+	if (dvfsPolicy != NULL) {
+		scheduleEvent(dvfsEpoch, EVENT_DVFS);
+	}
+	scheduleEvent(mappingEpoch, EVENT_MAPPING);
+	scheduleArrivals();
+}
+
+/** getSniperPath
+ * Resolve a path relative to the root of the simulator, unless it is absolute.
+ */
+std::string getSniperPath(String filename) {
+	if (filename.c_str()[0] == '/') {
+		return std::string(filename.c_str());
+	}
+	const char *root = getenv("SNIPER_ROOT");
+	if (root == NULL) {
+		root = getenv("GRAPHITE_ROOT");
+	}
+	return std::string(root ? root : "..") + "/" + filename.c_str();
+}
+
+/** getHotSpotPath
+ * Resolve a path from the periodic_thermal section the same way tools/mcpat.py does (relative to the hotspot directory).
+ */
+std::string getHotSpotPath(String filename) {
+	if (filename.c_str()[0] == '/') {
+		return std::string(filename.c_str());
+	}
+	return getSniperPath("hotspot/" + filename);
+}
+
+/** initPowerModel
+ * Load the native power model if selected. Otherwise scripts/energystats.py runs McPAT every power interval.
+ */
+void SchedulerOpen::initPowerModel() {
+	String model = Sim()->getCfg()->getString("power/model");
+	if (model == "mcpat") {
+		return;
+	} else if (model != "native") {
+		cout << "\n[Scheduler] [Error]: Unknown Power Model: '" << model << "'" << endl;
+		exit (1);
+	}
+	if (Sim()->getCfg()->getBool("periodic_thermal/enabled") && (Sim()->getCfg()->getString("periodic_thermal/engine") != "internal")) {
+		cout << "\n[Scheduler] [Error]: The native power model requires periodic_thermal/engine = internal" << endl;
+		exit (1);
+	}
+
+	cout << "[Scheduler] [Info]: Initializing native power model" << endl;
+	powerEstimator = new PowerEstimator(getSniperPath(Sim()->getCfg()->getString("power/energy_table")), numberOfCores);
+	performanceCounters->publishPower(powerEstimator->getComponentNames(), powerEstimator->getPowers());
+}
+
+/** executePowerModel
+ * Compute the power of the last interval. The power logs are still written for the plotting scripts and the external thermal engine.
+ */
+void SchedulerOpen::executePowerModel(SubsecondTime time) {
+	powerEstimator->update(time);
+	if (powerEstimator->getNumberOfEpochs() == 0) {
+		return; // first call only takes the reference values of the statistics
+	}
+	performanceCounters->publishPower(powerEstimator->getComponentNames(), powerEstimator->getPowers());
+
+	const std::vector<std::string> &components = powerEstimator->getComponentNames();
+	const std::vector<double> &powers = powerEstimator->getPowers();
+	std::string outputDir = Sim()->getCfg()->getString("general/output_dir").c_str();
+	std::ostringstream header;
+	std::ostringstream readings;
+	for (unsigned int c = 0; c < powerEstimator->getNumberOfLoggedComponents(); c++) {
+		header << (c > 0 ? "\t" : "") << components[c];
+		readings << (c > 0 ? "\t" : "") << powers[c];
+	}
+
+	std::ofstream instPowerFile(outputDir + "/InstantaneousPower.log");
+	instPowerFile << header.str() << endl << readings.str() << endl;
+
+	bool firstEpoch = powerEstimator->getNumberOfEpochs() == 1;
+	std::ofstream periodicPowerFile(outputDir + "/PeriodicPower.log", firstEpoch ? std::ios::trunc : std::ios::app);
+	if (firstEpoch) {
+		periodicPowerFile << header.str() << endl;
+	}
+	periodicPowerFile << readings.str() << endl;
+}
+
+/** initThermalEngine
+ * Build the in-process HotSpot model if the internal thermal engine is selected.
+ * Otherwise tools/mcpat.py keeps forking the hotspot binary every power interval.
+ */
+void SchedulerOpen::initThermalEngine() {
+	if (!Sim()->getCfg()->getBool("periodic_thermal/enabled")) {
+		return;
+	}
+
+	String engine = Sim()->getCfg()->getString("periodic_thermal/engine");
+	if (engine == "external") {
+		return;
+	} else if (engine != "internal") {
+		cout << "\n[Scheduler] [Error]: Unknown Thermal Engine: '" << engine << "'" << endl;
+		exit (1);
+	}
+	if (Sim()->getCfg()->getBool("reliability/enabled")) {
+		cout << "\n[Scheduler] [Error]: Reliability modeling requires periodic_thermal/engine = external" << endl;
+		exit (1);
+	}
+
+	cout << "[Scheduler] [Info]: Initializing in-process thermal engine" << endl;
+	thermalEpoch = Sim()->getCfg()->getInt("periodic_thermal/sampling_interval");
+	hotspotEngine = new HotSpotEngine(getHotSpotPath(Sim()->getCfg()->getString("periodic_thermal/floorplan")),
+		getHotSpotPath(Sim()->getCfg()->getString("periodic_thermal/hotspot_config")));
+	performanceCounters->publishTemperatures(hotspotEngine->getUnitNames(), hotspotEngine->getTemperatures());
+}
+
+/** executeThermalEngine
+ * Advance the thermal model with the power of the last interval.
+ * The temperature logs are still written for the plotting scripts, but the scheduler reads the temperatures from memory.
+ */
+void SchedulerOpen::executeThermalEngine(SubsecondTime time) {
+	const std::vector<std::string> &units = hotspotEngine->getUnitNames();
+	std::vector<double> powers = performanceCounters->getPowerOfComponents(units);
+	hotspotEngine->computeTemperatures(powers, thermalEpoch * 1e-9);
+	performanceCounters->publishTemperatures(units, hotspotEngine->getTemperatures());
+
+	const std::vector<double> &temperatures = hotspotEngine->getTemperatures();
+	std::string outputDir = Sim()->getCfg()->getString("general/output_dir").c_str();
+	std::ostringstream header;
+	std::ostringstream readings;
+	readings << std::fixed << std::setprecision(2);
+	for (unsigned int u = 0; u < units.size(); u++) {
+		header << (u > 0 ? "\t" : "") << units[u];
+		readings << (u > 0 ? "\t" : "") << temperatures[u];
+	}
+
+	std::ofstream instTemperatureFile(outputDir + "/InstantaneousTemperature.log");
+	instTemperatureFile << header.str() << endl << readings.str() << endl;
+
+	bool firstEpoch = hotspotEngine->getNumberOfEpochs() == 1;
+	std::ofstream periodicThermalFile(outputDir + "/PeriodicThermal.log", firstEpoch ? std::ios::trunc : std::ios::app);
+	if (firstEpoch) {
+		periodicThermalFile << header.str() << endl;
+	}
+	periodicThermalFile << readings.str() << endl;
 }
 
 /** initMappingPolicy
@@ -305,7 +387,9 @@ void SchedulerOpen::initMappingPolicy(String policyName) {
 		double maxPower = Sim()->getCfg()->getFloat("periodic_thermal/tdp");
 		String inactivePowerFileName = Sim()->getCfg()->getString("periodic_thermal/inactive_power_file");
 		thermalComponentModel = new ThermalComponentModel((unsigned int)coreRows, (unsigned int)coreColumns, (unsigned int)nodesPerCore, thermalModelFilename, floorplanFileName, inactivePowerFileName, ambientTemperature, maxTemperature, inactivePower, tdp, performanceCounters);
-		mappingPolicy = new PCGov(thermalComponentModel, performanceCounters, coreRows, coreColumns, minFrequency, maxFrequency, frequencyStepSize, delta);
+		unsigned int mappingThreads = Sim()->getCfg()->getInt("scheduler/open/dvfs/pcgov/mapping_threads");
+		unsigned long searchNodes = Sim()->getCfg()->getInt("scheduler/open/dvfs/pcgov/search_nodes");
+		mappingPolicy = new PCGov(thermalComponentModel, performanceCounters, coreRows, coreColumns, minFrequency, maxFrequency, frequencyStepSize, delta, mappingThreads, searchNodes);
 	} else {
 		cout << "\n[Scheduler] [Error]: Unknown Mapping Algorithm" << endl;
  		exit (1);
@@ -367,37 +451,17 @@ void SchedulerOpen::initMigrationPolicy(String policyName) {
 }
 
 /** taskFrontOfQueue
-    Returns the ID of the task in front of queue. Place to implement a new queuing policy.
+    Returns the ID of the task in front of queue, -1 if the queue is empty. Place to implement a new queuing policy.
 */
-int taskFrontOfQueue () {
+int SchedulerOpen::taskFrontOfQueue () {
 	int IDofTaskInFrontOfQueue = -1;
 
 	if (queuePolicy == "FIFO") {
-		for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-			if (openTasks [taskIterator].waitingInQueue) {
-				IDofTaskInFrontOfQueue = taskIterator;
-				break;
-			}
-		}
+		IDofTaskInFrontOfQueue = openSystem->firstTask(TASK_IN_QUEUE);
 	}
 	//else if (queuePolicy ="XYZ") {... } //Place to implement a new queuing policy.
 	else if (queuePolicy == "priority"){ 
-		SubsecondTime time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
-		if ((openTasks [waitingTaskQ.top().taskID].waitingInQueue) && (openTasks[waitingTaskQ.top().taskID].taskArrivalTime <= time.getNS())){
-
-			IDofTaskInFrontOfQueue = waitingTaskQ.top().taskID;
-
-		}
-
-		else {
-			while ((!openTasks [waitingTaskQ.top().taskID].waitingInQueue) || (!(openTasks[waitingTaskQ.top().taskID].taskArrivalTime <= time.getNS()))){
-
-				waitingTaskQ.pop();
-
-			}
-			IDofTaskInFrontOfQueue = waitingTaskQ.top().taskID;
-		}
-		
+		IDofTaskInFrontOfQueue = openSystem->getHighestPriorityQueuedTask();
 	}
 	else {
 	
@@ -408,85 +472,11 @@ int taskFrontOfQueue () {
 	return IDofTaskInFrontOfQueue;
 }
 
-/** numberOfFreeCores
-    Returns number of free cores in the system.
-*/
-int numberOfFreeCores () {
-	int freeCoresCounter = 0;
-	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
-		if (systemCores[coreCounter].assignedTaskID == -1) {
-			freeCoresCounter++;
-		}
-	}
-	return freeCoresCounter;
-}
-
-/** numberOfTasksInQueue
-    Returns the number of tasks in the queue.
-*/
-int numberOfTasksInQueue () {
-	int tasksInQueue = 0;
-	
-	for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) 
-		if (openTasks[taskCounter].waitingInQueue == true) 
-			tasksInQueue++;
-	
-	return tasksInQueue;
-}
-
-/** numberOfTasksWaitingToSchedule
-    Returns the number of tasks not yet entered into the queue.
-*/
-int numberOfTasksWaitingToSchedule () {
-	int tasksWaitingToSchedule = 0;
-	
-	for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) 
-		if (openTasks[taskCounter].waitingToSchedule == true) 
-			tasksWaitingToSchedule++;
-
-	
-	return tasksWaitingToSchedule;
-}
-
-/** numberOfTasksCompleted
-    Returns the number of tasks completed.
+/** appHeartbeat
+    Called by the magic server when a thread of application "app_id" registers a heartbeat (SIM_CMD_HEARTBEAT).
 */
-int numberOfTasksCompleted () {
-	int tasksCompleted = 0;
-	
-	for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) 
-		if (openTasks[taskCounter].completed == true) 
-			tasksCompleted++;
-
-	
-	return tasksCompleted;
-}
-
-/** numberOfActiveTasks
-    Returns the number of active tasks.
-*/
-int numberOfActiveTasks () {
-	int activeTasks = 0;
-	
-	for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) 
-		if (openTasks[taskCounter].active == true) 
-			activeTasks++;
-
-	
-	return activeTasks;
-}
-
-/** numberOfActiveTasks
-    Returns the number of core required by all active tasks.
-*/
-int totalCoreRequirementsOfActiveTasks () {
-	int coreRequirement = 0;
-	
-	for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) 
-		if (openTasks[taskCounter].active == true) 
-			coreRequirement += openTasks[taskCounter].taskCoreRequirement;
-
-	return coreRequirement;
+void SchedulerOpen::appHeartbeat(app_id_t app_id, thread_id_t thread_id, SubsecondTime time, UInt64 tag) {
+	performanceCounters->notifyHeartbeat(app_id, time.getNS(), tag);
 }
 
 /** threadSetAffinity
@@ -560,7 +550,7 @@ int SchedulerOpen::setAffinity (thread_id_t thread_id) {
 	app_id_t app_id =  Sim()->getThreadManager()->getThreadFromID(thread_id)->getAppId();
 
 	for (int  i = 0; i<numberOfCores; i++) 
-		if (systemCores[i].assignedTaskID == app_id && systemCores[i].assignedThreadID == -1) {
+		if (openSystem->getCore(i).assignedTaskID == app_id && openSystem->getCore(i).assignedThreadID == -1) {
 				coreFound = i;
 				break;
 		}
@@ -578,7 +568,7 @@ int SchedulerOpen::setAffinity (thread_id_t thread_id) {
 		CPU_ZERO(&my_set); 
 		CPU_SET(coreFound, &my_set);
 		threadSetAffinity(INVALID_THREAD_ID, thread_id, sizeof(cpu_set_t), &my_set); 
-		systemCores[coreFound].assignedThreadID = thread_id; 
+		openSystem->assignThread(coreFound, thread_id);
 	}
 
 	return coreFound;
@@ -592,7 +582,7 @@ void SchedulerOpen::migrateThread(thread_id_t thread_id, core_id_t core_id)
 {
 	int from_core_id = -1;
 	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
-		if (systemCores[coreCounter].assignedThreadID == thread_id) {
+		if (openSystem->getCore(coreCounter).assignedThreadID == thread_id) {
 			from_core_id = coreCounter;
 			break;
 		}
@@ -615,11 +605,10 @@ void SchedulerOpen::migrateThread(thread_id_t thread_id, core_id_t core_id)
 		CPU_SET(core_id, &my_set);
 		threadSetAffinity(INVALID_THREAD_ID, thread_id, sizeof(cpu_set_t), &my_set); 
 
-		systemCores[core_id].assignedTaskID = systemCores[from_core_id].assignedTaskID;
-		systemCores[core_id].assignedThreadID = thread_id;
+		openSystem->assignCore(core_id, openSystem->getCore(from_core_id));
 
-		systemCores[from_core_id].assignedTaskID = -1;
-		systemCores[from_core_id].assignedThreadID = -1;
+		openSystem->assignTask(from_core_id, -1);
+		openSystem->assignThread(from_core_id, -1);
 	}
 }
 
@@ -639,14 +628,14 @@ int SchedulerOpen::getCoreNb(int y, int x) {
  * Return whether the given core is assigned to a task.
  */
 bool SchedulerOpen::isAssignedToTask(int coreId) {
-	return systemCores[coreId].assignedTaskID != -1;
+	return !openSystem->isCoreFree(coreId);
 }
 
 /** isAssignedToThread
  * Return whether the given core is assigned to a thread.
  */
 bool SchedulerOpen::isAssignedToThread(int coreId) {
-	return systemCores[coreId].assignedThreadID != -1;
+	return openSystem->getCore(coreId).assignedThreadID != -1;
 }
 
 bool SchedulerOpen::executeMappingPolicy(int taskID, SubsecondTime time) {
@@ -657,8 +646,9 @@ bool SchedulerOpen::executeMappingPolicy(int taskID, SubsecondTime time) {
 		activeCores.at(i) = isAssignedToTask(i);
 	}
 	// get the cores
-	vector<int> bestCores = mappingPolicy->map(openTasks[taskID].taskName, openTasks[taskID].taskCoreRequirement, availableCores, activeCores);
-	if ((int)bestCores.size() < openTasks[taskID].taskCoreRequirement) {
+	const OpenTask &task = openSystem->getTask(taskID);
+	vector<int> bestCores = mappingPolicy->map(task.taskName, task.taskCoreRequirement, availableCores, activeCores);
+	if ((int)bestCores.size() < task.taskCoreRequirement) {
 		cout << "[Scheduler]: Policy returned too few cores, mapping failed." << endl;
 		return false;
 	}
@@ -666,7 +656,7 @@ bool SchedulerOpen::executeMappingPolicy(int taskID, SubsecondTime time) {
 	// assign the cores
 	for (unsigned int i = 0; i < bestCores.size(); i++) {
 		cout << "[Scheduler]: Assigning Core " << bestCores.at(i) << " to Task " << taskID << endl;
-		systemCores[bestCores.at(i)].assignedTaskID = taskID;
+		openSystem->assignTask(bestCores.at(i), taskID);
 	}
 
 	return true;
@@ -679,29 +669,16 @@ bool SchedulerOpen::schedule (int taskID, bool isInitialCall, SubsecondTime time
 	cout <<"\n[Scheduler]: Trying to schedule Task " << taskID << " at Time " << formatTime(time) << endl;
 
 	bool mappingSuccesfull = false;
+	OpenTask &task = openSystem->getTask(taskID);
 
-	if (openTasks [taskID].taskArrivalTime > time.getNS ()) {
+	if (task.taskArrivalTime > time.getNS ()) {
 		cout <<"\n[Scheduler]: Task " << taskID << " is not ready for execution. \n";	
 		return false; //Task not ready for mapping.
 	} 
 	
-	else {
+	else if (task.state == TASK_WAITING_TO_SCHEDULE) {
 		cout <<"\n[Scheduler]: Task " << taskID << " put into execution queue. \n";
-		openTasks [taskID].waitingInQueue = true;
-		openTasks [taskID].waitingToSchedule = false;
-			
-		if(waitingTaskQ.size()>1){
-			openTask tempo = waitingTaskQ.top();
-			waitingTaskQ.pop();
-			
-			if(tempo.taskID != waitingTaskQ.top().taskID){		//making sure that one task doesn't get pushed to waitingTaskQ twice
-				waitingTaskQ.push(tempo);
-			}
-			else{
-				waitingTaskQ.pop();
-				waitingTaskQ.push(openTasks[tempo.taskID]);
-			}
-		}	
+		openSystem->setTaskState(taskID, TASK_IN_QUEUE);
 	}
 
 	if (taskFrontOfQueue () != taskID) {
@@ -710,52 +687,39 @@ bool SchedulerOpen::schedule (int taskID, bool isInitialCall, SubsecondTime time
 		return false; //Not turn of this task to be mapped.
 	}
 
-	if (numberOfFreeCores () < openTasks[taskID].taskCoreRequirement) { //If priority queuing is adopted, then we need to check for it and readjust tasks if required
- 		if((queuePolicy == "priority") && (openTasks [ActiveTaskQ.top().taskID].priority < openTasks[taskID].priority)){
-		   	 while((numberOfFreeCores () < openTasks[taskID].taskCoreRequirement) && (openTasks[ActiveTaskQ.top().taskID].priority < openTasks[taskID].priority) ){
+	if (openSystem->getNumberOfFreeCores () < task.taskCoreRequirement) { //If priority queuing is adopted, then we need to check for it and readjust tasks if required
+		int victimID = openSystem->getLowestPriorityActiveTask();
+ 		if((queuePolicy == "priority") && (victimID != -1) && (openSystem->getTask(victimID).priority < task.priority)){
+		   	 while((openSystem->getNumberOfFreeCores () < task.taskCoreRequirement) && (victimID != -1) && (openSystem->getTask(victimID).priority < task.priority) ){
 				for(int t=0; t < Sim()->getThreadManager()->getNumThreads() ; t++ ){
 					app_id_t app_id =  Sim()->getThreadManager()->getThreadFromID(t)->getAppId();
-					if(ActiveTaskQ.top().taskID == app_id ){
-						 SubsecondTime time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
-						
+					if(victimID == app_id ){
 						for (int i = 0; i < numberOfCores; i++) {
-							if (systemCores[i].assignedThreadID == t){
-								systemCores[i].assignedThreadID = -1;
+							if (openSystem->getCore(i).assignedThreadID == t){
+								openSystem->assignThread(i, -1);
 								cout << "\n[Scheduler]: Releasing Core " << i << " from Thread " << t << "\n";
-								
-								cpu_set_t my_set; 
-								CPU_ZERO(&my_set); 
-								CPU_SET(INVALID_CORE_ID, &my_set);
-								Sim()->getThreadManager()->getLock();
 								m_thread_info[t].clearAffinity();	
 							}
 
 						}
 					
 						if (t < numberOfTasks) {									
-							
-
 							for (int i = 0; i < numberOfCores; i++) {
-								if (systemCores[i].assignedTaskID == app_id) {
-									systemCores[i].assignedTaskID = -1;
+								if (openSystem->getCore(i).assignedTaskID == app_id) {
+									openSystem->assignTask(i, -1);
 								}
 							}
 						}				 	
 					}
 				}
 				 	
-				openTasks[ActiveTaskQ.top().taskID].active = false;
-				openTasks[ActiveTaskQ.top().taskID].waitingInQueue = true;
-				if(waitingTaskQ.top().taskID != ActiveTaskQ.top().taskID){
-					waitingTaskQ.push(ActiveTaskQ.top());
-				}
-				ActiveTaskQ.pop();
-				k++;
+				openSystem->setTaskState(victimID, TASK_IN_QUEUE);
+				victimID = openSystem->getLowestPriorityActiveTask();
 			}																								
 	 	}
 		 
 		else{						
-			cout <<"\n[Scheduler]: Not Enough Free Cores (" << numberOfFreeCores () << ") to Schedule the Task " << taskID << " with cores requirement " << openTasks[taskID].taskCoreRequirement  << endl;
+			cout <<"\n[Scheduler]: Not Enough Free Cores (" << openSystem->getNumberOfFreeCores () << ") to Schedule the Task " << taskID << " with cores requirement " << task.taskCoreRequirement  << endl;
 			return false;
 		}
 	}
@@ -765,17 +729,8 @@ bool SchedulerOpen::schedule (int taskID, bool isInitialCall, SubsecondTime time
 			if (!isInitialCall) 
 			cout << "\n[Scheduler]: Waking Task " << taskID << " at core " << setAffinity (taskID) << endl;
 				
-		openTasks [taskID].taskStartTime = time.getNS();
-		
-		openTasks [taskID].active = true;		
-		ActiveTaskQ.push(openTasks[taskID]);
-		openTasks [taskID].waitingInQueue = false;
-		
-		if((queuePolicy=="priority") && (waitingTaskQ.top().taskID == taskID)){
-			waitingTaskQ.pop();
-		}
-			
-		openTasks [taskID].waitingToSchedule = false;
+		task.taskStartTime = time.getNS();
+		openSystem->setTaskState(taskID, TASK_ACTIVE);
 	} 
 
 	return mappingSuccesfull;
@@ -847,40 +802,15 @@ core_id_t SchedulerOpen::threadCreate(thread_id_t thread_id) {
 /** fetchTasksIntoQueue
     This function pulls tasks into the openSystem Queue.
 */
-void fetchTasksIntoQueue (SubsecondTime time) {
-
-	if(queuePolicy == "priority"){
-		for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) {
-			if (openTasks [taskCounter].waitingToSchedule && openTasks [taskCounter].taskArrivalTime <= time.getNS ()) {
-				
-				cout <<"\n[Scheduler]: Task " << taskCounter << " put into execution queue. \n";
-				openTasks [taskCounter].waitingInQueue = true;
-				
-				
-					if(waitingTaskQ.top().taskID != taskCounter){
-					waitingTaskQ.push(openTasks [taskCounter]);
-					}
-					
-					if(waitingTaskQ.top().taskID == ActiveTaskQ.top().taskID){
-						waitingTaskQ.pop();
-					}
-			
-			
-				openTasks [taskCounter].waitingToSchedule = false;
-
-				cout << "Task " << taskCounter << " has been pushed to waitingTaskQ" << endl;
-			}
-		}
-	}
-
-	else{
-		for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++) {
-			if (openTasks [taskCounter].waitingToSchedule && openTasks [taskCounter].taskArrivalTime <= time.getNS ()) {
-				cout <<"\n[Scheduler]: Task " << taskCounter << " put into execution queue. \n";
-				openTasks [taskCounter].waitingInQueue = true;
-				openTasks [taskCounter].waitingToSchedule = false;
-			}
+void SchedulerOpen::fetchTasksIntoQueue (SubsecondTime time) {
+	int taskCounter = openSystem->firstTask(TASK_WAITING_TO_SCHEDULE);
+	while (taskCounter != -1) {
+		int nextTask = openSystem->nextTask(taskCounter);
+		if (openSystem->getTask(taskCounter).taskArrivalTime <= time.getNS ()) {
+			cout <<"\n[Scheduler]: Task " << taskCounter << " put into execution queue. \n";
+			openSystem->setTaskState(taskCounter, TASK_IN_QUEUE);
 		}
+		taskCounter = nextTask;
 	}
 }
 
@@ -897,8 +827,8 @@ void SchedulerOpen::threadExit(thread_id_t thread_id, SubsecondTime time) {
 	cout << "\n[Scheduler]: Thread " << thread_id << " from Task "  << app_id << " Exiting at Time " << formatTime(time) << endl;
 
 	for (int i = 0; i < numberOfCores; i++) {
-		if (systemCores[i].assignedThreadID == thread_id) {
-			systemCores[i].assignedThreadID = -1;
+		if (openSystem->getCore(i).assignedThreadID == thread_id) {
+			openSystem->assignThread(i, -1);
 			cout << "\n[Scheduler]: Releasing Core " << i << " from Thread " << thread_id << "\n";
 			
 			cpu_set_t my_set; 
@@ -915,66 +845,38 @@ void SchedulerOpen::threadExit(thread_id_t thread_id, SubsecondTime time) {
 		cout << "\n[Scheduler]: Task " << app_id << " Finished." << "\n";
 
 			for (int i = 0; i < numberOfCores; i++) {
-				if (systemCores[i].assignedTaskID == app_id) {
-					systemCores[i].assignedTaskID = -1;
+				if (openSystem->getCore(i).assignedTaskID == app_id) {
+					openSystem->assignTask(i, -1);
 					cout << "\n[Scheduler]: Releasing Core " << i << " from Task " << app_id << "\n";
 				}
 			}
 
-			openTasks[app_id].taskDepartureTime = time.getNS();
-			openTasks[app_id].completed = true;
-			openTasks[app_id].active = false;
-			if(queuePolicy == "priority"){
-				priority_queue<openTask, vector<openTask>, ComparePriority> tempQ;
-
-				if(ActiveTaskQ.top().taskID == app_id){
-
-					ActiveTaskQ.pop();
-
-				}
-				else{
-					while(ActiveTaskQ.top().taskID != app_id){
-
-						tempQ.push(ActiveTaskQ.top());
-						ActiveTaskQ.pop();
-
-					}
-
-					while(tempQ.size() != 0){
-
-						ActiveTaskQ.push(tempQ.top());
-						tempQ.pop();
-
-					}
-				}
-			}
+			openSystem->getTask(app_id).taskDepartureTime = time.getNS();
+			openSystem->setTaskState(app_id, TASK_COMPLETED);
 			
-		cout << "\n[Scheduler][Result]: Task " << app_id << " (Response/Service/Wait) Time (ns) "  << " :\t" <<  time.getNS() - openTasks[app_id].taskArrivalTime << "\t" <<  time.getNS() - openTasks[app_id].taskStartTime << "\t" << openTasks[app_id].taskStartTime - openTasks[app_id].taskArrivalTime << "\n";
+		cout << "\n[Scheduler][Result]: Task " << app_id << " (Response/Service/Wait) Time (ns) "  << " :\t" <<  time.getNS() - openSystem->getTask(app_id).taskArrivalTime << "\t" <<  time.getNS() - openSystem->getTask(app_id).taskStartTime << "\t" << openSystem->getTask(app_id).taskStartTime - openSystem->getTask(app_id).taskArrivalTime << "\n";
 	
 	}
 	
-	if (numberOfFreeCores () == numberOfCores && numberOfTasksWaitingToSchedule () != 0) {
+	if (openSystem->getNumberOfFreeCores () == numberOfCores && openSystem->getNumberOfTasks(TASK_WAITING_TO_SCHEDULE) != 0) {
 		cout << "\n[Scheduler]: System Going Empty ... Prefetching Tasks\n"; //Without Prefectching Sniper will Deadlock or End Prematurely.
 
-		if (numberOfTasksInQueue () != 0) {
+		if (openSystem->getNumberOfTasks(TASK_IN_QUEUE) != 0) {
 			cout << "\n[Scheduler]: Prefetching Task from Queue\n";
 			schedule (taskFrontOfQueue (), false, time);
 		}
-		else if (numberOfTasksWaitingToSchedule () != 0) {
+		else if (openSystem->getNumberOfTasks(TASK_WAITING_TO_SCHEDULE) != 0) {
 
 			SInt64 timeJump = 0;
 
 			UInt64 nextArrivalTime = 0;
-			for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-				if (openTasks[taskIterator].waitingToSchedule) {
-					if (nextArrivalTime == 0) { 
-						nextArrivalTime = openTasks[taskIterator].taskArrivalTime;
-					}
-					else if (nextArrivalTime > openTasks[taskIterator].taskArrivalTime) {
-						nextArrivalTime = openTasks[taskIterator].taskArrivalTime;
-					}
+			for (int taskIterator = openSystem->firstTask(TASK_WAITING_TO_SCHEDULE); taskIterator != -1; taskIterator = openSystem->nextTask(taskIterator)) {
+				if (nextArrivalTime == 0) { 
+					nextArrivalTime = openSystem->getTask(taskIterator).taskArrivalTime;
+				}
+				else if (nextArrivalTime > openSystem->getTask(taskIterator).taskArrivalTime) {
+					nextArrivalTime = openSystem->getTask(taskIterator).taskArrivalTime;
 				}
-
 			}
 
 			timeJump = nextArrivalTime - time.getNS();
@@ -983,14 +885,13 @@ void SchedulerOpen::threadExit(thread_id_t thread_id, SubsecondTime time) {
             }
 			cout << "\n[Scheduler]: Readjusting Arrival Time by " << timeJump << " ns \n"; // This will not effect the result of response time as arrival time of all unscheduled tasks are adjusted relatively.
 
-			for (int taskIterator = 0; taskIterator < numberOfTasks; taskIterator++) {
-				if (openTasks[taskIterator].waitingToSchedule) {
-					openTasks[taskIterator].taskArrivalTime -= timeJump;
-					cout << "\n[Scheduler]: New Arrival Time from Task " << taskIterator << " set at " << openTasks[taskIterator].taskArrivalTime << " ns" <<  "\n"; 
-				}
+			for (int taskIterator = openSystem->firstTask(TASK_WAITING_TO_SCHEDULE); taskIterator != -1; taskIterator = openSystem->nextTask(taskIterator)) {
+				openSystem->getTask(taskIterator).taskArrivalTime -= timeJump;
+				cout << "\n[Scheduler]: New Arrival Time from Task " << taskIterator << " set at " << openSystem->getTask(taskIterator).taskArrivalTime << " ns" <<  "\n"; 
 			}
 
 			fetchTasksIntoQueue (time);
+			scheduleArrivals();
 
 			schedule (taskFrontOfQueue (), false, time);
 
@@ -999,13 +900,13 @@ void SchedulerOpen::threadExit(thread_id_t thread_id, SubsecondTime time) {
 
 	}
 
-	if (numberOfTasksCompleted ()  == numberOfTasks) {
+	if (openSystem->getNumberOfTasks(TASK_COMPLETED) == numberOfTasks) {
 		
 		cout << "\n[Scheduler]: All tasks finished executing. \n";
 		UInt64 averageResponseTime = 0;
 
 		for (int taskCounter = 0; taskCounter < numberOfTasks; taskCounter++){
-			averageResponseTime += openTasks [taskCounter].taskDepartureTime - openTasks [taskCounter].taskArrivalTime;
+			averageResponseTime += openSystem->getTask(taskCounter).taskDepartureTime - openSystem->getTask(taskCounter).taskArrivalTime;
 		}
 
 
@@ -1266,7 +1167,7 @@ void SchedulerOpen::executeDVFSPolicy() {
 void SchedulerOpen::executeMigrationPolicy(SubsecondTime time) {
 	std::vector<int> taskIds;
 	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
-		taskIds.push_back(systemCores.at(coreCounter).assignedTaskID);
+		taskIds.push_back(openSystem->getCore(coreCounter).assignedTaskID);
 	}
 	std::vector<bool> activeCores;
 	for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
@@ -1276,20 +1177,20 @@ void SchedulerOpen::executeMigrationPolicy(SubsecondTime time) {
 	std::vector<migration> migrations = migrationPolicy->migrate(time, taskIds, activeCores);
 
 	for (migration &migration : migrations) {
-		if (systemCores.at(migration.fromCore).assignedTaskID == -1) {
+		if (openSystem->isCoreFree(migration.fromCore)) {
 			cout << "\n[Scheduler][Error]: Migration Policy ordered migration from unused core.\n";		
 			exit (1);
 		}
 
 		if (migration.swap) {
-			if (systemCores.at(migration.toCore).assignedTaskID == -1) {
+			if (openSystem->isCoreFree(migration.toCore)) {
 				cout << "\n[Scheduler][Error]: Migration Policy ordered swap with unused core.\n";		
 				exit (1);
 			}
-			int taskFrom = systemCores.at(migration.fromCore).assignedTaskID;
-			int threadFrom = systemCores.at(migration.fromCore).assignedThreadID;
-			int taskTo = systemCores.at(migration.toCore).assignedTaskID;
-			int threadTo = systemCores.at(migration.toCore).assignedThreadID;
+			SystemCore from = openSystem->getCore(migration.fromCore);
+			SystemCore to = openSystem->getCore(migration.toCore);
+			int threadFrom = from.assignedThreadID;
+			int threadTo = to.assignedThreadID;
 
 			if (threadFrom != -1) {
 				cout << "[Scheduler] moving thread " << threadFrom << " from core " << migration.fromCore << " to core " << migration.toCore << endl;
@@ -1305,83 +1206,166 @@ void SchedulerOpen::executeMigrationPolicy(SubsecondTime time) {
 				CPU_SET(migration.fromCore, &my_set);
 				threadSetAffinity(INVALID_THREAD_ID, threadTo, sizeof(cpu_set_t), &my_set);
 			}
-			systemCores.at(migration.toCore).assignedTaskID = taskFrom;
-			systemCores.at(migration.toCore).assignedThreadID = threadFrom;
-			systemCores.at(migration.fromCore).assignedTaskID = taskTo;
-			systemCores.at(migration.fromCore).assignedThreadID = threadTo;
+			openSystem->assignCore(migration.toCore, from);
+			openSystem->assignCore(migration.fromCore, to);
 		} else {
-			if (systemCores.at(migration.toCore).assignedTaskID != -1) {
+			if (!openSystem->isCoreFree(migration.toCore)) {
 				cout << "\n[Scheduler][Error]: Migration Policy ordered migration to already used core.\n";
 				exit (1);
 			}
-			int thread = systemCores.at(migration.fromCore).assignedThreadID;
+			int thread = openSystem->getCore(migration.fromCore).assignedThreadID;
 			if (thread != -1) {
 				migrateThread(thread, migration.toCore);
 			} else {
-				systemCores.at(migration.toCore).assignedTaskID = systemCores.at(migration.fromCore).assignedTaskID;
-				systemCores.at(migration.fromCore).assignedTaskID = -1;
+				openSystem->assignTask(migration.toCore, openSystem->getCore(migration.fromCore).assignedTaskID);
+				openSystem->assignTask(migration.fromCore, -1);
 			}
 		}
 	}
 }
 
 
-/** periodic
-    This function is called periodically by Sniper at Interval of 100ns.
-*/
-void SchedulerOpen::periodic(SubsecondTime time) {
-	if (time.getNS () % 1000000 == 0) { //Error Checking at every 1ms. Can be faster but will have overhead in simulation time.
-		cout << "\n[Scheduler]: Time " << formatTime(time) << " [Active Tasks =  " << numberOfActiveTasks () << " | Completed Tasks = " <<  numberOfTasksCompleted () << " | Queued Tasks = "  << numberOfTasksInQueue () << " | Non-Queued Tasks  = " <<  numberOfTasksWaitingToSchedule () <<  " | Free Cores = " << numberOfFreeCores () << " | Active Tasks Requirements = " << totalCoreRequirementsOfActiveTasks () << " ] \n" << endl;
+/** scheduleEvent
+ * Queue an event to be executed by the first periodic call at or after the given time (in ns).
+ */
+void SchedulerOpen::scheduleEvent(UInt64 time, EventType type, int taskID) {
+	ScheduledEvent event;
+	event.time = time;
+	event.type = type;
+	event.taskID = taskID;
+	events.push(event);
+}
+
+/** scheduleArrivals
+ * Queue an arrival event for every task that has not been fetched into the queue yet.
+ * Events of tasks whose arrival time changes afterwards are recognized as stale and dropped.
+ */
+void SchedulerOpen::scheduleArrivals() {
+	if (!arrivalScheduling) {
+		return;
+	}
+	for (int taskID = openSystem->firstTask(TASK_WAITING_TO_SCHEDULE); taskID != -1; taskID = openSystem->nextTask(taskID)) {
+		scheduleEvent(openSystem->getTask(taskID).taskArrivalTime, EVENT_ARRIVAL, taskID);
+	}
+}
+
+/** executeEvent
+ * Execute a due event and queue the next occurrence of the periodic ones.
+ * Epochs stay aligned to multiples of their length, even if the barrier quantum is not a divisor of it.
+ */
+void SchedulerOpen::executeEvent(const ScheduledEvent &event, SubsecondTime time) {
+	long epoch = 0;
+
+	switch (event.type) {
+	case EVENT_STATUS:
+		epoch = statusEpoch;
+		cout << "\n[Scheduler]: Time " << formatTime(time) << " [Active Tasks =  " << openSystem->getNumberOfTasks(TASK_ACTIVE) << " | Completed Tasks = " <<  openSystem->getNumberOfTasks(TASK_COMPLETED) << " | Queued Tasks = "  << openSystem->getNumberOfTasks(TASK_IN_QUEUE) << " | Non-Queued Tasks  = " <<  openSystem->getNumberOfTasks(TASK_WAITING_TO_SCHEDULE) <<  " | Free Cores = " << openSystem->getNumberOfFreeCores () << " | Active Tasks Requirements = " << openSystem->getTotalCoreRequirementsOfActiveTasks () << " ] \n" << endl;
 
-		// showtaskID(waitingTaskQ);
-		// showAQ(ActiveTaskQ);
 		//Following error checking code makes sure that the system state is not messed up.
 
-		if (numberOfCores - totalCoreRequirementsOfActiveTasks () != numberOfFreeCores ()) {
+		if (numberOfCores - openSystem->getTotalCoreRequirementsOfActiveTasks () != openSystem->getNumberOfFreeCores ()) {
 			cout <<"\n[Scheduler] [Error]: Number of Free Cores + Number of Active Tasks Requirements != Number Of Cores.\n";		
 			exit (1);
 		}
 
-		if (numberOfActiveTasks () + numberOfTasksCompleted () + numberOfTasksInQueue () + numberOfTasksWaitingToSchedule () != numberOfTasks) {
+		if (!openSystem->verify()) {
 			cout <<"\n[Scheduler] [Error]: Task State Does Not Match.\n";		
 			exit (1);
 		}
-	}
+		break;
+
+	case EVENT_POWER:
+		epoch = powerEpoch;
+		if (powerEstimator != NULL) {
+			executePowerModel(time);
+		}
+		break;
 
-	if ((migrationPolicy != NULL) && (time.getNS() % migrationEpoch == 0)) {
+	case EVENT_THERMAL:
+		epoch = thermalEpoch;
+		executeThermalEngine(time);
+		break;
+
+	case EVENT_MIGRATION:
+		epoch = migrationEpoch;
 		cout << "\n[Scheduler]: Migration invoked at " << formatTime(time) << endl;
 
 		executeMigrationPolicy(time);
-	}
+		break;
 
-	// TODO: extend this to a full policy
-	// executePerforationPolicy();
-
-	if ((dvfsPolicy != NULL) && (time.getNS() % dvfsEpoch == 0)) {
+	case EVENT_DVFS:
+		epoch = dvfsEpoch;
 		cout << "\n[Scheduler]: DVFS Control Loop invoked at " << formatTime(time) << endl;
-        // SP: Debug: show that rvalues are now accessible to the scheduler
-        // cout << "SP: Core 0 rvalue:" << performanceCounters->getRvalueOfCore(0) << endl;
+		// SP: Debug: show that rvalues are now accessible to the scheduler
+		// cout << "SP: Core 0 rvalue:" << performanceCounters->getRvalueOfCore(0) << endl;
 
 		executeDVFSPolicy();
+		break;
 
-		std::vector<int> frequencies;
-		for (int coreCounter = 0; coreCounter < numberOfCores; coreCounter++) {
-			frequencies.push_back(Sim()->getMagicServer()->getFrequency(coreCounter));
-		}
-	}
-
-	if (time.getNS () % mappingEpoch == 0) {
-		
+	case EVENT_MAPPING:
+		epoch = mappingEpoch;
 		cout << "\n[Scheduler]: Scheduler Invoked at " << formatTime(time) << "\n" << endl;
 
 		fetchTasksIntoQueue (time);
-				
 
+		while (	openSystem->getNumberOfTasks(TASK_IN_QUEUE) != 0) {	
+			if (!schedule (taskFrontOfQueue (), false,time)) break; //Scheduler can't map the task in front of queue.
+		}
+
+		logMapping(time);
+		break;
 
-		while (	numberOfTasksInQueue () != 0) {	
+	case EVENT_ARRIVAL:
+		{
+			const OpenTask &task = openSystem->getTask(event.taskID);
+			if (task.state != TASK_WAITING_TO_SCHEDULE || task.taskArrivalTime != event.time) {
+				break; // Already fetched by an earlier event, or the arrival time was readjusted
+			}
+		}
+		cout << "\n[Scheduler]: Task " << event.taskID << " arrived, Scheduler Invoked at " << formatTime(time) << "\n" << endl;
+
+		fetchTasksIntoQueue (time);
+
+		while (	openSystem->getNumberOfTasks(TASK_IN_QUEUE) != 0) {	
 			if (!schedule (taskFrontOfQueue (), false,time)) break; //Scheduler can't map the task in front of queue.
 		}
+		break;
+	}
+
+	if (epoch > 0) {
+		scheduleEvent((time.getNS() / epoch + 1) * epoch, event.type);
+	}
+}
+
+/** periodic
+    This function is called periodically by Sniper at Interval of 100ns (the barrier quantum).
+    Only the events that are due are executed, the time of the next one is checked in constant time.
+*/
+void SchedulerOpen::periodic(SubsecondTime time) {
+	while (!events.empty() && events.top().time <= time.getNS()) {
+		ScheduledEvent event = events.top();
+		events.pop();
+		executeEvent(event, time);
+	}
 
+	// TODO: extend this to a full policy
+	// executePerforationPolicy();
+
+	// Expire the quanta of the threads running on each core
+	SchedulerPinnedBase::periodic(time);
+}
+
+/** logMapping
+ * Write the current mapping to the mapping log selected in base.cfg: none, console (as a grid) or file (one line per epoch).
+ */
+void SchedulerOpen::logMapping(SubsecondTime time) {
+	if (mappingLog == "file") {
+		mappingLogFile << time.getNS();
+		for (int coreId = 0; coreId < numberOfCores; coreId++) {
+			mappingLogFile << "\t" << openSystem->getCore(coreId).assignedTaskID;
+		}
+		mappingLogFile << endl;
+	} else if (mappingLog == "console") {
 		cout << "[Scheduler]: Current mapping:" << endl;
 
 		for (int y = 0; y < coreRows; y++) {
@@ -1390,17 +1374,18 @@ void SchedulerOpen::periodic(SubsecondTime time) {
 					cout << " ";
 				}
 				int coreId = getCoreNb(y, x);
+				const SystemCore &core = openSystem->getCore(coreId);
 				if (!isAssignedToTask(coreId)) {
 					cout << "  . ";
 				} else {
-					if (systemCores[coreId].assignedTaskID < 10) {
+					if (core.assignedTaskID < 10) {
 						cout << " ";
 					}
 
 					char marker1 = '?';
 					char marker2 = '?';
 					if (isAssignedToThread(coreId)) {
-						Core::State state = m_thread_manager->getThreadState(systemCores[coreId].assignedThreadID);
+						Core::State state = m_thread_manager->getThreadState(core.assignedThreadID);
 						if (state == Core::State::RUNNING) {
 							marker1 = '*';
 							marker2 = '*';
@@ -1413,26 +1398,12 @@ void SchedulerOpen::periodic(SubsecondTime time) {
 						marker2 = ')';
 					}
 
-					cout << marker1 << systemCores[coreId].assignedTaskID << marker2;
+					cout << marker1 << core.assignedTaskID << marker2;
 				}
 			}
 			cout << endl;
 		}
 	}
-
-
-	SubsecondTime delta = time - m_last_periodic;
-
-	for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id) {
-		if (delta > m_quantum_left[core_id] || m_core_thread_running[core_id] == INVALID_THREAD_ID) {
-		         reschedule(time, core_id, true);
-		}
-		else {
-			m_quantum_left[core_id] -= delta;
-		}
-	}
-
-	m_last_periodic = time;
 }
 
 std::string formatLong(long l) {
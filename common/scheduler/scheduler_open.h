@@ -10,11 +10,18 @@
 #include "scheduler_pinned_base.h"
 #include "thermalComponentModel.h"
 #include "thermalModel.h"
+#include "hotspot_engine.h"
+#include "power_estimator.h"
 #include "performance_counters.h"
+#include "open_system_state.h"
 #include "policies/dvfspolicy.h"
 #include "policies/mappingpolicy.h"
 #include "policies/migrationpolicy.h"
 
+#include <fstream>
+#include <functional>
+#include <queue>
+
 
 class SchedulerOpen : public SchedulerPinnedBase {
 
@@ -25,6 +32,7 @@ class SchedulerOpen : public SchedulerPinnedBase {
 		virtual bool threadSetAffinity(thread_id_t calling_thread_id, thread_id_t thread_id, size_t cpusetsize, const cpu_set_t *mask);
 		virtual core_id_t threadCreate(thread_id_t thread_id);
 		virtual void threadExit(thread_id_t thread_id, SubsecondTime time);
+		virtual void appHeartbeat(app_id_t app_id, thread_id_t thread_id, SubsecondTime time, UInt64 tag);
 
 		
 
@@ -34,6 +42,10 @@ class SchedulerOpen : public SchedulerPinnedBase {
 		int nodesPerCore;
 
 		PerformanceCounters *performanceCounters;
+		OpenSystemState *openSystem;
+		int taskFrontOfQueue();
+		void fetchTasksIntoQueue(SubsecondTime time);
+
 		MappingPolicy *mappingPolicy = NULL;
 		long mappingEpoch;
 		void initMappingPolicy(String policyName);
@@ -55,6 +67,14 @@ class SchedulerOpen : public SchedulerPinnedBase {
 		void setFrequency(int coreCounter, int frequency);
 		ThermalComponentModel *thermalComponentModel;
 		ThermalModel *thermalModel;
+		PowerEstimator *powerEstimator = NULL;
+		long powerEpoch;
+		void initPowerModel();
+		void executePowerModel(SubsecondTime time);
+		HotSpotEngine *hotspotEngine = NULL;
+		long thermalEpoch;
+		void initThermalEngine();
+		void executeThermalEngine(SubsecondTime time);
 		int minFrequency;
 		int maxFrequency;
 		int frequencyStepSize;
@@ -68,6 +88,27 @@ class SchedulerOpen : public SchedulerPinnedBase {
 		void executeMigrationPolicy(SubsecondTime time);
 		void migrateThread(thread_id_t thread_id, core_id_t core_id);
 
+		String mappingLog;
+		std::ofstream mappingLogFile;
+		void logMapping(SubsecondTime time);
+
+		// Epochs and task arrivals, executed by the first periodic call at or after their time
+		enum EventType { EVENT_STATUS, EVENT_POWER, EVENT_THERMAL, EVENT_MIGRATION, EVENT_DVFS, EVENT_MAPPING, EVENT_ARRIVAL };
+		struct ScheduledEvent {
+			UInt64 time; // in ns
+			EventType type; // events due at the same time are executed in this order
+			int taskID; // only for EVENT_ARRIVAL
+			bool operator>(const ScheduledEvent &other) const {
+				return time != other.time ? time > other.time : type > other.type;
+			}
+		};
+		std::priority_queue<ScheduledEvent, std::vector<ScheduledEvent>, std::greater<ScheduledEvent> > events;
+		bool arrivalScheduling;
+		const long statusEpoch = 1000000; //Error Checking at every 1ms. Can be faster but will have overhead in simulation time.
+		void scheduleEvent(UInt64 time, EventType type, int taskID = -1);
+		void scheduleArrivals();
+		void executeEvent(const ScheduledEvent &event, SubsecondTime time);
+
 		std::string formatTime(SubsecondTime time);
 
 		core_id_t getNextCore(core_id_t core_first);
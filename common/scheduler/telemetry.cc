@@ -0,0 +1,244 @@
+#include "telemetry.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/stat.h>
+
+using namespace std;
+
+// indexOfName entry of a component that appears more than once
+static const int DUPLICATE_COMPONENT = -2;
+
+static vector<string> splitTabs(const string &line) {
+    vector<string> tokens;
+    istringstream iss(line);
+    string token;
+    while (getline(iss, token, '\t')) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+bool LogStamp::update(const string &filename) {
+    struct stat st;
+    long long newMtime = 0;
+    long long newSize = 0;
+    if (stat(filename.c_str(), &st) == 0) {
+        newMtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        newSize = st.st_size;
+    }
+    if ((newMtime == mtime) && (newSize == size)) {
+        return false;
+    }
+    mtime = newMtime;
+    size = newSize;
+    return true;
+}
+
+ComponentTelemetry::ComponentTelemetry(const string &logFilename)
+    : logFilename(logFilename), published(false) {
+}
+
+/** publish
+ * Replace all values. The index is only rebuilt if the components changed.
+ */
+void ComponentTelemetry::publish(const vector<string> &names, const vector<double> &newValues) {
+    published = true;
+    if (names != publishedNames) {
+        publishedNames = names;
+        setNames(names);
+    }
+    values = newValues;
+}
+
+void ComponentTelemetry::setNames(const vector<string> &names) const {
+    indexOfName.clear();
+    indicesOfCore.clear();
+    values.assign(names.size(), 0);
+    for (unsigned int i = 0; i < names.size(); i++) {
+        bool duplicate = indexOfName.count(names[i]) != 0;
+        indexOfName[names[i]] = duplicate ? DUPLICATE_COMPONENT : i;
+        if (names[i].find("C_") == 0) {
+            int coreId = atoi(names[i].c_str() + 2);
+            if ((int)indicesOfCore.size() <= coreId) {
+                indicesOfCore.resize(coreId + 1);
+            }
+            indicesOfCore[coreId].push_back(i);
+        }
+    }
+}
+
+/** load
+ * Parse the log file (header and one line of values) if a new one was written since the last access.
+ */
+void ComponentTelemetry::load() const {
+    if (published || !stamp.update(logFilename)) {
+        return;
+    }
+
+    ifstream logFile(logFilename);
+    string newHeader;
+    string footer;
+    if (logFile.good()) {
+        getline(logFile, newHeader);
+        getline(logFile, footer);
+    }
+
+    if (newHeader != header) {
+        header = newHeader;
+        setNames(splitTabs(header));
+    }
+    vector<string> tokens = splitTabs(footer);
+    std::fill(values.begin(), values.end(), 0);
+    for (unsigned int i = 0; (i < tokens.size()) && (i < values.size()); i++) {
+        values[i] = stod(tokens[i]);
+    }
+}
+
+int ComponentTelemetry::getIndex(const string &name) const {
+    load();
+    unordered_map<string, int>::const_iterator it = indexOfName.find(name);
+    if ((it != indexOfName.end()) && (it->second == DUPLICATE_COMPONENT)) {
+        throw std::runtime_error{"ERROR: Duplicate components found in " + logFilename};
+    }
+    return (it == indexOfName.end()) ? -1 : it->second;
+}
+
+const vector<int>& ComponentTelemetry::getIndicesOfCore(int coreId) const {
+    static const vector<int> none;
+    load();
+    if ((coreId < 0) || (coreId >= (int)indicesOfCore.size())) {
+        return none;
+    }
+    return indicesOfCore[coreId];
+}
+
+CoreMetricTelemetry::CoreMetricTelemetry(const string &logFilename)
+    : logFilename(logFilename) {
+}
+
+/** load
+ * Parse the CPI stack log: a header with the cores, then one line per metric ('-' if insignificant on all cores).
+ */
+void CoreMetricTelemetry::load() const {
+    if (!stamp.update(logFilename)) {
+        return;
+    }
+    indexOfMetric.clear();
+    values.clear();
+
+    ifstream logFile(logFilename);
+    string line;
+    if (!logFile.good() || !getline(logFile, line)) {
+        return;
+    }
+    int numberOfCores = splitTabs(line).size() - 1;
+
+    while (getline(logFile, line)) {
+        vector<string> tokens = splitTabs(line);
+        if (tokens.empty()) {
+            continue;
+        }
+        vector<double> metricValues(numberOfCores, 0);
+        if ((tokens.size() < 2) || (tokens[1] != "-")) {
+            for (int core = 0; (core < numberOfCores) && (core + 1 < (int)tokens.size()); core++) {
+                metricValues[core] = stod(tokens[core + 1]);
+            }
+        }
+        indexOfMetric[tokens[0]] = values.size();
+        values.push_back(metricValues);
+    }
+}
+
+double CoreMetricTelemetry::getValue(const string &metric, int coreId) const {
+    load();
+    unordered_map<string, int>::const_iterator it = indexOfMetric.find(metric);
+    if ((it == indexOfMetric.end()) || (coreId < 0) || (coreId >= (int)values[it->second].size())) {
+        return -1;
+    }
+    return values[it->second][coreId];
+}
+
+HeartbeatTelemetry::HeartbeatTelemetry(unsigned int windowSize)
+    : windowSize(windowSize) {
+}
+
+void HeartbeatTelemetry::beat(int appId, long timestamp, long tag) {
+    if (appId < 0) {
+        return;
+    }
+    if ((int)hearts.size() <= appId) {
+        hearts.resize(appId + 1);
+    }
+    Heart &heart = hearts[appId];
+    if (heart.beats.empty()) {
+        heart.beats.resize(windowSize + 1);
+        heart.count = 0;
+        heart.firstTimestamp = timestamp;
+    }
+    Beat &newest = heart.beats[heart.count % heart.beats.size()];
+    newest.timestamp = timestamp;
+    newest.tag = tag;
+    heart.count++;
+}
+
+const HeartbeatTelemetry::Heart* HeartbeatTelemetry::getHeart(int appId) const {
+    if ((appId < 0) || (appId >= (int)hearts.size()) || (hearts[appId].beats.empty())) {
+        return NULL;
+    }
+    return &hearts[appId];
+}
+
+/** getBeat
+ * Beat with the given age (0 is the newest). The age must be below min(count, windowSize + 1).
+ */
+const HeartbeatTelemetry::Beat& HeartbeatTelemetry::getBeat(const Heart &heart, long age) const {
+    return heart.beats[(heart.count - 1 - age) % heart.beats.size()];
+}
+
+double HeartbeatTelemetry::rate(long beats, long duration) {
+    return (duration > 0) ? 1e9 * beats / duration : 0;
+}
+
+long HeartbeatTelemetry::getNumberOfBeats(int appId) const {
+    const Heart *heart = getHeart(appId);
+    return heart ? heart->count : 0;
+}
+
+long HeartbeatTelemetry::getLastBeat(int appId) const {
+    const Heart *heart = getHeart(appId);
+    return heart ? getBeat(*heart, 0).timestamp : 0;
+}
+
+long HeartbeatTelemetry::getLastTag(int appId) const {
+    const Heart *heart = getHeart(appId);
+    return heart ? getBeat(*heart, 0).tag : 0;
+}
+
+double HeartbeatTelemetry::getWindowRate(int appId) const {
+    const Heart *heart = getHeart(appId);
+    if (!heart || (heart->count < 2)) {
+        return 0;
+    }
+    long intervals = std::min(heart->count - 1, (long)windowSize);
+    return rate(intervals, getBeat(*heart, 0).timestamp - getBeat(*heart, intervals).timestamp);
+}
+
+double HeartbeatTelemetry::getGlobalRate(int appId) const {
+    const Heart *heart = getHeart(appId);
+    if (!heart || (heart->count < 2)) {
+        return 0;
+    }
+    return rate(heart->count - 1, getBeat(*heart, 0).timestamp - heart->firstTimestamp);
+}
+
+double HeartbeatTelemetry::getInstantRate(int appId) const {
+    const Heart *heart = getHeart(appId);
+    if (!heart || (heart->count < 2)) {
+        return 0;
+    }
+    return rate(1, getBeat(*heart, 0).timestamp - getBeat(*heart, 1).timestamp);
+}
@@ -0,0 +1,119 @@
+/**
+ * telemetry
+ * This header implements the in-memory telemetry store read by PerformanceCounters.
+ * In-process producers (native power model, internal thermal engine) publish their values every epoch.
+ * External producers (tools/mcpat.py, hotspot, reliability) still write Instantaneous*.log files; these are only parsed again
+ * once their modification time or size changed, whenever the producers happen to run.
+ * Application heartbeats arrive through the SIM_CMD_HEARTBEAT magic instruction.
+ */
+
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/** LogStamp
+ * Modification time and size of a log file, to tell whether it was written since it was last parsed.
+ */
+struct LogStamp {
+    LogStamp() : mtime(-1), size(-1) {}
+    // true if the file changed (or appeared or disappeared) since the last call
+    bool update(const std::string &filename);
+
+    long long mtime; // in ns
+    long long size;
+};
+
+/** ComponentTelemetry
+ * One value per component (e.g. C_0_FPU, L3), with the components grouped per core.
+ */
+class ComponentTelemetry {
+public:
+    ComponentTelemetry(const std::string &logFilename);
+
+    // in-process producer: from now on the log file is ignored
+    void publish(const std::vector<std::string> &names, const std::vector<double> &values);
+
+    // index of the component, or -1 if it is not tracked; throws if the component appears more than once
+    int getIndex(const std::string &name) const;
+    // value of the component, for an index returned by the last getIndex or getIndicesOfCore
+    double getValue(int index) const { return values.at(index); }
+    // indices of the components of the given core (C_<coreId>_*)
+    const std::vector<int>& getIndicesOfCore(int coreId) const;
+    int getNumberOfCores() const { load(); return indicesOfCore.size(); }
+
+private:
+    std::string logFilename;
+    bool published;
+    std::vector<std::string> publishedNames;
+    mutable LogStamp stamp;
+
+    mutable std::string header; // header line of the last parsed log: the index is only rebuilt if it changes
+    mutable std::unordered_map<std::string, int> indexOfName;
+    mutable std::vector<std::vector<int>> indicesOfCore;
+    mutable std::vector<double> values;
+
+    void load() const;
+    void setNames(const std::vector<std::string> &names) const;
+};
+
+/** CoreMetricTelemetry
+ * One value per metric and core (the CPI stack).
+ */
+class CoreMetricTelemetry {
+public:
+    CoreMetricTelemetry(const std::string &logFilename);
+
+    // value of the metric for the given core (0 if the metric is insignificant on all cores), or -1 if it is not tracked
+    double getValue(const std::string &metric, int coreId) const;
+
+private:
+    std::string logFilename;
+    mutable LogStamp stamp;
+
+    mutable std::unordered_map<std::string, int> indexOfMetric;
+    mutable std::vector<std::vector<double>> values; // [metric][core]
+
+    void load() const;
+};
+
+/** HeartbeatTelemetry
+ * The most recent heartbeats of every application, kept in a ring buffer so that all rates are O(1) queries.
+ */
+class HeartbeatTelemetry {
+public:
+    HeartbeatTelemetry(unsigned int windowSize);
+
+    void beat(int appId, long timestamp, long tag);
+
+    long getNumberOfBeats(int appId) const;
+    // timestamp (in ns) of the last heartbeat, or 0 if the application did not beat yet
+    long getLastBeat(int appId) const;
+    long getLastTag(int appId) const;
+    // heart rates (in beats per second) over the last windowSize beats, since the first beat, and between the last two beats
+    double getWindowRate(int appId) const;
+    double getGlobalRate(int appId) const;
+    double getInstantRate(int appId) const;
+
+private:
+    struct Beat {
+        long timestamp; // in ns
+        long tag;
+    };
+    struct Heart {
+        std::vector<Beat> beats; // ring buffer of the last windowSize + 1 beats
+        long count;
+        long firstTimestamp;
+    };
+
+    unsigned int windowSize;
+    std::vector<Heart> hearts; // per application
+
+    const Heart* getHeart(int appId) const;
+    const Beat& getBeat(const Heart &heart, long age) const;
+    static double rate(long beats, long duration);
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "thermalComponentModel.h"
+#include "thermalSolver.h"
 #include <algorithm>
 #include <sstream>
 
@@ -41,6 +42,26 @@ ThermalComponentModel::ThermalComponentModel(unsigned int coreRows, unsigned int
     
     readDoubleMatrix(f, &BInv, numberThermalNodes, numberThermalNodes);
     readDoubleVector(f, &G, numberofAmbientNodes);
+
+    // influence of core i on core c, summed over the nodesPerCore x nodesPerCore block starting at BInv[c][i]
+    unsigned int numberOfCores = coreRows * coreColumns;
+    std::vector<double> rowBlockSums((numberOfCores + nodesPerCore - 1) * numberOfCores, 0);
+    for (unsigned int r = 0; r < numberOfCores + nodesPerCore - 1; r++) {
+        for (unsigned int i = 0; i < numberOfCores; i++) {
+            for (unsigned int k = 0; k < nodesPerCore; k++) {
+                rowBlockSums[r * numberOfCores + i] += BInv[r * numberOfThermalNodes + i + k];
+            }
+        }
+    }
+    std::vector<double> blockSums(numberOfCores * numberOfCores, 0);
+    for (unsigned int c = 0; c < numberOfCores; c++) {
+        for (unsigned int j = 0; j < nodesPerCore; j++) {
+            for (unsigned int i = 0; i < numberOfCores; i++) {
+                blockSums[c * numberOfCores + i] += rowBlockSums[(c + j) * numberOfCores + i];
+            }
+        }
+    }
+    headroom = new ThermalHeadroom(numberOfCores, numberOfCores, blockSums.data(), numberOfCores, BInv, numberOfThermalNodes);
     readComponentSizes(std::string(FloorplanFilename.c_str()), areas, numberUnits);
     readInactivePowers(std::string(InactivePowerFilename.c_str()), inactivePowers, numberOfCoreNodes);
 
@@ -71,13 +92,13 @@ std::string ThermalComponentModel::readLine(std::ifstream &file) const {
     return value;
 }
 
-void ThermalComponentModel::readDoubleMatrix(std::ifstream &file, double ***matrix, unsigned int rows, unsigned int columns) const {
-    (*matrix) = new double*[rows];
-    for (unsigned int r = 0; r < rows; r++) {
-        (*matrix)[r] = new double[columns];
-        for (unsigned int c = 0; c < columns; c++) {
-            (*matrix)[r][c] = readValue<double>(file);
-        }
+void ThermalComponentModel::readDoubleMatrix(std::ifstream &file, double **matrix, unsigned int rows, unsigned int columns) const {
+    (*matrix) = allocateAlignedMatrix(rows, columns);
+    file.read((char*)(*matrix), (std::streamsize)rows * columns * sizeof(double));
+    if(file.rdstate() != std::stringstream::goodbit){
+        std::cout << "Assertion error in thermal model file: file ended too early." << std::endl;
+        file.close();
+        exit(1);
     }
 }
 
@@ -284,6 +305,7 @@ std::vector<double> ThermalComponentModel::tsps(const std::vector<bool> &activeC
     int N = numberOfThermalNodes;
 
     for (unsigned int i = 0; i < L; i++) {
+        const double *BInvRow = &BInv[i * numberOfThermalNodes];
         double heatContributionInactiveCores = 0;
         double heatContributionActiveCores = 0;
 
@@ -297,9 +319,9 @@ std::vector<double> ThermalComponentModel::tsps(const std::vector<bool> &activeC
         // Compute the heat contributed by the inactive cores and the active cores
         for(unsigned int j = 0; j < M; j++){
             if (activeComponents.at(j)) {
-                heatContributionActiveCores += BInv[i][j+numberOfNonCoreNodes];
+                heatContributionActiveCores += BInvRow[j+numberOfNonCoreNodes];
             } else {
-                heatContributionInactiveCores += inactivePowers[j] * (BInv[i][j+numberOfNonCoreNodes]);
+                heatContributionInactiveCores += inactivePowers[j] * (BInvRow[j+numberOfNonCoreNodes]);
             }
         }
 
@@ -309,9 +331,9 @@ std::vector<double> ThermalComponentModel::tsps(const std::vector<bool> &activeC
         for(unsigned int j = 0; j < numberOfThermalNodes; j++){
             int g_offset = numberOfThermalNodes - numberofAmbientNodes;
             if (j < g_offset) {
-                heatBlocksAndAmbient += BInv[i][j] * Pblocks[j];
+                heatBlocksAndAmbient += BInvRow[j] * Pblocks[j];
             } else {
-                heatBlocksAndAmbient += BInv[i][j] * ( Pblocks[j] + ambientTemperature * G[j - g_offset] );
+                heatBlocksAndAmbient += BInvRow[j] * ( Pblocks[j] + ambientTemperature * G[j - g_offset] );
             }
         }
 
@@ -367,114 +389,81 @@ std::vector<double> ThermalComponentModel::tspForManyCandidates(const std::vecto
 		exit (1);
     }
 
-    int amtActiveCores = count(activeCores.begin(), activeCores.end(), true) + 1; // start at one
-
-    double idlePower = (coreRows * coreColumns - amtActiveCores) * inactivePower;
-    double tdpConstraint = (tdp - idlePower) / amtActiveCores;
-    std::vector<double> tsps(candidates.size(), tdpConstraint);
-
-    if (amtActiveCores > 0) {
-        for (unsigned int core = 0; core < activeCores.size(); core++) {
-            double activeSum = 0;
-            double inactiveSum = 0;
-            for (unsigned int i = 0; i < activeCores.size(); i++) {
-                if (activeCores.at(i)) {
-                    for (int j = 0; j < this->nodesPerCore; j++) {
-                        for (int k = 0; k < this->nodesPerCore; k++) {
-                            activeSum += BInv[core + j][i + k];
-                        }
-                    }
-                } else {
-                    for (int j = 0; j < this->nodesPerCore; j++) {
-                        for (int k = 0; k < this->nodesPerCore; k++) {
-                            inactiveSum += BInv[core + j][i + k];
-                        }
-                    }
-                }
-            }
-
-            for (unsigned int candidateIdx = 0; candidateIdx < candidates.size(); candidateIdx++) {
-                int candidate = candidates.at(candidateIdx);
-                double candActiveSum = activeSum + BInv[core][candidate];
-                double candInactiveSum = inactiveSum - BInv[core][candidate];
-                double coreSafePower = (maxTemperature - ambientTemperature - inactivePower * candInactiveSum) / candActiveSum;
-                tsps.at(candidateIdx) = std::min(tsps.at(candidateIdx), coreSafePower);
-            }
-        }
-    }
-
+    std::vector<double> tsps;
+    tspForManyCandidates(activeCores, count(activeCores.begin(), activeCores.end(), true), candidates, *headroom, tsps);
     return tsps;
 }
 
-void ThermalComponentModel::inplaceGauss(std::vector<std::vector<float>> &A, std::vector<float> &b) const {
-    unsigned int n = b.size();
-    for (unsigned int row = 0; row < n; row++) {
-        // divide
-        float pivot = A.at(row).at(row);
-        b.at(row) /= pivot;
-        for (unsigned int col = 0; col < n; col++) {
-            A.at(row).at(col) /= pivot;
-        }
+void ThermalComponentModel::tspForManyCandidates(const std::vector<bool> &activeCores, int amtActiveCores, const std::vector<int> &candidates, ThermalHeadroom &privateHeadroom, std::vector<double> &tsps) const {
+    amtActiveCores += 1; // start at one
 
-        // add
-        for (unsigned int row2 = 0; row2 < n; row2++) {
-            if (row != row2) {
-                float factor = A.at(row2).at(row);
-                b.at(row2) -= factor * b.at(row);
-                for (unsigned int col = 0; col < n; col++) {
-                    A.at(row2).at(col) -= factor * A.at(row).at(col);
-                }
-            }
-        }
-    }
+    double idlePower = (coreRows * coreColumns - amtActiveCores) * inactivePower;
+    double tdpConstraint = (tdp - idlePower) / amtActiveCores;
+    tsps.assign(candidates.size(), tdpConstraint);
+
+    privateHeadroom.update(activeCores);
+    privateHeadroom.minSafePowerOfCandidates(maxTemperature - ambientTemperature, inactivePower, candidates, tsps);
 }
 
 /** powerBudgetMaxSteadyState
  * Return a per-core power budget that (if matched by the power consumption) heats every core exactly to the critical temperature.
  */
 std::vector<double> ThermalComponentModel::powerBudgetMaxSteadyState(const std::vector<bool> &activeCores) const {
+    // the budget only depends on the active cores: reuse it while the same cores stay active
+    std::unordered_map<std::vector<bool>, std::vector<double>>::const_iterator cached = powerBudgets.find(activeCores);
+    if (cached != powerBudgets.end()) {
+        return cached->second;
+    }
+
     std::vector<int> activeIndices;
-    std::vector<double> inactivePowers(coreRows * coreColumns, 0);
     for (unsigned int i = 0; i < coreRows * coreColumns; i++) {
         if (activeCores.at(i)) {
             activeIndices.push_back(i);
-        } else {
-            inactivePowers.at(i) = inactivePower;
         }
     }
-    std::vector<float> tInactive = getSteadyState(inactivePowers);
-    std::vector<float> headroomTrunc(activeIndices.size());
-    for (unsigned int i = 0; i < activeIndices.size(); i++) {
-        int index = activeIndices.at(i);
-        headroomTrunc.at(i) = maxTemperature - tInactive.at(index);
-    }
 
-    std::vector<float> powersTrunc = headroomTrunc;
-    std::vector<std::vector<float>> BInvTrunc;
+    // headroom of every active core above its steady-state temperature with only the inactive cores heating
+    std::vector<double> headroomTrunc(activeIndices.size());
+    std::vector<double> BInvTrunc(activeIndices.size() * activeIndices.size());
     for (unsigned int i = 0; i < activeIndices.size(); i++) {
-        std::vector<float> row;
+        const double *BInvRow = &BInv[activeIndices.at(i) * numberOfThermalNodes];
+        headroomTrunc.at(i) = maxTemperature - ambientTemperature;
+        for (unsigned int j = 0; j < coreRows * coreColumns; j++) {
+            if (!activeCores.at(j)) {
+                headroomTrunc.at(i) -= inactivePower * BInvRow[j];
+            }
+        }
         for (unsigned int j = 0; j < activeIndices.size(); j++) {
-            row.push_back(BInv[activeIndices.at(i)][activeIndices.at(j)]);
+            BInvTrunc.at(i * activeIndices.size() + j) = BInvRow[activeIndices.at(j)];
         }
-        BInvTrunc.push_back(row);
     }
     // now solve BInvTrunc * powersTrunc = headroomTrunc
-    inplaceGauss(BInvTrunc, powersTrunc);
+    LUFactorization factorization(BInvTrunc, activeIndices.size());
+    if (factorization.isSingular()) {
+        std::cout << "\n[Scheduler][TSP][Error]: Singular thermal model for the active cores." << std::endl;
+        exit (1);
+    }
+    std::vector<double> powersTrunc = factorization.solve(headroomTrunc);
 
     std::vector<double> powers(coreRows * coreColumns, inactivePower);
     for (unsigned int i = 0; i < activeIndices.size(); i++) {
         powers.at(activeIndices.at(i)) = powersTrunc.at(i);
     }
 
+    if (powerBudgets.size() >= 64) {
+        powerBudgets.clear();
+    }
+    powerBudgets[activeCores] = powers;
     return powers;
 }
 
 std::vector<float> ThermalComponentModel::getSteadyState(const std::vector<double> &powers) const {
     std::vector<float> temperatures(coreRows * coreColumns);
     for (unsigned int core = 0; core < (unsigned int)(coreRows * coreColumns); core++) {
+        const double *BInvRow = &BInv[core * numberOfThermalNodes];
         temperatures.at(core) = ambientTemperature;
         for (unsigned int i = 0; i < (unsigned int)(coreRows * coreColumns); i++) {
-            temperatures.at(core) += powers.at(i) * BInv[core][i];
+            temperatures.at(core) += powers.at(i) * BInvRow[i];
         }
     }
     return temperatures;
@@ -5,8 +5,10 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 #include "fixed_types.h"
 #include "performance_counters.h"
+#include "thermalHeadroom.h"
 
 class ThermalComponentModel {
 public:
@@ -15,9 +17,11 @@ public:
     std::vector<double> tsps(const std::vector<bool> &activeCores) const;
     double tsp(const std::vector<bool> &activeCores) const;
     std::vector<double> tspForManyCandidates(const std::vector<bool> &activeCores, const std::vector<int> &candidates) const;
+    // thread-safe variant: uses a private headroom (from createHeadroom) and fills tsps, reusing its storage
+    void tspForManyCandidates(const std::vector<bool> &activeCores, int amtActiveCores, const std::vector<int> &candidates, ThermalHeadroom &privateHeadroom, std::vector<double> &tsps) const;
+    ThermalHeadroom* createHeadroom() const { return new ThermalHeadroom(*headroom); }
     std::vector<double> powerBudgetMaxSteadyState(const std::vector<bool> &activeCores) const;
     std::vector<float> getSteadyState(const std::vector<double> &powers) const;
-    void inplaceGauss(std::vector<std::vector<float>> &A, std::vector<float> &b) const;
     float getInactivePower() const { return inactivePower; }
 
 private:
@@ -28,7 +32,7 @@ private:
     double inactivePower;
     template<typename T> T readValue(std::ifstream &file) const;
     std::string readLine(std::ifstream &file) const;
-    void readDoubleMatrix(std::ifstream &file, double ***matrix, unsigned int rows, unsigned int columns) const;
+    void readDoubleMatrix(std::ifstream &file, double **matrix, unsigned int rows, unsigned int columns) const;
     void readDoubleVector(std::ifstream &file, double **vector, unsigned int size) const;
     bool readComponentSizes(const std::string &floorplanFilename, double * &areas, int size) const;
     bool readInactivePowers(const std::string &inactivePowerFilename, double * &pwoers, unsigned int &node_count) const;
@@ -43,7 +47,9 @@ private:
     unsigned int numberOfCoreNodes;
     unsigned int numberOfNonCoreNodes;
 
-    double **BInv;
+    double *BInv; // row-major numberOfThermalNodes x numberOfThermalNodes
+    mutable std::unordered_map<std::vector<bool>, std::vector<double>> powerBudgets; // powerBudgetMaxSteadyState per active-core bitmask
+    mutable ThermalHeadroom *headroom; // cached sums of the per-core blocks of BInv, over the active and inactive cores
     double *G;
     double *areas;
     double *inactivePowers;
@@ -0,0 +1,67 @@
+#include "thermalHeadroom.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+double* allocateAlignedMatrix(unsigned int rows, unsigned int columns) {
+    double *matrix;
+    if (posix_memalign((void**)&matrix, 64, std::max((size_t)rows * columns, (size_t)1) * sizeof(double)) != 0) {
+        std::cout << "\n[Scheduler][TSP][Error]: Could not allocate a " << rows << "x" << columns << " matrix." << std::endl;
+        exit (1);
+    }
+    return matrix;
+}
+
+ThermalHeadroom::ThermalHeadroom(unsigned int numberOfRows, unsigned int numberOfCores, const double *sumMatrix, unsigned int sumStride, const double *candidateMatrix, unsigned int candidateStride)
+    : numberOfRows(numberOfRows), numberOfCores(numberOfCores),
+      activeSums(numberOfRows, 0), inactiveSums(numberOfRows, 0), activeCores(numberOfCores, false) {
+    sumColumns = allocateAlignedMatrix(numberOfCores, numberOfRows);
+    candidateColumns = allocateAlignedMatrix(numberOfCores, numberOfRows);
+    for (unsigned int row = 0; row < numberOfRows; row++) {
+        for (unsigned int core = 0; core < numberOfCores; core++) {
+            sumColumns[core * numberOfRows + row] = sumMatrix[row * sumStride + core];
+            candidateColumns[core * numberOfRows + row] = candidateMatrix[row * candidateStride + core];
+            inactiveSums[row] += sumMatrix[row * sumStride + core]; // all cores start inactive
+        }
+    }
+}
+
+/** toggle
+ * Move the contribution of a core between the active and the inactive sums of every row.
+ */
+void ThermalHeadroom::toggle(unsigned int core) {
+    const double *column = &sumColumns[core * numberOfRows];
+    double sign = activeCores[core] ? -1 : 1;
+    activeCores[core] = !activeCores[core];
+    for (unsigned int row = 0; row < numberOfRows; row++) {
+        activeSums[row] += sign * column[row];
+        inactiveSums[row] -= sign * column[row];
+    }
+}
+
+void ThermalHeadroom::update(const std::vector<bool> &newActiveCores) {
+    for (unsigned int core = 0; core < numberOfCores; core++) {
+        if (newActiveCores.at(core) != activeCores[core]) {
+            toggle(core);
+        }
+    }
+}
+
+void ThermalHeadroom::minSafePowerOfCandidates(double headroom, double inactivePower, const std::vector<int> &candidates, std::vector<double> &tsps) const {
+    const double *activeSum = activeSums.data();
+    const double *inactiveSum = inactiveSums.data();
+    std::vector<double> safePowers(numberOfRows);
+    for (unsigned int candidateIdx = 0; candidateIdx < candidates.size(); candidateIdx++) {
+        const double *column = &candidateColumns[candidates.at(candidateIdx) * numberOfRows];
+        // independent per row, so the compiler can vectorize this sweep over contiguous memory
+        for (unsigned int row = 0; row < numberOfRows; row++) {
+            safePowers[row] = (headroom - inactivePower * (inactiveSum[row] - column[row])) / (activeSum[row] + column[row]);
+        }
+        double minSafePower = tsps.at(candidateIdx);
+        for (unsigned int row = 0; row < numberOfRows; row++) {
+            minSafePower = std::min(minSafePower, safePowers[row]);
+        }
+        tsps.at(candidateIdx) = minSafePower;
+    }
+}
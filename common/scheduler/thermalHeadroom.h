@@ -0,0 +1,49 @@
+/**
+ * thermalHeadroom
+ * This header implements the incremental TSP engine shared by ThermalModel and ThermalComponentModel.
+ * The sums of the thermal influence of the active and of the inactive cores are cached per row and are
+ * updated in O(n) whenever a core toggles, instead of rescanning the full matrix on every TSP query.
+ */
+
+#ifndef __THERMAL_HEADROOM_H
+#define __THERMAL_HEADROOM_H
+
+#include <cstddef>
+#include <vector>
+
+/** allocateAlignedMatrix
+ * Allocate a contiguous, cache line aligned, row-major rows x columns matrix (never freed: the thermal models live as long as the scheduler).
+ */
+double* allocateAlignedMatrix(unsigned int rows, unsigned int columns);
+
+// Copies share the read-only matrices but keep their own sums, so every thread can query its own copy.
+class ThermalHeadroom {
+public:
+    // sumMatrix: row-major, with a row stride of sumStride, the influence of core i on row r that is summed over the active (inactive) cores
+    // candidateMatrix: row-major, with a row stride of candidateStride, the influence of a newly activated core on row r
+    ThermalHeadroom(unsigned int numberOfRows, unsigned int numberOfCores, const double *sumMatrix, unsigned int sumStride, const double *candidateMatrix, unsigned int candidateStride);
+
+    // bring the cached sums up to date with the given active cores, toggling only the cores that changed
+    void update(const std::vector<bool> &activeCores);
+
+    double getActiveSum(unsigned int row) const { return activeSums[row]; }
+    double getInactiveSum(unsigned int row) const { return inactiveSums[row]; }
+
+    // tsps[c] = min(tsps[c], min over rows of the safe power if candidates[c] is activated in addition to the active cores)
+    void minSafePowerOfCandidates(double headroom, double inactivePower, const std::vector<int> &candidates, std::vector<double> &tsps) const;
+
+private:
+    unsigned int numberOfRows;
+    unsigned int numberOfCores;
+
+    double *sumColumns;       // transposed sumMatrix: the influence of a core on all rows is contiguous
+    double *candidateColumns; // transposed candidateMatrix
+
+    std::vector<double> activeSums;
+    std::vector<double> inactiveSums;
+    std::vector<bool> activeCores;
+
+    void toggle(unsigned int core);
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "thermalModel.h"
+#include "thermalSolver.h"
 #include <algorithm>
 #include <sstream>
 
@@ -12,7 +13,7 @@ ThermalModel::ThermalModel(unsigned int coreRows, unsigned int coreColumns, cons
 
     unsigned int numberUnits = readValue<unsigned int>(f);
     unsigned int numberNodesAmbient = readValue<unsigned int>(f);
-    unsigned int numberThermalNodes = readValue<unsigned int>(f);
+    numberThermalNodes = readValue<unsigned int>(f);
 
     if (numberUnits != coreRows * coreColumns) {
         std::cout << "Assertion error in thermal model file: numberUnits != coreRows * coreColumns" << std::endl;
@@ -34,6 +35,7 @@ ThermalModel::ThermalModel(unsigned int coreRows, unsigned int coreColumns, cons
     }
 
     readDoubleMatrix(f, &BInv, numberThermalNodes, numberThermalNodes);
+    headroom = new ThermalHeadroom(numberUnits, numberUnits, BInv, numberThermalNodes, BInv, numberThermalNodes);
 
     // remaining file is not read
     f.close();
@@ -62,20 +64,36 @@ std::string ThermalModel::readLine(std::ifstream &file) const {
     return value;
 }
 
-void ThermalModel::readDoubleMatrix(std::ifstream &file, double ***matrix, unsigned int rows, unsigned int columns) const {
-    (*matrix) = new double*[rows];
-    for (unsigned int r = 0; r < rows; r++) {
-        (*matrix)[r] = new double[columns];
-        for (unsigned int c = 0; c < columns; c++) {
-            (*matrix)[r][c] = readValue<double>(file);
-        }
+void ThermalModel::readDoubleMatrix(std::ifstream &file, double **matrix, unsigned int rows, unsigned int columns) const {
+    (*matrix) = allocateAlignedMatrix(rows, columns);
+    file.read((char*)(*matrix), (std::streamsize)rows * columns * sizeof(double));
+    if(file.rdstate() != std::stringstream::goodbit){
+        std::cout << "Assertion error in thermal model file: file ended too early." << std::endl;
+        file.close();
+        exit(1);
     }
 }
 
 double ThermalModel::tsp(const std::vector<bool> &activeCores) const {
-    std::vector<double> powerOfInactiveCores(activeCores.size(), inactivePower);
+    if (activeCores.size() != coreRows * coreColumns) {
+        std::cout << "\n[Scheduler][TSP][Error]: Invalid system size: " << activeCores.size() << ", expected " << (coreRows * coreColumns) << "cores." << std::endl;
+		exit (1);
+    }
+
+    int amtActiveCores = count(activeCores.begin(), activeCores.end(), true);
+    double idlePower = (activeCores.size() - amtActiveCores) * inactivePower;
+    double minTSP = (tdp - idlePower) / amtActiveCores; // TDP constraint
+
+    if (amtActiveCores > 0) {
+        // all inactive cores consume inactivePower: use the cached sums instead of rescanning BInv
+        headroom->update(activeCores);
+        for (unsigned int core = 0; core < activeCores.size(); core++) {
+            double coreSafePower = (maxTemperature - ambientTemperature - inactivePower * headroom->getInactiveSum(core)) / headroom->getActiveSum(core);
+            minTSP = std::min(minTSP, coreSafePower);
+        }
+    }
 
-    return tsp(activeCores, powerOfInactiveCores);
+    return minTSP;
 }
 
 double ThermalModel::tsp(const std::vector<bool> &activeCores, const std::vector<double> &powerOfInactiveCores) const {
@@ -98,13 +116,14 @@ double ThermalModel::tsp(const std::vector<bool> &activeCores, const std::vector
 
     if (amtActiveCores > 0) {
         for (unsigned int core = 0; core < activeCores.size(); core++) {
+            const double *BInvRow = &BInv[core * numberThermalNodes];
             double activeSum = 0;
             double inactiveSum = 0;
             for (unsigned int i = 0; i < activeCores.size(); i++) {
                 if (activeCores.at(i)) {
-                    activeSum += BInv[core][i];
+                    activeSum += BInvRow[i];
                 } else {
-                    inactiveSum += powerOfInactiveCores.at(i) * BInv[core][i];
+                    inactiveSum += powerOfInactiveCores.at(i) * BInvRow[i];
                 }
             }
             double coreSafePower = (maxTemperature - ambientTemperature - inactiveSum) / activeSum;
@@ -128,25 +147,8 @@ std::vector<double> ThermalModel::tspForManyCandidates(const std::vector<bool> &
     std::vector<double> tsps(candidates.size(), tdpConstraint);
 
     if (amtActiveCores > 0) {
-        for (unsigned int core = 0; core < activeCores.size(); core++) {
-            double activeSum = 0;
-            double inactiveSum = 0;
-            for (unsigned int i = 0; i < activeCores.size(); i++) {
-                if (activeCores.at(i)) {
-                    activeSum += BInv[core][i];
-                } else {
-                    inactiveSum += BInv[core][i];
-                }
-            }
-
-            for (unsigned int candidateIdx = 0; candidateIdx < candidates.size(); candidateIdx++) {
-                int candidate = candidates.at(candidateIdx);
-                double candActiveSum = activeSum + BInv[core][candidate];
-                double candInactiveSum = inactiveSum - BInv[core][candidate];
-                double coreSafePower = (maxTemperature - ambientTemperature - inactivePower * candInactiveSum) / candActiveSum;
-                tsps.at(candidateIdx) = std::min(tsps.at(candidateIdx), coreSafePower);
-            }
-        }
+        headroom->update(activeCores);
+        headroom->minSafePowerOfCandidates(maxTemperature - ambientTemperature, inactivePower, candidates, tsps);
     }
 
     return tsps;
@@ -158,10 +160,7 @@ double ThermalModel::worstCaseTSP(int amtActiveCores) const {
 
     if (amtActiveCores > 0) {
         for (unsigned int core = 0; core < (unsigned int)(coreRows * coreColumns); core++) {
-            std::vector<double> BInvRow(coreRows * coreColumns);
-            for (unsigned int i = 0; i < (unsigned int)(coreRows * coreColumns); i++) {
-                BInvRow.at(i) = BInv[core][i];
-            }
+            std::vector<double> BInvRow(&BInv[core * numberThermalNodes], &BInv[core * numberThermalNodes + coreRows * coreColumns]);
             std::sort(BInvRow.begin(), BInvRow.end(), std::greater<double>()); // sort descending
 
             double activeSum = 0;
@@ -182,75 +181,65 @@ double ThermalModel::worstCaseTSP(int amtActiveCores) const {
     return minTSP;
 }
 
-void ThermalModel::inplaceGauss(std::vector<std::vector<float>> &A, std::vector<float> &b) const {
-    unsigned int n = b.size();
-    for (unsigned int row = 0; row < n; row++) {
-        // divide
-        float pivot = A.at(row).at(row);
-        b.at(row) /= pivot;
-        for (unsigned int col = 0; col < n; col++) {
-            A.at(row).at(col) /= pivot;
-        }
-
-        // add
-        for (unsigned int row2 = 0; row2 < n; row2++) {
-            if (row != row2) {
-                float factor = A.at(row2).at(row);
-                b.at(row2) -= factor * b.at(row);
-                for (unsigned int col = 0; col < n; col++) {
-                    A.at(row2).at(col) -= factor * A.at(row).at(col);
-                }
-            }
-        }
-    }
-}
-
 /** powerBudgetMaxSteadyState
  * Return a per-core power budget that (if matched by the power consumption) heats every core exactly to the critical temperature.
  */
 std::vector<double> ThermalModel::powerBudgetMaxSteadyState(const std::vector<bool> &activeCores) const {
+    // the budget only depends on the active cores: reuse it while the same cores stay active
+    std::unordered_map<std::vector<bool>, std::vector<double>>::const_iterator cached = powerBudgets.find(activeCores);
+    if (cached != powerBudgets.end()) {
+        return cached->second;
+    }
+
     std::vector<int> activeIndices;
-    std::vector<double> inactivePowers(coreRows * coreColumns, 0);
     for (unsigned int i = 0; i < coreRows * coreColumns; i++) {
         if (activeCores.at(i)) {
             activeIndices.push_back(i);
-        } else {
-            inactivePowers.at(i) = inactivePower;
         }
     }
-    std::vector<float> tInactive = getSteadyState(inactivePowers);
-    std::vector<float> headroomTrunc(activeIndices.size());
-    for (unsigned int i = 0; i < activeIndices.size(); i++) {
-        int index = activeIndices.at(i);
-        headroomTrunc.at(i) = maxTemperature - tInactive.at(index);
-    }
 
-    std::vector<float> powersTrunc = headroomTrunc;
-    std::vector<std::vector<float>> BInvTrunc;
+    // headroom of every active core above its steady-state temperature with only the inactive cores heating
+    std::vector<double> headroomTrunc(activeIndices.size());
+    std::vector<double> BInvTrunc(activeIndices.size() * activeIndices.size());
     for (unsigned int i = 0; i < activeIndices.size(); i++) {
-        std::vector<float> row;
+        const double *BInvRow = &BInv[activeIndices.at(i) * numberThermalNodes];
+        headroomTrunc.at(i) = maxTemperature - ambientTemperature;
+        for (unsigned int j = 0; j < coreRows * coreColumns; j++) {
+            if (!activeCores.at(j)) {
+                headroomTrunc.at(i) -= inactivePower * BInvRow[j];
+            }
+        }
         for (unsigned int j = 0; j < activeIndices.size(); j++) {
-            row.push_back(BInv[activeIndices.at(i)][activeIndices.at(j)]);
+            BInvTrunc.at(i * activeIndices.size() + j) = BInvRow[activeIndices.at(j)];
         }
-        BInvTrunc.push_back(row);
     }
     // now solve BInvTrunc * powersTrunc = headroomTrunc
-    inplaceGauss(BInvTrunc, powersTrunc);
+    LUFactorization factorization(BInvTrunc, activeIndices.size());
+    if (factorization.isSingular()) {
+        std::cout << "\n[Scheduler][TSP][Error]: Singular thermal model for the active cores." << std::endl;
+        exit (1);
+    }
+    std::vector<double> powersTrunc = factorization.solve(headroomTrunc);
 
     std::vector<double> powers(coreRows * coreColumns, inactivePower);
     for (unsigned int i = 0; i < activeIndices.size(); i++) {
         powers.at(activeIndices.at(i)) = powersTrunc.at(i);
     }
 
+    if (powerBudgets.size() >= 64) {
+        powerBudgets.clear();
+    }
+    powerBudgets[activeCores] = powers;
     return powers;
 }
 
 std::vector<float> ThermalModel::getSteadyState(const std::vector<double> &powers) const {
     std::vector<float> temperatures(coreRows * coreColumns);
     for (unsigned int core = 0; core < (unsigned int)(coreRows * coreColumns); core++) {
+        const double *BInvRow = &BInv[core * numberThermalNodes];
         temperatures.at(core) = ambientTemperature;
         for (unsigned int i = 0; i < (unsigned int)(coreRows * coreColumns); i++) {
-            temperatures.at(core) += powers.at(i) * BInv[core][i];
+            temperatures.at(core) += powers.at(i) * BInvRow[i];
         }
     }
     return temperatures;
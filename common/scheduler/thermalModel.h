@@ -5,7 +5,9 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 #include "fixed_types.h"
+#include "thermalHeadroom.h"
 
 class ThermalModel {
 public:
@@ -17,7 +19,6 @@ public:
     double worstCaseTSP(int amtActiveCores) const;
     std::vector<double> powerBudgetMaxSteadyState(const std::vector<bool> &activeCores) const;
     std::vector<float> getSteadyState(const std::vector<double> &powers) const;
-    void inplaceGauss(std::vector<std::vector<float>> &A, std::vector<float> &b) const;
     float getInactivePower() const { return inactivePower; }
 
 private:
@@ -27,12 +28,15 @@ private:
     double tdp;
     template<typename T> T readValue(std::ifstream &file) const;
     std::string readLine(std::ifstream &file) const;
-    void readDoubleMatrix(std::ifstream &file, double ***matrix, unsigned int rows, unsigned int columns) const;
+    void readDoubleMatrix(std::ifstream &file, double **matrix, unsigned int rows, unsigned int columns) const;
 
     unsigned int coreRows;
     unsigned int coreColumns;
+    unsigned int numberThermalNodes;
 
-    double **BInv;
+    double *BInv; // row-major numberThermalNodes x numberThermalNodes
+    mutable std::unordered_map<std::vector<bool>, std::vector<double>> powerBudgets; // powerBudgetMaxSteadyState per active-core bitmask
+    mutable ThermalHeadroom *headroom; // cached sums of the rows of the cores, over the active and inactive cores
 };
 
 #endif
@@ -0,0 +1,87 @@
+#include "thermalSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+LUFactorization::LUFactorization(const std::vector<double> &matrix, unsigned int n)
+    : n(n), lu(matrix), pivots(n), singular(false) {
+    factorize();
+}
+
+/** factorize
+ * Right-looking blocked LU: factorize a panel of blockSize columns (with partial pivoting on whole rows),
+ * compute the matching block row of U, then update the trailing matrix one contiguous row at a time.
+ */
+void LUFactorization::factorize() {
+    double *a = lu.data();
+    for (unsigned int k0 = 0; k0 < n; k0 += blockSize) {
+        unsigned int k1 = std::min(k0 + blockSize, n);
+
+        // panel
+        for (unsigned int k = k0; k < k1; k++) {
+            unsigned int p = k;
+            for (unsigned int i = k + 1; i < n; i++) {
+                if (std::fabs(a[i * n + k]) > std::fabs(a[p * n + k])) {
+                    p = i;
+                }
+            }
+            if (a[p * n + k] == 0) {
+                pivots[k] = k;
+                singular = true;
+                continue;
+            }
+            pivots[k] = p;
+            if (p != k) {
+                std::swap_ranges(&a[k * n], &a[k * n + n], &a[p * n]);
+            }
+            double pivot = a[k * n + k];
+            for (unsigned int i = k + 1; i < n; i++) {
+                double factor = (a[i * n + k] /= pivot);
+                for (unsigned int j = k + 1; j < k1; j++) {
+                    a[i * n + j] -= factor * a[k * n + j];
+                }
+            }
+        }
+
+        // block row of U: L11 * U12 = A12
+        for (unsigned int k = k0; k < k1; k++) {
+            for (unsigned int i = k + 1; i < k1; i++) {
+                double factor = a[i * n + k];
+                for (unsigned int j = k1; j < n; j++) {
+                    a[i * n + j] -= factor * a[k * n + j];
+                }
+            }
+        }
+
+        // trailing matrix: A22 -= L21 * U12
+        for (unsigned int i = k1; i < n; i++) {
+            for (unsigned int k = k0; k < k1; k++) {
+                double factor = a[i * n + k];
+                for (unsigned int j = k1; j < n; j++) {
+                    a[i * n + j] -= factor * a[k * n + j];
+                }
+            }
+        }
+    }
+}
+
+std::vector<double> LUFactorization::solve(const std::vector<double> &b) const {
+    std::vector<double> x(b);
+    for (unsigned int k = 0; k < n; k++) {
+        std::swap(x[k], x[pivots[k]]);
+    }
+    // L * y = P * b
+    for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = 0; j < i; j++) {
+            x[i] -= lu[i * n + j] * x[j];
+        }
+    }
+    // U * x = y
+    for (unsigned int i = n; i-- > 0;) {
+        for (unsigned int j = i + 1; j < n; j++) {
+            x[i] -= lu[i * n + j] * x[j];
+        }
+        x[i] /= lu[i * n + i];
+    }
+    return x;
+}
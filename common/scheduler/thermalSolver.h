@@ -0,0 +1,32 @@
+/**
+ * thermalSolver
+ * This header implements the dense linear solver of the thermal models: a cache-blocked LU factorization
+ * with partial pivoting on contiguous row-major storage, in double precision.
+ */
+
+#ifndef __THERMAL_SOLVER_H
+#define __THERMAL_SOLVER_H
+
+#include <vector>
+
+class LUFactorization {
+public:
+    // factorize the row-major n x n matrix: P * A = L * U
+    LUFactorization(const std::vector<double> &matrix, unsigned int n);
+
+    // solve A * x = b
+    std::vector<double> solve(const std::vector<double> &b) const;
+    bool isSingular() const { return singular; }
+
+private:
+    static const unsigned int blockSize = 32;
+
+    unsigned int n;
+    std::vector<double> lu; // unit lower triangle L and upper triangle U, row-major
+    std::vector<unsigned int> pivots; // row k was swapped with row pivots[k]
+    bool singular;
+
+    void factorize();
+};
+
+#endif
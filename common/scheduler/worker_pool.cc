@@ -0,0 +1,69 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(unsigned int numberOfHelpers)
+    : task(NULL), numberOfItems(0), nextItem(0), stopping(false) {
+    for (unsigned int helper = 0; helper < numberOfHelpers; helper++) {
+        helpers.push_back(new Helper(this, helper + 1)); // worker 0 is the calling thread
+        threads.push_back(_Thread::create(helpers.back()));
+        threads.back()->run();
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stopping = true;
+    for (unsigned int helper = 0; helper < helpers.size(); helper++) {
+        start.signal();
+    }
+    // threads cannot be joined, wait until every helper has left its loop instead
+    for (unsigned int helper = 0; helper < helpers.size(); helper++) {
+        finished.wait();
+    }
+    for (unsigned int helper = 0; helper < helpers.size(); helper++) {
+        delete threads.at(helper);
+        delete helpers.at(helper);
+    }
+}
+
+void WorkerPool::run(unsigned int numberOfItems, const Task &task) {
+    if (helpers.empty() || numberOfItems <= 1) {
+        for (unsigned int item = 0; item < numberOfItems; item++) {
+            task(0, item);
+        }
+        return;
+    }
+
+    this->task = &task;
+    this->numberOfItems = numberOfItems;
+    nextItem = 0;
+    // the semaphores order these writes before the helpers start, and the helpers' results before we return
+    for (unsigned int helper = 0; helper < helpers.size(); helper++) {
+        start.signal();
+    }
+    work(0);
+    for (unsigned int helper = 0; helper < helpers.size(); helper++) {
+        finished.wait();
+    }
+    this->task = NULL;
+}
+
+void WorkerPool::work(unsigned int worker) {
+    while (true) {
+        unsigned int item = __sync_fetch_and_add(&nextItem, 1);
+        if (item >= numberOfItems) {
+            break;
+        }
+        (*task)(worker, item);
+    }
+}
+
+void WorkerPool::Helper::run() {
+    while (true) {
+        pool->start.wait();
+        if (pool->stopping) {
+            pool->finished.signal();
+            return;
+        }
+        pool->work(worker);
+        pool->finished.signal();
+    }
+}
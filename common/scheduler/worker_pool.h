@@ -0,0 +1,50 @@
+/**
+ * worker_pool
+ * This header implements a small pool of helper threads for the scheduler policies.
+ * run() hands out the items of a parallel loop to the helpers and to the calling thread, and returns when all are done.
+ */
+
+#ifndef __WORKER_POOL_H
+#define __WORKER_POOL_H
+
+#include "_thread.h"
+#include "semaphore.h"
+
+#include <functional>
+#include <vector>
+
+class WorkerPool {
+public:
+    // item is in [0, numberOfItems), worker in [0, getNumberOfWorkers()) and identifies per-worker scratch data
+    typedef std::function<void(unsigned int worker, unsigned int item)> Task;
+
+    WorkerPool(unsigned int numberOfHelpers);
+    ~WorkerPool();
+
+    unsigned int getNumberOfWorkers() const { return helpers.size() + 1; }
+    void run(unsigned int numberOfItems, const Task &task);
+
+private:
+    class Helper : public Runnable {
+    public:
+        Helper(WorkerPool *pool, unsigned int worker) : pool(pool), worker(worker) {}
+        void run();
+    private:
+        WorkerPool *pool;
+        unsigned int worker;
+    };
+
+    std::vector<Helper*> helpers;
+    std::vector<_Thread*> threads;
+    Semaphore start;
+    Semaphore finished;
+
+    const Task *task;
+    unsigned int numberOfItems;
+    volatile unsigned int nextItem;
+    bool stopping;
+
+    void work(unsigned int worker);
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include "stats.h"
 #include "magic_server.h"
 #include "thread_stats_manager.h"
+#include "ipc_trace.h"
+#include "config.h"
 
 
 //////////
@@ -121,6 +123,144 @@ getStatsGetter(PyObject *self, PyObject *args)
 }
 
 
+//////////
+// get_vector(): retrieve a stats value for all indices (cores) at once
+//////////
+
+static bool
+parseStatsVector(PyObject *args, std::vector<StatsMetricBase *> &metrics)
+{
+   const char *objectName = NULL, *metricName = NULL;
+   long int count = Sim()->getConfig()->getApplicationCores();
+
+   if (!PyArg_ParseTuple(args, "ss|l", &objectName, &metricName, &count))
+      return false;
+
+   bool found = false;
+   for(long int index = 0; index < count; ++index)
+   {
+      metrics.push_back(Sim()->getStatsManager()->getMetricObject(objectName, index, metricName));
+      if (metrics.back())
+         found = true;
+   }
+
+   if (!found) {
+      PyErr_SetString(PyExc_ValueError, "Stats metric not found");
+      return false;
+   }
+   return true;
+}
+
+static PyObject *
+buildStatsVector(const std::vector<StatsMetricBase *> &metrics)
+{
+   // Indices that do not have this statistic read as zero
+   PyObject *pList = PyList_New(metrics.size());
+   for(size_t index = 0; index < metrics.size(); ++index)
+      PyList_SET_ITEM(pList, index, PyLong_FromUnsignedLongLong(metrics[index] ? metrics[index]->recordMetric() : 0));
+   return pList;
+}
+
+static PyObject *
+getStatsVector(PyObject *self, PyObject *args)
+{
+   std::vector<StatsMetricBase *> metrics;
+   if (!parseStatsVector(args, metrics))
+      return NULL;
+
+   return buildStatsVector(metrics);
+}
+
+
+//////////
+// getter_vector(): return a statsVectorGetterObject Python object which, when called, returns a list of stats values
+//////////
+
+typedef struct {
+   PyObject_HEAD
+   std::vector<StatsMetricBase *> *metrics;
+} statsVectorGetterObject;
+
+static PyObject *
+statsVectorGetterGet(PyObject *self, PyObject *args, PyObject *kw)
+{
+   statsVectorGetterObject *getter = (statsVectorGetterObject *)self;
+   return buildStatsVector(*getter->metrics);
+}
+
+static void
+statsVectorGetterDealloc(PyObject *self)
+{
+   statsVectorGetterObject *getter = (statsVectorGetterObject *)self;
+   delete getter->metrics;
+   PyObject_Del(self);
+}
+
+static PyTypeObject statsVectorGetterType = {
+   PyObject_HEAD_INIT(NULL)
+   0,                         /*ob_size*/
+   "statsVectorGetter",       /*tp_name*/
+   sizeof(statsVectorGetterObject), /*tp_basicsize*/
+   0,                         /*tp_itemsize*/
+   statsVectorGetterDealloc,  /*tp_dealloc*/
+   0,                         /*tp_print*/
+   0,                         /*tp_getattr*/
+   0,                         /*tp_setattr*/
+   0,                         /*tp_compare*/
+   0,                         /*tp_repr*/
+   0,                         /*tp_as_number*/
+   0,                         /*tp_as_sequence*/
+   0,                         /*tp_as_mapping*/
+   0,                         /*tp_hash */
+   statsVectorGetterGet,      /*tp_call*/
+   0,                         /*tp_str*/
+   0,                         /*tp_getattro*/
+   0,                         /*tp_setattro*/
+   0,                         /*tp_as_buffer*/
+   Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+   "Stats vector getter objects", /*tp_doc*/
+   0,                         /*tp_traverse*/
+   0,                         /*tp_clear*/
+   0,                         /*tp_richcompare*/
+   0,                         /*tp_weaklistoffset*/
+   0,                         /*tp_iter*/
+   0,                         /*tp_iternext*/
+   0,                         /*tp_methods*/
+   0,                         /*tp_members*/
+   0,                         /*tp_getset*/
+   0,                         /*tp_base*/
+   0,                         /*tp_dict*/
+   0,                         /*tp_descr_get*/
+   0,                         /*tp_descr_set*/
+   0,                         /*tp_dictoffset*/
+   0,                         /*tp_init*/
+   0,                         /*tp_alloc*/
+   0,                         /*tp_new*/
+   0,                         /*tp_free*/
+   0,                         /*tp_is_gc*/
+   0,                         /*tp_bases*/
+   0,                         /*tp_mro*/
+   0,                         /*tp_cache*/
+   0,                         /*tp_subclasses*/
+   0,                         /*tp_weaklist*/
+   0,                         /*tp_del*/
+   0,                         /*tp_version_tag*/
+};
+
+static PyObject *
+getStatsVectorGetter(PyObject *self, PyObject *args)
+{
+   std::vector<StatsMetricBase *> metrics;
+   if (!parseStatsVector(args, metrics))
+      return NULL;
+
+   statsVectorGetterObject *pGetter = PyObject_New(statsVectorGetterObject, &statsVectorGetterType);
+   pGetter->metrics = new std::vector<StatsMetricBase *>(metrics);
+
+   return (PyObject *)pGetter;
+}
+
+
 //////////
 // write(): write the current set of statistics out to sim.stats or our own file
 //////////
@@ -139,6 +279,47 @@ writeStats(PyObject *self, PyObject *args)
 }
 
 
+//////////
+// delete(): remove a set of statistics written by write()
+//////////
+
+static PyObject *
+deleteStats(PyObject *self, PyObject *args)
+{
+   const char *prefix = NULL;
+
+   if (!PyArg_ParseTuple(args, "s", &prefix))
+      return NULL;
+
+   Sim()->getStatsManager()->deleteStats(prefix);
+
+   Py_RETURN_NONE;
+}
+
+
+//////////
+// read_buffered(): values of a recent snapshot that is still in memory, by column
+//////////
+
+static PyObject *
+readBufferedStats(PyObject *self, PyObject *args)
+{
+   UInt64 prefixid = 0;
+
+   if (!PyArg_ParseTuple(args, "K", &prefixid))
+      return NULL;
+
+   std::vector<UInt64> values;
+   if (!Sim()->getStatsManager()->readStats(prefixid, values))
+      Py_RETURN_NONE;
+
+   PyObject *pValues = PyList_New(values.size());
+   for(UInt64 column = 0; column < values.size(); ++column)
+      PyList_SET_ITEM(pValues, column, PyLong_FromLongLong(values[column]));
+   return pValues;
+}
+
+
 //////////
 // register(): register a callback function that returns a statistics value
 //////////
@@ -239,6 +420,26 @@ getIcount(PyObject *self, PyObject *args)
 }
 
 
+//////////
+// trace_ipc(): write per-core IPCs every interval, natively
+//////////
+
+static PyObject *
+traceIpc(PyObject *self, PyObject *args)
+{
+   const char *filename = NULL;
+   UInt64 interval_ns = 0;
+
+   if (!PyArg_ParseTuple(args, "zl", &filename, &interval_ns))
+      return NULL;
+
+   // Like all periodic observers, the trace lives until the end of the simulation
+   new IpcTrace(filename ? filename : "", SubsecondTime::NS(interval_ns));
+
+   Py_RETURN_NONE;
+}
+
+
 //////////
 // module definition
 //////////
@@ -246,12 +447,17 @@ getIcount(PyObject *self, PyObject *args)
 static PyMethodDef PyStatsMethods[] = {
    {"get",  getStatsValue, METH_VARARGS, "Retrieve current value of statistic (objectName, index, metricName)."},
    {"getter", getStatsGetter, METH_VARARGS, "Return object to retrieve statistics value."},
+   {"get_vector", getStatsVector, METH_VARARGS, "Retrieve current values of statistic (objectName, metricName, [count]) for indices 0 .. count-1 (default: all cores)."},
+   {"getter_vector", getStatsVectorGetter, METH_VARARGS, "Return object to retrieve statistics values for all indices (objectName, metricName, [count])."},
    {"write", writeStats, METH_VARARGS, "Write statistics (<prefix>, [<filename>])."},
+   {"delete", deleteStats, METH_VARARGS, "Delete statistics written with write() (<prefix>)."},
+   {"read_buffered", readBufferedStats, METH_VARARGS, "Retrieve the values of snapshot <prefixid> by column, if it is not in sim.stats.columns yet (else None)."},
    {"register", registerStats, METH_VARARGS, "Register callback that defines statistics value for (objectName, index, metricName)."},
    {"register_per_thread", registerPerThread, METH_VARARGS, "Add a per-thread statistic (perthreadName) based on a named statistic (objectName, metricName)."},
    {"marker", writeMarker, METH_VARARGS, "Record a marker (coreid, threadid, arg0, arg1, [description])."},
    {"time", getTime, METH_VARARGS, "Retrieve the current global time in femtoseconds (approximate, last barrier)."},
    {"icount", getIcount, METH_VARARGS, "Retrieve current global instruction count."},
+   {"trace_ipc", traceIpc, METH_VARARGS, "Write the IPC of all cores every interval ([<filename>], interval_ns), natively."},
    {NULL, NULL, 0, NULL} /* Sentinel */
 };
 
@@ -265,4 +471,11 @@ void HooksPy::PyStats::setup(void)
 
    Py_INCREF(&statsGetterType);
    PyModule_AddObject(pModule, "Getter", (PyObject *)&statsGetterType);
+
+   statsVectorGetterType.tp_new = PyType_GenericNew;
+   if (PyType_Ready(&statsVectorGetterType) < 0)
+      return;
+
+   Py_INCREF(&statsVectorGetterType);
+   PyModule_AddObject(pModule, "VectorGetter", (PyObject *)&statsVectorGetterType);
 }
@@ -18,24 +18,47 @@
 BarrierSyncServer::BarrierSyncServer()
    : m_local_clock_list(Sim()->getConfig()->getApplicationCores(), SubsecondTime::Zero())
    , m_barrier_acquire_list(Sim()->getConfig()->getApplicationCores(), false)
-   , m_core_cond(Sim()->getConfig()->getApplicationCores(), NULL)
+   , m_core_wakeup(Sim()->getConfig()->getApplicationCores(), NULL)
    , m_core_group(Sim()->getConfig()->getApplicationCores(), INVALID_CORE_ID)
+   , m_num_group_members(Sim()->getConfig()->getApplicationCores(), 0)
+   , m_blocking_core(INVALID_CORE_ID)
    , m_core_thread(Sim()->getConfig()->getApplicationCores(), INVALID_THREAD_ID)
    , m_global_time(SubsecondTime::Zero())
    , m_fastforward(false)
    , m_disable(false)
+   , m_interactions(0)
+   , m_epoch_start(SubsecondTime::Zero())
+   , m_num_epochs(0)
+   , m_num_widened(0)
+   , m_num_narrowed(0)
+   , m_total_interactions(0)
+   , m_skew_max(SubsecondTime::Zero())
+   , m_skew_total(SubsecondTime::Zero())
 {
    try
    {
       m_barrier_interval = SubsecondTime::NS() * (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/barrier/quantum");
+      m_adaptive = Sim()->getCfg()->getBool("clock_skew_minimization/barrier/adaptive");
+      m_min_interval = SubsecondTime::NS() * (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/barrier/min_quantum");
+      m_max_interval = SubsecondTime::NS() * (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/barrier/max_quantum");
+      m_widen_threshold = Sim()->getCfg()->getFloat("clock_skew_minimization/barrier/widen_threshold");
+      m_narrow_threshold = Sim()->getCfg()->getFloat("clock_skew_minimization/barrier/narrow_threshold");
    }
    catch(...)
    {
-      LOG_PRINT_ERROR("Error Reading 'clock_skew_minimization/barrier/quantum' from the config file");
+      LOG_PRINT_ERROR("Error Reading 'clock_skew_minimization/barrier' parameters from the config file");
+   }
+
+   if (m_adaptive)
+   {
+      LOG_ASSERT_ERROR(m_min_interval > SubsecondTime::Zero() && m_min_interval <= m_barrier_interval && m_barrier_interval <= m_max_interval,
+         "Adaptive barrier needs 0 < min_quantum(%s) <= quantum(%s) <= max_quantum(%s)",
+         itostr(m_min_interval).c_str(), itostr(m_barrier_interval).c_str(), itostr(m_max_interval).c_str());
+      LOG_ASSERT_ERROR(m_widen_threshold <= m_narrow_threshold, "Adaptive barrier needs widen_threshold <= narrow_threshold");
    }
 
    for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
-      m_core_cond[core_id] = new ConditionVariable();
+      m_core_wakeup[core_id] = new WakeupEvent();
 
    m_next_barrier_time = m_barrier_interval;
 
@@ -43,22 +66,36 @@ BarrierSyncServer::BarrierSyncServer()
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_EXIT, BarrierSyncServer::hookThreadExit, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_STALL, BarrierSyncServer::hookThreadStall, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
    Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_MIGRATE, BarrierSyncServer::hookThreadMigrate, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
+   if (m_adaptive)
+      Sim()->getHooksManager()->registerHook(HookType::HOOK_SYSCALL_ENTER, BarrierSyncServer::hookSyscallEnter, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
 
    registerStatsMetric("barrier", 0, "global_time", &m_global_time);
+   registerStatsMetric("barrier", 0, "quantum", &m_barrier_interval);
+   registerStatsMetric("barrier", 0, "epochs", &m_num_epochs);
+   registerStatsMetric("barrier", 0, "quantum_widened", &m_num_widened);
+   registerStatsMetric("barrier", 0, "quantum_narrowed", &m_num_narrowed);
+   registerStatsMetric("barrier", 0, "interactions", &m_total_interactions);
+   registerStatsMetric("barrier", 0, "skew_max", &m_skew_max);
+   registerStatsMetric("barrier", 0, "skew_total", &m_skew_total);
 }
 
 BarrierSyncServer::~BarrierSyncServer()
 {
    for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
-      delete m_core_cond[core_id];
+      delete m_core_wakeup[core_id];
 }
 
 void
 BarrierSyncServer::synchronize(core_id_t core_id, SubsecondTime time)
 {
-   ScopedLock sl(Sim()->getThreadManager()->getLock());
+   // The lock is released explicitly: waiting threads do not take it again once they are released
+   Lock &lock = Sim()->getThreadManager()->getLock();
+   lock.acquire();
    if (m_disable)
+   {
+      lock.release();
       return;
+   }
 
    Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
    core_id_t master_core_id;
@@ -80,6 +117,7 @@ BarrierSyncServer::synchronize(core_id_t core_id, SubsecondTime time)
       LOG_PRINT("Sent 'SIM_BARRIER_RELEASE' immediately time(%s), m_next_barrier_time(%s)", itostr(time).c_str(), itostr(m_next_barrier_time).c_str());
       // LOG_PRINT_WARNING("core_id(%i), local_clock(%llu), m_next_barrier_time(%llu), m_barrier_interval(%llu)", core_id, time, m_next_barrier_time, m_barrier_interval);
       CLOG("barrier", "Core %d immediate exit", core_id);
+      lock.release();
       return;
    }
 
@@ -91,15 +129,22 @@ BarrierSyncServer::synchronize(core_id_t core_id, SubsecondTime time)
    m_local_clock_list[master_core_id] = time;
    m_barrier_acquire_list[master_core_id] = true;
    m_core_thread[master_core_id] = thread_me;
+   m_core_wakeup[master_core_id]->arm();
 
    bool mustWait = true;
    if (isBarrierReached())
       mustWait = barrierRelease(thread_me);
 
    if (mustWait)
-      m_core_cond[master_core_id]->wait(Sim()->getThreadManager()->getLock());
+   {
+      lock.release();
+      m_core_wakeup[master_core_id]->wait();
+   }
    else
+   {
       master_core->getPerformanceModel()->barrierExit();
+      lock.release();
+   }
 
    CLOG("barrier", "Core %d exit (master core %d, thread %d)", core_id, master_core_id, thread_me);
 }
@@ -116,6 +161,8 @@ BarrierSyncServer::threadExit(HooksManager::ThreadTime *argument)
 void
 BarrierSyncServer::threadStall(HooksManager::ThreadStall *argument)
 {
+   // Threads stall on futexes, joins, pipes, ...: mostly waiting for another thread
+   notifyInteraction();
    // Release thread from the barrier
    releaseThread(argument->thread_id);
    // Check to see if we were waiting for this thread
@@ -168,7 +215,7 @@ BarrierSyncServer::isCoreRunning(core_id_t core_id, bool siblings)
    }
 
 
-   if (siblings && !m_fastforward)
+   if (siblings && !m_fastforward && m_num_group_members[core_id] > 0)
    {
       for (core_id_t sibling_core_id = 0; sibling_core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); sibling_core_id++)
       {
@@ -189,50 +236,64 @@ BarrierSyncServer::advance()
    barrierRelease(INVALID_THREAD_ID, true);
 }
 
+BarrierSyncServer::core_barrier_state_t
+BarrierSyncServer::getCoreBarrierState(core_id_t core_id)
+{
+   // In fastforward mode, it's enough that a core is waiting. In detailed mode, it needs to have advanced up to the predefined barrier time
+   if (m_fastforward)
+   {
+      if (m_barrier_acquire_list[core_id])
+         return CORE_REACHED;
+      else if (isCoreRunning(core_id))
+         return CORE_WAITING;  // Core is running but hasn't checked in yet
+   }
+   else if (m_core_group[core_id] != INVALID_CORE_ID)
+   {
+      // Only consider group masters
+   }
+   else if (isCoreRunning(core_id))
+   {
+      if (m_local_clock_list[core_id] < m_next_barrier_time)
+         return CORE_WAITING;  // Core running on this core has not reached the barrier
+      else
+         return CORE_REACHED;
+   }
+   return CORE_IGNORED;
+}
+
 bool
 BarrierSyncServer::isBarrierReached()
 {
-   bool single_core_barrier_reached = false;
-
    // Check if all cores have reached the barrier
    // All least one core must have (sync_time > m_next_barrier_time)
-   for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+
+   // Most calls happen while other cores are still running, and the core we had to wait for last time usually still is
+   if (m_blocking_core != INVALID_CORE_ID && getCoreBarrierState(m_blocking_core) == CORE_WAITING)
+      return false;
+
+   // Continue the scan from there: the cores before it were found to be at the barrier already
+   core_id_t num_cores = Sim()->getConfig()->getApplicationCores();
+   core_id_t first = m_blocking_core == INVALID_CORE_ID ? 0 : m_blocking_core;
+   bool single_core_barrier_reached = false;
+
+   for (core_id_t i = 0; i < num_cores; i++)
    {
-      // In fastforward mode, it's enough that a core is waiting. In detailed mode, it needs to have advanced up to the predefined barrier time
-      if (m_fastforward)
+      core_id_t core_id = (first + i) % num_cores;
+      core_barrier_state_t state = getCoreBarrierState(core_id);
+      if (state == CORE_WAITING)
       {
-         if (m_barrier_acquire_list[core_id])
-         {
-            // At least one core has reached the barrier
-            single_core_barrier_reached = true;
-         }
-         else if (isCoreRunning(core_id))
-         {
-            // Core is running but hasn't checked in yet. Wait for it to sync.
-            return false;
-         }
+         // Wait for it to sync
+         m_blocking_core = core_id;
+         return false;
       }
-      else if (m_core_group[core_id] != INVALID_CORE_ID)
+      else if (state == CORE_REACHED)
       {
-         // Only consider group masters
-         continue;
-      }
-      else if (isCoreRunning(core_id))
-      {
-         if (m_local_clock_list[core_id] < m_next_barrier_time)
-         {
-            // Core running on this core has not reached the barrier
-            // Wait for it to sync
-            return false;
-         }
-         else
-         {
-            // At least one core has reached the barrier
-            single_core_barrier_reached = true;
-         }
+         // At least one core has reached the barrier
+         single_core_barrier_reached = true;
       }
    }
 
+   m_blocking_core = INVALID_CORE_ID;
    return single_core_barrier_reached;
 }
 
@@ -248,6 +309,9 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
 
    LOG_ASSERT_ERROR(m_to_release.size() == 0, "Reached the barrier while some threads haven't even restarted?");
 
+   if (!m_fastforward)
+      updateSkew();
+
    if (m_fastforward)
    {
       for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
@@ -283,6 +347,9 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
       if (m_disable)
          return false;
 
+      if (m_adaptive && !m_fastforward)
+         adaptInterval();
+
       m_next_barrier_time += m_barrier_interval;
       LOG_PRINT("m_next_barrier_time updated to (%s)", itostr(m_next_barrier_time).c_str());
 
@@ -321,6 +388,61 @@ BarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_rel
    return must_wait;
 }
 
+void
+BarrierSyncServer::updateSkew()
+{
+   // Spread of the local clocks of the cores that made it to this barrier
+   SubsecondTime time_min = SubsecondTime::MaxTime(), time_max = SubsecondTime::Zero();
+   for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   {
+      // Threads that stalled or exited have their time zeroed, they do not count
+      if (m_barrier_acquire_list[core_id] && m_local_clock_list[core_id] > SubsecondTime::Zero())
+      {
+         time_min = std::min(time_min, m_local_clock_list[core_id]);
+         time_max = std::max(time_max, m_local_clock_list[core_id]);
+      }
+   }
+   if (time_max >= time_min)
+   {
+      SubsecondTime skew = time_max - time_min;
+      m_skew_max = std::max(m_skew_max, skew);
+      m_skew_total += skew;
+   }
+}
+
+void
+BarrierSyncServer::adaptInterval()
+{
+   UInt64 interactions = __sync_lock_test_and_set(&m_interactions, 0);
+   SubsecondTime epoch_length = m_global_time - m_epoch_start;
+   m_epoch_start = m_global_time;
+   m_total_interactions += interactions;
+   ++m_num_epochs;
+
+   if (epoch_length == SubsecondTime::Zero())
+      return;
+
+   double rate = interactions * 1000. / epoch_length.getNS();
+   SubsecondTime barrier_interval = m_barrier_interval;
+   if (rate > m_narrow_threshold)
+      barrier_interval = std::max(m_min_interval, m_barrier_interval / 2);
+   else if (rate < m_widen_threshold)
+      barrier_interval = std::min(m_max_interval, m_barrier_interval * 2);
+
+   if (barrier_interval != m_barrier_interval)
+   {
+      CLOG("barrier", "Quantum %" PRId64 "ns > %" PRId64 "ns (%" PRId64 " interactions in %" PRId64 "ns)",
+         m_barrier_interval.getNS(), barrier_interval.getNS(), interactions, epoch_length.getNS());
+      if (barrier_interval > m_barrier_interval)
+         ++m_num_widened;
+      else
+         ++m_num_narrowed;
+      m_barrier_interval = barrier_interval;
+      // Align the next barrier to the new quantum, as BarrierSyncClient does with its next synchronization time
+      m_next_barrier_time = (m_global_time / m_barrier_interval) * m_barrier_interval;
+   }
+}
+
 void
 BarrierSyncServer::doRelease(int n)
 {
@@ -330,7 +452,7 @@ BarrierSyncServer::doRelease(int n)
    {
       core_id_t core_id = m_to_release.back();
       m_to_release.pop_back();
-      m_core_cond[core_id]->signal();
+      m_core_wakeup[core_id]->signal();
    }
 }
 
@@ -347,7 +469,7 @@ BarrierSyncServer::abortBarrier()
 
          Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
          core->getPerformanceModel()->barrierExit();
-         m_core_cond[core_id]->signal();
+         m_core_wakeup[core_id]->signal();
       }
    }
 }
@@ -366,6 +488,10 @@ BarrierSyncServer::setGroup(core_id_t core_id, core_id_t master_core_id)
    if (master_core_id != INVALID_CORE_ID)
       LOG_ASSERT_ERROR(m_barrier_acquire_list[core_id] == false, "Core(%d) is in the barrier, cannot set participate to false", core_id);
 
+   if (m_core_group[core_id] != INVALID_CORE_ID)
+      --m_num_group_members[m_core_group[core_id]];
+   if (master_core_id != INVALID_CORE_ID)
+      ++m_num_group_members[master_core_id];
    m_core_group[core_id] = master_core_id;
 }
 
@@ -373,7 +499,12 @@ void
 BarrierSyncServer::setFastForward(bool fastforward, SubsecondTime next_barrier_time)
 {
    if (m_fastforward != fastforward)
+   {
       CLOG("barrier", "FastForward %d > %d", m_fastforward, fastforward);
+      // Do not let fast-forwarded time and interactions count towards the next adaptive epoch
+      m_epoch_start = m_global_time;
+      m_interactions = 0;
+   }
    m_fastforward = fastforward;
    if (next_barrier_time != SubsecondTime::MaxTime())
    {
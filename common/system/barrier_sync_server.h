@@ -16,14 +16,39 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       SubsecondTime m_next_barrier_time;
       std::vector<SubsecondTime> m_local_clock_list;
       std::vector<bool> m_barrier_acquire_list;
-      std::vector<ConditionVariable*> m_core_cond;
+      std::vector<WakeupEvent*> m_core_wakeup;
       std::vector<core_id_t> m_to_release;
       std::vector<core_id_t> m_core_group;
+      std::vector<UInt32> m_num_group_members;
+      core_id_t m_blocking_core; // Last core found running that had not reached the barrier yet
       std::vector<thread_id_t> m_core_thread;
       SubsecondTime m_global_time;
       bool m_fastforward;
       volatile bool m_disable;
 
+      // Adaptive quantum: double it while cores rarely interact, halve it when they do, within [min, max]
+      bool m_adaptive;
+      SubsecondTime m_min_interval;
+      SubsecondTime m_max_interval;
+      double m_widen_threshold;  // Interactions per microsecond
+      double m_narrow_threshold;
+      volatile UInt64 m_interactions;
+      SubsecondTime m_epoch_start;
+      UInt64 m_num_epochs;
+      UInt64 m_num_widened;
+      UInt64 m_num_narrowed;
+      UInt64 m_total_interactions;
+      SubsecondTime m_skew_max;
+      SubsecondTime m_skew_total;
+
+      enum core_barrier_state_t
+      {
+         CORE_IGNORED,  // Not running, or represented by its group master
+         CORE_WAITING,  // Running, the barrier has to wait for it
+         CORE_REACHED,
+      };
+
+      core_barrier_state_t getCoreBarrierState(core_id_t core_id);
       bool isBarrierReached(void);
       bool barrierRelease(thread_id_t thread_id = INVALID_THREAD_ID, bool continue_until_release = false);
       void abortBarrier(void);
@@ -31,6 +56,8 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       void releaseThread(thread_id_t thread_id);
       void signal();
       void doRelease(int n);
+      void updateSkew(void);
+      void adaptInterval(void);
 
       static SInt64 hookThreadExit(UInt64 object, UInt64 argument) {
          ((BarrierSyncServer*)object)->threadExit((HooksManager::ThreadTime*)argument); return 0;
@@ -41,6 +68,9 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       static SInt64 hookThreadMigrate(UInt64 object, UInt64 argument) {
          ((BarrierSyncServer*)object)->threadMigrate((HooksManager::ThreadMigrate*)argument); return 0;
       }
+      static SInt64 hookSyscallEnter(UInt64 object, UInt64 argument) {
+         ((BarrierSyncServer*)object)->notifyInteraction(); return 0;
+      }
       void threadExit(HooksManager::ThreadTime *argument);
       void threadStall(HooksManager::ThreadStall *argument);
       void threadMigrate(HooksManager::ThreadMigrate *argument);
@@ -58,6 +88,7 @@ class BarrierSyncServer : public ClockSkewMinimizationServer
       SubsecondTime getGlobalTime(bool upper_bound = false) { return upper_bound ? m_next_barrier_time : m_global_time; }
       void setBarrierInterval(SubsecondTime barrier_interval) { m_barrier_interval = barrier_interval; }
       SubsecondTime getBarrierInterval() const { return m_barrier_interval; }
+      void notifyInteraction() { if (m_adaptive) __sync_fetch_and_add(&m_interactions, 1); }
 
       void printState(void);
 };
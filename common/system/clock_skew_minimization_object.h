@@ -64,6 +64,8 @@ public:
    virtual SubsecondTime getGlobalTime(bool upper_bound = false);
    virtual void setBarrierInterval(SubsecondTime barrier_interval) = 0;
    virtual SubsecondTime getBarrierInterval() const = 0;
+   // Cores interacted (coherence request, system call, ...): schemes that adapt their interval can use this
+   virtual void notifyInteraction() {}
 
    virtual void printState(void) {}
 };
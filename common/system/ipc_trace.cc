@@ -0,0 +1,52 @@
+#include "ipc_trace.h"
+#include "simulator.h"
+#include "config.h"
+#include "hooks_manager.h"
+#include "magic_server.h"
+#include "log.h"
+
+IpcTrace::IpcTrace(String filename, SubsecondTime interval)
+   : PeriodicObserver(interval, true, &m_stats)
+   , m_stats(Sim()->getConfig()->getApplicationCores())
+   , m_fp(stdout)
+{
+   m_row_time = m_stats.add("performance_model", "elapsed_time");
+   m_row_instructions = m_stats.add("core", "instructions");
+
+   if (!filename.empty())
+   {
+      m_fp = fopen(Sim()->getConfig()->formatOutputFileName(filename).c_str(), "w");
+      LOG_ASSERT_ERROR(m_fp, "Cannot open IPC trace file %s", filename.c_str());
+   }
+
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_SIM_END, hook_sim_end, (UInt64)this);
+}
+
+void
+IpcTrace::periodic(SubsecondTime time, SubsecondTime time_delta)
+{
+   if (!m_fp)
+      return;
+
+   const UInt64 *elapsed = m_stats.getDeltas(m_row_time);
+   const UInt64 *instructions = m_stats.getDeltas(m_row_instructions);
+
+   if (m_fp == stdout)
+      fprintf(m_fp, "[IPC] ");
+   fprintf(m_fp, "%" PRIu64, time.getNS());
+   for(UInt32 core = 0; core < m_stats.getNumIndices(); ++core)
+   {
+      // Elapsed time is in fs, frequency in MHz
+      double cycles = double(elapsed[core] * Sim()->getMagicServer()->getFrequency(core)) / 1e9;
+      fprintf(m_fp, " %.3f", instructions[core] / (cycles ? cycles : 1));
+   }
+   fprintf(m_fp, "\n");
+}
+
+void
+IpcTrace::simEnd()
+{
+   if (m_fp && m_fp != stdout)
+      fclose(m_fp);
+   m_fp = NULL;
+}
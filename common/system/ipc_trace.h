@@ -0,0 +1,29 @@
+#ifndef __IPC_TRACE_H
+#define __IPC_TRACE_H
+
+#include "periodic_observer.h"
+#include "stats.h"
+
+#include <cstdio>
+
+// Native version of scripts/ipctrace.py: every interval, write the time (in ns) and the IPC of each core
+// over that interval (fast-forwarded instructions and time included) to a file, or to stdout prefixed with [IPC]
+class IpcTrace : public PeriodicObserver
+{
+   public:
+      IpcTrace(String filename, SubsecondTime interval);
+
+   protected:
+      void periodic(SubsecondTime time, SubsecondTime time_delta);
+
+   private:
+      StatsDelta m_stats;
+      UInt32 m_row_time;
+      UInt32 m_row_instructions;
+      FILE *m_fp;
+
+      static SInt64 hook_sim_end(UInt64 self, UInt64) { ((IpcTrace*)self)->simEnd(); return 0; }
+      void simEnd();
+};
+
+#endif // __IPC_TRACE_H
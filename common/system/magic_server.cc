@@ -11,6 +11,8 @@
 #include "stats.h"
 #include "timer.h"
 #include "thread.h"
+#include "scheduler.h"
+#include "clock_skew_minimization_object.h"
 
 MagicServer::MagicServer()
       : m_performance_enabled(false)
@@ -99,6 +101,14 @@ UInt64 MagicServer::Magic_unlocked(thread_id_t thread_id, core_id_t core_id, UIn
          return setInstrumentationMode(arg0);
       case SIM_CMD_MHZ_GET:
          return getFrequency(arg0);
+      case SIM_CMD_HEARTBEAT:
+      {
+         // Return the time of the beat (in fs) so the heartbeats library can still compute its own rates and log
+         Thread *thread = Sim()->getThreadManager()->getThreadFromID(thread_id);
+         SubsecondTime time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
+         Sim()->getThreadManager()->getScheduler()->appHeartbeat(thread->getAppId(), thread_id, time, arg0);
+         return time.getFS();
+      }
       default:
          LOG_ASSERT_ERROR(false, "Got invalid Magic %lu, arg0(%lu) arg1(%lu)", cmd, arg0, arg1);
    }
@@ -0,0 +1,58 @@
+#include "periodic_observer.h"
+#include "simulator.h"
+#include "hooks_manager.h"
+#include "clock_skew_minimization_object.h"
+#include "stats.h"
+
+PeriodicObserver::PeriodicObserver(SubsecondTime interval, bool roi_only, StatsDelta *stats_delta)
+   : m_interval(interval)
+   , m_roi_only(roi_only)
+   , m_stats_delta(stats_delta)
+   , m_in_roi(false)
+   , m_time_next(SubsecondTime::Zero())
+   , m_time_last(SubsecondTime::Zero())
+   , m_warned(false)
+{
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_PERIODIC, hook_periodic, (UInt64)this);
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_ROI_BEGIN, hook_roi_begin, (UInt64)this);
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_ROI_END, hook_roi_end, (UInt64)this);
+}
+
+void
+PeriodicObserver::roiBegin()
+{
+   m_in_roi = true;
+   tick(Sim()->getClockSkewMinimizationServer()->getGlobalTime());
+}
+
+void
+PeriodicObserver::roiEnd()
+{
+   tick(Sim()->getClockSkewMinimizationServer()->getGlobalTime());
+   m_in_roi = false;
+}
+
+void
+PeriodicObserver::tick(SubsecondTime time)
+{
+   if ((m_roi_only && !m_in_roi) || time < m_time_next)
+      return;
+
+   // HOOK_PERIODIC is called once per barrier quantum, which can change over time with the adaptive quantum
+   ClockSkewMinimizationServer *server = Sim()->getClockSkewMinimizationServer();
+   if (!m_warned && server && m_interval < server->getBarrierInterval())
+   {
+      LOG_PRINT_WARNING("PeriodicObserver: interval(%" PRId64 "ns) < periodic callback(%" PRId64 "ns), consider reducing clock_skew_minimization/barrier/quantum",
+         m_interval.getNS(), server->getBarrierInterval().getNS());
+      m_warned = true;
+   }
+
+   SubsecondTime time_delta = time - m_time_last;
+   m_time_next = time + m_interval;
+   m_time_last = time;
+
+   if (m_stats_delta && !m_stats_delta->update())
+      return;
+
+   periodic(time, time_delta);
+}
@@ -0,0 +1,40 @@
+#ifndef __PERIODIC_OBSERVER_H
+#define __PERIODIC_OBSERVER_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+
+class StatsDelta;
+
+// Native counterpart of sim.util.Every: periodic() is called from HOOK_PERIODIC once every interval,
+// without going through the Python interpreter. As hooks cannot be unregistered, observers must live until simulation end.
+class PeriodicObserver
+{
+   public:
+      // When stats_delta is set, it is updated right before each call to periodic(),
+      // and the first call (which has no deltas yet) is skipped
+      PeriodicObserver(SubsecondTime interval, bool roi_only = true, StatsDelta *stats_delta = NULL);
+      virtual ~PeriodicObserver() {}
+
+   protected:
+      virtual void periodic(SubsecondTime time, SubsecondTime time_delta) = 0;
+
+   private:
+      const SubsecondTime m_interval;
+      const bool m_roi_only;
+      StatsDelta *m_stats_delta;
+      bool m_in_roi;
+      SubsecondTime m_time_next;
+      SubsecondTime m_time_last;
+      bool m_warned;
+
+      static SInt64 hook_periodic(UInt64 self, UInt64 time) { ((PeriodicObserver*)self)->tick(*(subsecond_time_t*)&time); return 0; }
+      static SInt64 hook_roi_begin(UInt64 self, UInt64) { ((PeriodicObserver*)self)->roiBegin(); return 0; }
+      static SInt64 hook_roi_end(UInt64 self, UInt64) { ((PeriodicObserver*)self)->roiEnd(); return 0; }
+
+      void tick(SubsecondTime time);
+      void roiBegin();
+      void roiEnd();
+};
+
+#endif // __PERIODIC_OBSERVER_H
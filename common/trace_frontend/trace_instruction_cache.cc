@@ -0,0 +1,70 @@
+#include "trace_instruction_cache.h"
+#include "instruction.h"
+#include "log.h"
+
+TraceInstructionCache::TraceInstructionCache()
+   : m_chunk_used(CHUNK_SIZE)
+{
+}
+
+TraceInstructionCache::~TraceInstructionCache()
+{
+   clear();
+}
+
+const dl::DecodedInst* TraceInstructionCache::getDecodedInst(IntPtr address)
+{
+   ScopedReadLock sl(m_lock);
+   std::unordered_map<IntPtr, const dl::DecodedInst *>::const_iterator it = m_decoded_insts.find(address);
+   return it == m_decoded_insts.end() ? NULL : it->second;
+}
+
+Instruction* TraceInstructionCache::getInstruction(IntPtr address)
+{
+   ScopedReadLock sl(m_lock);
+   std::unordered_map<IntPtr, Instruction *>::const_iterator it = m_instructions.find(address);
+   return it == m_instructions.end() ? NULL : it->second;
+}
+
+void TraceInstructionCache::insertDecodedInst(IntPtr address, const dl::DecodedInst *decoded_inst)
+{
+   ScopedLock sl(m_lock);
+   m_decoded_insts[address] = decoded_inst;
+}
+
+void TraceInstructionCache::insertInstruction(IntPtr address, Instruction *instruction)
+{
+   ScopedLock sl(m_lock);
+   m_instructions[address] = instruction;
+}
+
+void* TraceInstructionCache::allocate(size_t size)
+{
+   size = (size + 15) & ~(size_t)15;
+   LOG_ASSERT_ERROR(size <= CHUNK_SIZE, "Cannot allocate %lu bytes from the instruction cache", size);
+   if (m_chunk_used + size > CHUNK_SIZE)
+   {
+      m_chunks.push_back(static_cast<char *>(::operator new(CHUNK_SIZE)));
+      m_chunk_used = 0;
+   }
+   void *ptr = m_chunks.back() + m_chunk_used;
+   m_chunk_used += size;
+   return ptr;
+}
+
+void TraceInstructionCache::clear()
+{
+   ScopedLock sl(m_lock);
+   // Instructions live in the chunks: destroy them (which frees their formatted disassembly) before the chunks go
+   for(std::unordered_map<IntPtr, Instruction *>::iterator i = m_instructions.begin() ; i != m_instructions.end() ; ++i)
+      (*i).second->~Instruction();
+   m_instructions.clear();
+   for(std::vector<char *>::iterator i = m_chunks.begin() ; i != m_chunks.end() ; ++i)
+      ::operator delete(*i);
+   m_chunks.clear();
+   m_chunk_used = CHUNK_SIZE;
+
+   for(std::unordered_map<IntPtr, const dl::DecodedInst *>::iterator i = m_decoded_insts.begin() ; i != m_decoded_insts.end() ; ++i)
+      delete (*i).second;
+   m_decoded_insts.clear();
+}
@@ -0,0 +1,48 @@
+#ifndef __TRACE_INSTRUCTION_CACHE_H
+#define __TRACE_INSTRUCTION_CACHE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+#include <decoder.h>
+
+#include <unordered_map>
+#include <vector>
+
+class Instruction;
+
+// Decoded and modeled instructions of one application, shared by all its TraceThreads so every
+// static instruction is decoded (and its micro-ops are built) only once per application.
+// Lookups take a read lock; TraceThreads keep a private copy of the entries they use in front of it.
+class TraceInstructionCache
+{
+   private:
+      RwLock m_lock;
+      Lock m_miss_lock;
+      std::unordered_map<IntPtr, const dl::DecodedInst *> m_decoded_insts;
+      std::unordered_map<IntPtr, Instruction *> m_instructions;
+
+      static const size_t CHUNK_SIZE = 64 * 1024;
+      std::vector<char *> m_chunks;
+      size_t m_chunk_used;
+
+   public:
+      TraceInstructionCache();
+      ~TraceInstructionCache();
+
+      // Return NULL if the address was not decoded yet
+      const dl::DecodedInst* getDecodedInst(IntPtr address);
+      Instruction* getInstruction(IntPtr address);
+
+      // Hold the miss lock while decoding a missing address, then insert it: this way each address is decoded only once
+      Lock& getMissLock() { return m_miss_lock; }
+      void insertDecodedInst(IntPtr address, const dl::DecodedInst *decoded_inst);
+      void insertInstruction(IntPtr address, Instruction *instruction);
+      // Bump-allocate storage for an Instruction while holding the miss lock; it is destroyed and freed by clear()
+      void* allocate(size_t size);
+
+      // Only once no thread or performance model uses the Instructions anymore
+      void clear();
+};
+
+#endif // __TRACE_INSTRUCTION_CACHE_H
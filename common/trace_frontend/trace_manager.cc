@@ -1,5 +1,6 @@
 #include "trace_manager.h"
 #include "trace_thread.h"
+#include "trace_instruction_cache.h"
 #include "simulator.h"
 #include "thread_manager.h"
 #include "hooks_manager.h"
@@ -29,7 +30,11 @@ TraceManager::TraceManager()
    , m_app_info(m_num_apps)
    , m_tracefiles(m_num_apps)
    , m_responsefiles(m_num_apps)
+   , m_instruction_caches(m_num_apps)
 {
+   for (UInt32 i = 0 ; i < m_num_apps ; i++)
+      m_instruction_caches[i] = new TraceInstructionCache();
+
    setupTraceFiles(0);
 }
 
@@ -231,6 +236,9 @@ void TraceManager::cleanup()
       delete *it;
    m_threads.clear();
 
+   for(std::vector<TraceInstructionCache *>::iterator it = m_instruction_caches.begin(); it != m_instruction_caches.end(); ++it)
+      (*it)->clear();
+
    m_num_threads_running = 0;
    m_app_info.clear();
    m_app_info.resize(m_num_apps);
@@ -240,6 +248,9 @@ void TraceManager::cleanup()
 TraceManager::~TraceManager()
 {
    cleanup();
+
+   for(std::vector<TraceInstructionCache *>::iterator it = m_instruction_caches.begin(); it != m_instruction_caches.end(); ++it)
+      delete *it;
 }
 
 void TraceManager::start()
@@ -9,6 +9,7 @@
 #include <vector>
 
 class TraceThread;
+class TraceInstructionCache;
 
 class TraceManager
 {
@@ -50,6 +51,7 @@ class TraceManager
       std::vector<app_info_t> m_app_info;
       std::vector<String> m_tracefiles;
       std::vector<String> m_responsefiles;
+      std::vector<TraceInstructionCache *> m_instruction_caches; //< Decoded instructions, shared by all threads of an app
       String m_trace_prefix;
       Lock m_lock;
 
@@ -74,6 +76,7 @@ class TraceManager
       void signalStarted();
       void signalDone(TraceThread *thread, SubsecondTime time, bool aborted);
       void endApplication(TraceThread *thread, SubsecondTime time);
+      TraceInstructionCache* getInstructionCache(app_id_t app_id) { return m_instruction_caches.at(app_id); }
       void accessMemory(int core_id, Core::lock_signal_t lock_signal, Core::mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size);
 
       UInt64 getProgressExpect();
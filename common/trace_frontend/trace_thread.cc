@@ -1,5 +1,6 @@
 #include "trace_thread.h"
 #include "trace_manager.h"
+#include "trace_instruction_cache.h"
 #include "simulator.h"
 #include "core_manager.h"
 #include "thread_manager.h"
@@ -22,6 +23,7 @@
 
 #include <unistd.h>
 #include <sys/syscall.h>
+#include <new>
 
 #include <x86_decoder.h>  // TODO remove when the decode function in microop perf model is adapted
 
@@ -43,6 +45,8 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    , m_address_randomization(Sim()->getCfg()->getBool("traceinput/address_randomization"))
    , m_appid_from_coreid(Sim()->getCfg()->getString("scheduler/type") == "sequential" ? true : false)
    , m_stop(false)
+   , m_instruction_cache(NULL)
+   , m_private_instruction_cache(false)
    , m_bbv_base(0)
    , m_bbv_count(0)
    , m_bbv_last(0)
@@ -66,6 +70,7 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    //   xed_initialized = true;
    //}
 
+   m_trace.setDecompressionThreads(Sim()->getCfg()->getInt("traceinput/decompression_threads"));
    m_trace.setHandleInstructionCountFunc(TraceThread::__handleInstructionCountFunc, this);
    m_trace.setHandleCacheOnlyFunc(TraceThread::__handleCacheOnlyFunc, this);
    if (Sim()->getCfg()->getBool("traceinput/mirror_output"))
@@ -106,10 +111,8 @@ TraceThread::~TraceThread()
       unlink(m_tracefile.c_str());
       unlink(m_responsefile.c_str());
    }
-   for(std::unordered_map<IntPtr, const dl::DecodedInst *>::iterator i = m_decoder_cache.begin() ; i != m_decoder_cache.end() ; ++i)
-   {
-      delete (*i).second;
-   }
+   if (m_private_instruction_cache)
+      delete m_instruction_cache;
 }
 
 UInt64 TraceThread::va2pa(UInt64 va, bool *noMapping)
@@ -391,20 +394,62 @@ SubsecondTime TraceThread::getCurrentTime() const
    return m_thread->getCore()->getPerformanceModel()->getElapsedTime();
 }
 
+const dl::DecodedInst* TraceThread::getDecodedInst(Sift::Instruction &inst)
+{
+   std::unordered_map<IntPtr, const dl::DecodedInst *>::const_iterator it = m_decoder_cache.find(inst.sinst->addr);
+   if (it != m_decoder_cache.end())
+      return it->second;
+
+   const dl::DecodedInst *dec_inst = m_instruction_cache->getDecodedInst(inst.sinst->addr);
+   if (dec_inst == NULL)
+   {
+      ScopedLock sl(m_instruction_cache->getMissLock());
+      dec_inst = m_instruction_cache->getDecodedInst(inst.sinst->addr);
+      if (dec_inst == NULL)
+      {
+         dec_inst = staticDecode(inst);
+         m_instruction_cache->insertDecodedInst(inst.sinst->addr, dec_inst);
+      }
+   }
+   m_decoder_cache[inst.sinst->addr] = dec_inst;
+   return dec_inst;
+}
+
+Instruction* TraceThread::getInstruction(Sift::Instruction &inst)
+{
+   std::unordered_map<IntPtr, Instruction *>::const_iterator it = m_icache.find(inst.sinst->addr);
+   if (it != m_icache.end())
+      return it->second;
+
+   Instruction *instruction = m_instruction_cache->getInstruction(inst.sinst->addr);
+   if (instruction == NULL)
+   {
+      // Decode the operands first: the decoder cache takes the same miss lock
+      getDecodedInst(inst);
+      ScopedLock sl(m_instruction_cache->getMissLock());
+      instruction = m_instruction_cache->getInstruction(inst.sinst->addr);
+      if (instruction == NULL)
+      {
+         instruction = decode(inst);
+         m_instruction_cache->insertInstruction(inst.sinst->addr, instruction);
+      }
+   }
+   m_icache[inst.sinst->addr] = instruction;
+   return instruction;
+}
+
 Instruction* TraceThread::decode(Sift::Instruction &inst)
 {
 
    //printf("PC: %lx Size: %d num_addresses=%d is_branch=%d\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch);
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst& dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   const dl::DecodedInst& dec_inst = *getDecodedInst(inst);
 
    OperandList list;
 
    // Ignore memory-referencing operands in NOP instructions
    if (!(dec_inst.is_nop()))
    {
+      list.reserve(Sim()->getDecoder()->num_memory_operands(&dec_inst));
       for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
          if (Sim()->getDecoder()->op_read_mem(&dec_inst, mem_idx))
             list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
@@ -414,20 +459,18 @@ Instruction* TraceThread::decode(Sift::Instruction &inst)
             list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
    }
 
+   // Called with the miss lock held, so the instruction can be carved from the cache's arena
    Instruction *instruction;
    if (inst.is_branch)
-     instruction = new BranchInstruction(list); 
-
+      instruction = new (m_instruction_cache->allocate(sizeof(BranchInstruction))) BranchInstruction(list);
    else
-      instruction = new GenericInstruction(list);
+      instruction = new (m_instruction_cache->allocate(sizeof(GenericInstruction))) GenericInstruction(list);
 
    instruction->setAddress(va2pa(inst.sinst->addr));
    instruction->setSize(inst.sinst->size);
    instruction->setAtomic(dec_inst.is_atomic());
-   char disassembly[64];
-   dec_inst.disassembly_to_str(disassembly, sizeof(disassembly));  
-   instruction->setDisassembly(disassembly);
-   //printf("%s\n", instruction->getDisassembly().c_str());
+   // The decoded instruction stays in the cache, so disassembly is only formatted when a tracer asks for it
+   instruction->setDecodedInstruction(&dec_inst);
    
    const std::vector<const MicroOp*> *uops = InstructionDecoder::decode(inst.sinst->addr, &dec_inst, instruction);
    instruction->setMicroOps(uops);
@@ -538,10 +581,7 @@ const dl::DecodedInst* TraceThread::staticDecode(Sift::Instruction &inst)
 
 void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size)
 {
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   const dl::DecodedInst &dec_inst = *getDecodedInst(inst);
 
    // Warmup instruction caches
 
@@ -650,12 +690,9 @@ void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instr
 
    // Set up instruction
 
-   if (m_icache.count(inst.sinst->addr) == 0)
-      m_icache[inst.sinst->addr] = decode(inst);
-   // Here get the decoder instruction without checking, because we must have it for sure
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   Instruction *ins = getInstruction(inst);
+   const dl::DecodedInst &dec_inst = *getDecodedInst(inst);
 
-   Instruction *ins = m_icache[inst.sinst->addr];
    DynamicInstruction *dynins = prfmdl->createDynamicInstruction(ins, va2pa(inst.sinst->addr));
 
    // Add dynamic instruction info
@@ -778,6 +815,17 @@ void TraceThread::run()
    m_trace.initStream();
    m_trace_has_pa = m_trace.getTraceHasPhysicalAddresses();
 
+   // Instructions store their physical address: they can only be shared if va2pa() is the same for all threads of the application
+   if (m_trace_has_pa || m_appid_from_coreid)
+   {
+      m_instruction_cache = new TraceInstructionCache();
+      m_private_instruction_cache = true;
+   }
+   else
+   {
+      m_instruction_cache = Sim()->getTraceManager()->getInstructionCache(m_app_id);
+   }
+
    if (m_thread->getCore() == NULL)
    {
       // We didn't get scheduled on startup, wait here
@@ -28,6 +28,7 @@
 
 class Instruction;
 class DynamicInstruction;
+class TraceInstructionCache;
 
 class TraceThread : public Runnable
 {
@@ -59,11 +60,14 @@ class TraceThread : public Runnable
       bool m_appid_from_coreid;
       uint8_t m_address_randomization_table[256];
       bool m_stop;
+      // Entries of m_instruction_cache already used by this thread, looked up without taking its lock
       std::unordered_map<IntPtr, Instruction *> m_icache;
       //std::unordered_map<IntPtr, const xed_decoded_inst_t *> m_decoder_cache;  // TODO convert to DecoderLib
       //static bool xed_initialized;  // TODO convert to DecoderLib
       //xed_state_t m_xed_state_init;  // TODO convert to DecoderLib
       std::unordered_map<IntPtr, const dl::DecodedInst *> m_decoder_cache;  // TODO convert to DecoderLib
+      TraceInstructionCache *m_instruction_cache;
+      bool m_private_instruction_cache;
       UInt64 m_bbv_base;
       UInt64 m_bbv_count;
       UInt64 m_bbv_last;
@@ -116,6 +120,8 @@ class TraceThread : public Runnable
       void handleRoutineAnnounceFunc(uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename);
 
       Instruction* decode(Sift::Instruction &inst);
+      Instruction* getInstruction(Sift::Instruction &inst);
+      const dl::DecodedInst* getDecodedInst(Sift::Instruction &inst);
       void handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size);
       void handleInstructionDetailed(Sift::Instruction &inst, Sift::Instruction &next_inst, PerformanceModel *prfmdl);
       //void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const xed_decoded_inst_t &xed_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
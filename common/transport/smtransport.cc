@@ -3,11 +3,26 @@
 #include "smtransport.h"
 #include "config.h"
 #include "log.h"
+#include "stats.h"
+#include "timer.h"
+
+#include <stddef.h>
+#include <stdlib.h>
 
 // -- SmTransport -- //
 
 SmTransport::SmTransport()
 {
+   m_pools = new Pool [ Config::getSingleton()->getTotalCores() + 1 ];
+   for (UInt32 i = 0; i < Config::getSingleton()->getTotalCores() + 1; i++)
+   {
+      for (UInt32 j = 0; j < NUM_SIZE_CLASSES; j++)
+      {
+         m_pools[i].magazine[j] = NULL;
+         m_pools[i].returned[j] = NULL;
+      }
+   }
+
    m_global_node = new SmNode(-1, this);
    m_core_nodes = new SmNode* [ Config::getSingleton()->getTotalCores() ];
    for (UInt32 i = 0; i < Config::getSingleton()->getTotalCores(); i++)
@@ -23,6 +38,25 @@ SmTransport::~SmTransport()
 
    delete [] m_core_nodes;
    delete m_global_node;
+
+   // All nodes are gone, and with them every message that was still in an inbox
+   for (UInt32 i = 0; i < Config::getSingleton()->getTotalCores() + 1; i++)
+   {
+      for (UInt32 j = 0; j < NUM_SIZE_CLASSES; j++)
+      {
+         Message *lists[] = { m_pools[i].magazine[j], m_pools[i].returned[j] };
+         for (UInt32 k = 0; k < 2; k++)
+         {
+            while (lists[k])
+            {
+               Message *next = lists[k]->next;
+               free(lists[k]);
+               lists[k] = next;
+            }
+         }
+      }
+   }
+   delete [] m_pools;
 }
 
 Transport::Node* SmTransport::createNode(core_id_t core_id)
@@ -56,6 +90,29 @@ SmTransport::SmNode* SmTransport::getNodeFromId(core_id_t core_id)
    return m_core_nodes[core_id];
 }
 
+SmTransport::Pool* SmTransport::getPoolForId(core_id_t core_id)
+{
+   return core_id >= 0 ? &m_pools[core_id] : &m_pools[Config::getSingleton()->getTotalCores()];
+}
+
+void SmTransport::freeMessage(Message *message)
+{
+   if (message->size_class == UNPOOLED)
+      free(message);
+   else
+      push(&message->pool->returned[message->size_class], message);
+}
+
+void SmTransport::push(Message **list, Message *message)
+{
+   Message *head = __atomic_load_n(list, __ATOMIC_RELAXED);
+   do
+   {
+      message->next = head;
+   }
+   while (!__atomic_compare_exchange_n(list, &head, message, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+}
+
 void SmTransport::clearNodeForId(core_id_t core_id)
 {
    // This is called upon deletion of the node, so we should simply
@@ -68,74 +125,165 @@ void SmTransport::clearNodeForId(core_id_t core_id)
 
 SmTransport::SmNode::SmNode(core_id_t core_id, SmTransport *smt)
    : Node(core_id)
+   , m_inbox(NULL)
+   , m_pending(NULL)
+   , m_waiting(0)
+   , m_pool(smt->getPoolForId(core_id))
+   , m_msgs_sent(0)
+   , m_bytes_sent(0)
+   , m_buffers_allocated(0)
+   , m_buffers_reused(0)
+   , m_msgs_received(0)
+   , m_inbox_latency(0)
    , m_smt(smt)
 {
+   if (core_id >= 0)
+   {
+      registerStatsMetric("transport", core_id, "msgs-sent", &m_msgs_sent);
+      registerStatsMetric("transport", core_id, "bytes-sent", &m_bytes_sent);
+      registerStatsMetric("transport", core_id, "buffers-allocated", &m_buffers_allocated);
+      registerStatsMetric("transport", core_id, "buffers-reused", &m_buffers_reused);
+      registerStatsMetric("transport", core_id, "msgs-received", &m_msgs_received);
+      registerStatsMetric("transport", core_id, "inbox-latency-ns", &m_inbox_latency);
+   }
 }
 
 SmTransport::SmNode::~SmNode()
 {
-   LOG_ASSERT_WARNING(m_queue.empty(), "Unread messages in queue for core: %d", getCoreId());
+   LOG_ASSERT_WARNING(m_pending == NULL && m_inbox == NULL, "Unread messages in queue for core: %d", getCoreId());
    m_smt->clearNodeForId(getCoreId());
+
+   Message *lists[] = { m_pending, __atomic_exchange_n(&m_inbox, (Message*)NULL, __ATOMIC_ACQUIRE) };
+   for (UInt32 i = 0; i < 2; i++)
+   {
+      while (lists[i])
+      {
+         Message *next = lists[i]->next;
+         freeMessage(lists[i]);
+         lists[i] = next;
+      }
+   }
 }
 
 void SmTransport::SmNode::globalSend(SInt32 dest_proc, const void *buffer, UInt32 length)
 {
    LOG_ASSERT_ERROR(dest_proc == 0, "Destination other than zero: %d", dest_proc);
-   send((SmNode*)m_smt->getGlobalNode(), buffer, length);
+   send((SmNode*)m_smt->getGlobalNode(), buffer, length, NULL, 0, NULL, 0);
 }
 
 void SmTransport::SmNode::send(SInt32 dest_id, const void* buffer, UInt32 length)
+{
+   send(dest_id, buffer, length, NULL, 0, NULL, 0);
+}
+
+void SmTransport::SmNode::send(SInt32 dest_id, const void* header, UInt32 header_length, const void* payload, UInt32 payload_length, const void* trailer, UInt32 trailer_length)
 {
    SmNode *dest_node = m_smt->getNodeFromId(dest_id);
    LOG_ASSERT_ERROR(dest_node != NULL, "Attempt to send to non-existent node: %d", dest_id);
-   send(dest_node, buffer, length);
+   send(dest_node, header, header_length, payload, payload_length, trailer, trailer_length);
 }
 
-void SmTransport::SmNode::send(SmNode *dest_node, const void *buffer, UInt32 length)
+void SmTransport::SmNode::send(SmNode *dest_node, const void *header, UInt32 header_length, const void *payload, UInt32 payload_length, const void *trailer, UInt32 trailer_length)
 {
-   Byte *data = new Byte[length];
-   memcpy(data, buffer, length);
+   // The only copy a message makes on its way: into a pooled buffer that the receiver hands back through release()
+   Message *message = allocMessage(header_length + payload_length + trailer_length);
+   memcpy(message->data, header, header_length);
+   if (payload_length)
+      memcpy(message->data + header_length, payload, payload_length);
+   if (trailer_length)
+      memcpy(message->data + header_length + payload_length, trailer, trailer_length);
+   message->send_time = Timer::now();
 
-   LOG_PRINT("sending msg -- size: %i, data: %p, dest: %p", length, data, dest_node);
+   LOG_PRINT("sending msg -- size: %i, data: %p, dest: %p", message->length, message->data, dest_node);
 
-   dest_node->m_lock.acquire();
-   dest_node->m_queue.push(data);
-   dest_node->m_lock.release();
-   dest_node->m_cond.broadcast();
+   push(&dest_node->m_inbox, message);
+   // Pairs with recv(): either it sees the message in the inbox, or we see it waiting
+   if (__atomic_load_n(&dest_node->m_waiting, __ATOMIC_SEQ_CST))
+      dest_node->m_wakeup.signal();
 }
 
 Byte* SmTransport::SmNode::recv()
 {
    LOG_PRINT("attempting recv -- this: %p", this);
 
-   m_lock.acquire();
-
-   while (true)
+   while (m_pending == NULL)
    {
-      if (!m_queue.empty())
+      // The inbox is a stack, reverse it into arrival order
+      Message *inbox = __atomic_exchange_n(&m_inbox, (Message*)NULL, __ATOMIC_ACQUIRE);
+      while (inbox)
       {
-         Byte *data = m_queue.front();
-         m_queue.pop();
-         m_lock.release();
-
-         LOG_PRINT("msg recv'd -- data: %p, this: %p", data, this);
-
-         return data;
+         Message *next = inbox->next;
+         inbox->next = m_pending;
+         m_pending = inbox;
+         inbox = next;
       }
-      else
+
+      if (m_pending == NULL)
       {
-         m_cond.wait(m_lock);
+         m_wakeup.arm();
+         __atomic_store_n(&m_waiting, 1, __ATOMIC_SEQ_CST);
+         if (__atomic_load_n(&m_inbox, __ATOMIC_SEQ_CST) == NULL)
+            m_wakeup.wait();
+         __atomic_store_n(&m_waiting, 0, __ATOMIC_RELAXED);
       }
    }
+
+   Message *message = m_pending;
+   m_pending = message->next;
+
+   ++m_msgs_received;
+   m_inbox_latency += Timer::now() - message->send_time;
+
+   LOG_PRINT("msg recv'd -- data: %p, this: %p", message->data, this);
+
+   return message->data;
 }
 
 bool SmTransport::SmNode::query()
 {
-   bool result = false;
+   return m_pending != NULL || __atomic_load_n(&m_inbox, __ATOMIC_ACQUIRE) != NULL;
+}
 
-   m_lock.acquire();
-   result = !m_queue.empty();
-   m_lock.release();
+void SmTransport::SmNode::release(Byte *buffer)
+{
+   Message *message = (Message*)(buffer - offsetof(Message, data));
+   freeMessage(message);
+}
+
+SmTransport::Message* SmTransport::SmNode::allocMessage(UInt32 length)
+{
+   UInt32 size_class = 0;
+   while (size_class < NUM_SIZE_CLASSES && (1U << (size_class + MIN_CLASS_SHIFT)) < length)
+      size_class++;
+
+   ScopedLock sl(m_pool->lock);
+
+   ++m_msgs_sent;
+   m_bytes_sent += length;
+
+   Message *message = NULL;
+   if (size_class != UNPOOLED)
+   {
+      if (m_pool->magazine[size_class] == NULL)
+         m_pool->magazine[size_class] = __atomic_exchange_n(&m_pool->returned[size_class], (Message*)NULL, __ATOMIC_ACQUIRE);
+      message = m_pool->magazine[size_class];
+      if (message)
+      {
+         m_pool->magazine[size_class] = message->next;
+         ++m_buffers_reused;
+      }
+   }
+
+   if (message == NULL)
+   {
+      UInt32 capacity = size_class == UNPOOLED ? length : 1U << (size_class + MIN_CLASS_SHIFT);
+      message = (Message*)malloc(sizeof(Message) + capacity);
+      message->pool = m_pool;
+      message->size_class = size_class;
+      ++m_buffers_allocated;
+   }
 
-   return result;
+   message->next = NULL;
+   message->length = length;
+   return message;
 }
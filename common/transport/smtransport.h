@@ -1,13 +1,44 @@
 #ifndef SMTRANSPORT_H
 #define SMTRANSPORT_H
 
-#include <queue>
-
 #include "transport.h"
 #include "cond.h"
 
 class SmTransport : public Transport
 {
+private:
+   // Messages are pooled by the node that sends them, in power-of-two size classes.
+   // Larger messages are allocated and freed on their own.
+   static const UInt32 MIN_CLASS_SHIFT = 6;
+   static const UInt32 NUM_SIZE_CLASSES = 11;
+   static const UInt32 UNPOOLED = NUM_SIZE_CLASSES;
+
+   struct Pool;
+
+   struct Message
+   {
+      Message *next;       // Link in an inbox or a free list
+      Pool *pool;          // Pool this message returns to
+      UInt32 size_class;
+      UInt32 length;
+      UInt64 send_time;    // Host time in ns, for the inbox latency statistic
+      Byte data[];
+   };
+
+   // The pools belong to the transport rather than to the nodes: a message can still be queued,
+   // or held by its receiver, when the node that sent it is deleted.
+   // magazine is only used with lock held (several threads can send from one node),
+   // returned is where receivers give messages back without a lock.
+   struct Pool
+   {
+      Message *magazine[NUM_SIZE_CLASSES];
+      Message *returned[NUM_SIZE_CLASSES];
+      Lock lock;
+   };
+
+   static void freeMessage(Message *message);
+   static void push(Message **list, Message *message);
+
 public:
    SmTransport();
    ~SmTransport();
@@ -20,15 +51,32 @@ public:
 
       void globalSend(SInt32, const void*, UInt32);
       void send(core_id_t, const void*, UInt32);
+      void send(core_id_t, const void*, UInt32, const void*, UInt32, const void*, UInt32);
       Byte* recv();
       bool query();
+      void release(Byte*);
 
    private:
-      void send(SmNode *dest, const void *buffer, UInt32 length);
+      void send(SmNode *dest, const void *header, UInt32 header_length, const void *payload, UInt32 payload_length, const void *trailer, UInt32 trailer_length);
+
+      Message* allocMessage(UInt32 length);
+
+      // Any thread pushes onto the inbox without a lock, the single receiving thread takes over
+      // the whole inbox at once and keeps it in m_pending in arrival order.
+      Message *m_inbox;
+      Message *m_pending;
+      volatile int m_waiting;
+      WakeupEvent m_wakeup;
+
+      Pool *m_pool;
+
+      UInt64 m_msgs_sent;
+      UInt64 m_bytes_sent;
+      UInt64 m_buffers_allocated;
+      UInt64 m_buffers_reused;
+      UInt64 m_msgs_received;
+      UInt64 m_inbox_latency;
 
-      std::queue<Byte*> m_queue;
-      Lock m_lock;
-      ConditionVariable m_cond;
       SmTransport *m_smt;
    };
 
@@ -40,8 +88,10 @@ public:
 private:
    Node *m_global_node;
    SmNode **m_core_nodes;
+   Pool *m_pools;          // One per core, followed by the one of the global node
 
    SmNode *getNodeFromId(core_id_t core_id);
+   Pool *getPoolForId(core_id_t core_id);
    void clearNodeForId(core_id_t core_id);
 };
 
@@ -17,8 +17,12 @@ public:
 
       virtual void globalSend(SInt32 dest_proc, const void *buffer, UInt32 length) = 0;
       virtual void send(core_id_t dest, const void *buffer, UInt32 length) = 0;
+      // Send header, payload and trailer as one message, without joining them first
+      virtual void send(core_id_t dest, const void *header, UInt32 header_length, const void *payload, UInt32 payload_length, const void *trailer, UInt32 trailer_length) = 0;
       virtual Byte* recv() = 0;
       virtual bool query() = 0;
+      // Give back a buffer returned by recv() once done with it
+      virtual void release(Byte *buffer) = 0;
 
    protected:
       core_id_t getCoreId();
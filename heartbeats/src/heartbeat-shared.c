@@ -192,7 +192,7 @@ int64_t heartbeat( heartbeat_t* hb, int tag )
     pthread_mutex_lock(&hb->mutex);
     //printf("Registering Heartbeat\n");
     old_last_time = hb->last_timestamp;
-    time = SimUser(0x123, 1) / 1000000; // get fs time and convert to ns
+    time = SimHeartbeat(tag) / 1000000; // report the beat to the scheduler, returns the fs time: convert to ns
 
     // TODO - parse with gmtime(), to see if value is valid timestamp?
     //      - Maybe simpler parse method to minimize perf impact of beats.
@@ -11,24 +11,7 @@ Works by registering a PRE_STAT_WRITE hook, which, before a stats snapshot write
 import sys
 import os
 import sim
-
-
-def build_dvfs_table(tech):
-    # Build a table of (frequency, voltage) pairs.
-    # Frequencies should be from high to low, and end with zero (or the lowest possible frequency)
-    if tech <= 22:
-        # Even technology nodes smaller than 22nm should use the DVFS levels of 22nm.
-        # This is the voltage reported to McPAT.
-        # McPAT does not support technology nodes smaller than 22nm and is operated at 22nm.
-        # The scaling is then done in tools/mcpat.py.
-        def v(f):
-            return 0.6 + f / 4000.0 * 0.8
-        return [(f, v(f)) for f in reversed(range(0, 4000+1, 100))]
-    elif tech == 45:
-        return [(2000, 1.2), (1800, 1.1), (1500, 1.0), (1000, 0.9), (0, 0.8)]
-    else:
-        raise ValueError(
-            'No DVFS table available for %d nm technology node' % tech)
+from dvfs_table import build_dvfs_table
 
 
 class Power:
@@ -60,6 +43,15 @@ class EnergyStats:
         self.in_stats_write = False
         self.power = {}
         self.energy = {}
+        # With the native power model, the open scheduler computes power and provides the energy statistics.
+        # McPAT is not run, but the performance counter logs (frequency, vdd, CPI stack) are still written,
+        # in-process by the same code mcpat.py uses.
+        self.native_power = sim.config.get('power/model') == 'native'
+        if self.native_power:
+            sys.path.append(os.path.join(os.getenv('SNIPER_ROOT'), 'tools'))
+            import mcpat
+            self.mcpat = mcpat
+            return
         for metric in ('energy-static', 'energy-dynamic'):
             for core in range(sim.config.ncores):
                 sim.stats.register('core', core, metric, self.get_stat)
@@ -78,7 +70,7 @@ class EnergyStats:
         self.update()
 
     def hook_pre_stat_write(self, prefix):
-        if not self.in_stats_write:
+        if not self.in_stats_write and not self.native_power:
             self.update()
 
     def hook_sim_end(self):
@@ -97,7 +89,8 @@ class EnergyStats:
         #   If we also have a previous snapshot: update power
         if self.name_last:
             power = self.run_power(self.name_last, current)
-            self.update_power(power)
+            if not self.native_power:
+                self.update_power(power)
         #   Clean up previous last
         if self.name_last:
             sim.util.db_delete(self.name_last)
@@ -163,6 +156,11 @@ vdd[] = %s
 
         configfile = self.gen_config(outputbase)
 
+        if self.native_power:
+            results = self.mcpat.get_partial_results(None, sim.config.output_dir, configfile, [name0, name1])
+            self.mcpat.log_performance_counters(results)
+            return None
+
         os.system('unset PYTHONHOME; %s -d %s -o %s -c %s --partial=%s:%s --no-graph --no-text' % (
             os.path.join(os.getenv('SNIPER_ROOT'), 'tools/mcpat.py'),
             sim.config.output_dir,
@@ -105,6 +105,24 @@ class StatsDelta:
         self.delta = now - self.last
       self.last = now
 
+  class StatsDeltaVectorMetric:
+    """Internal object to store current, last and delta stats values for all cores.
+
+    Do not instantiate directly, use StatsDelta.getter_vector() instead."""
+    def __init__(self, objectName, metricName, count):
+      if count is None:
+        self.getter = sim.stats.getter_vector(objectName, metricName)
+      else:
+        self.getter = sim.stats.getter_vector(objectName, metricName, count)
+      self.last = None
+      self.delta = None
+
+    def update(self):
+      now = self.getter()
+      if self.last is not None:
+        self.delta = [ float(n - l) for n, l in zip(now, self.last) ]
+      self.last = now
+
   def __init__(self):
     self.isFirst = True
     self.members = []
@@ -120,6 +138,13 @@ class StatsDelta:
     self.members.append(get)
     return get
 
+  # Vector version of getter(): one call retrieves the statistic for all cores (indices 0 .. count-1, default all cores).
+  # Its .last and .delta are lists, indices without this statistic read as zero.
+  def getter_vector(self, objectName, metricName, count = None):
+    getter = self.StatsDeltaVectorMetric(objectName, metricName, count)
+    self.members.append(getter)
+    return getter
+
   def update(self):
     for member in self.members:
       member.update()
@@ -198,12 +223,8 @@ class EveryIns:
 have_deleted_stats = False
 def db_delete(prefix, in_sim_end = False):
   global have_deleted_stats
-  cursor = sim.stats.db.cursor()
-  prefixid = sim.stats.db.execute('SELECT prefixid FROM prefixes WHERE prefixname = ?', (prefix,)).fetchall()
-  if prefixid:
-    cursor.execute('DELETE FROM prefixes WHERE prefixid = ?', (prefixid[0][0],))
-    cursor.execute('DELETE FROM `values` WHERE prefixid = ?', (prefixid[0][0],))
-  sim.stats.db.commit()
+  # Also drops the snapshot from sim.stats.columns, compacting it when enough snapshots have been deleted
+  sim.stats.delete(prefix)
   if not have_deleted_stats:
     if in_sim_end:
       # We shouldn't be registering a new sim_end hook while in sim_end
@@ -44,9 +44,9 @@ class StatTrace:
 
     self.sd = sim.util.StatsDelta()
     self.stats = {
-      'time': [ self.getStatsGetter('performance_model', core, 'elapsed_time') for core in range(sim.config.ncores) ],
-      'ffwd_time': [ self.getStatsGetter('fastforward_performance_model', core, 'fastforwarded_time') for core in range(sim.config.ncores) ],
-      'stat': [ self.getStatsGetter(stat_component, core, stat_name) for core in range(sim.config.ncores) ],
+      'time': self.getStatsGetter('performance_model', 'elapsed_time'),
+      'ffwd_time': self.getStatsGetter('fastforward_performance_model', 'fastforwarded_time'),
+      'stat': self.getStatsGetter(stat_component, stat_name),
     }
     sim.util.Every(interval_ns * sim.util.Time.NS, self.periodic, statsdelta = self.sd, roi_only = True)
 
@@ -55,20 +55,20 @@ class StatTrace:
       self.fd.write('[STAT:%s] ' % self.stat_name)
     self.fd.write('%u' % (time / 1e6)) # Time in ns
     for core in range(sim.config.ncores):
-      timediff = (self.stats['time'][core].delta - self.stats['ffwd_time'][core].delta) / 1e6 # Time in ns
-      statdiff = self.stats['stat'][core].delta
+      timediff = (self.stats['time'].delta[core] - self.stats['ffwd_time'].delta[core]) / 1e6 # Time in ns
+      statdiff = self.stats['stat'].delta[core]
       value = statdiff / (timediff or 1) # Avoid division by zero
       self.fd.write(' %.3f' % value)
     self.fd.write('\n')
 
-  def getStatsGetter(self, component, core, metric):
+  def getStatsGetter(self, component, metric):
     # Some components don't exist (i.e. DRAM reads on cores that don't have a DRAM controller),
-    # return a special object that always returns 0 in these cases
+    # these read as 0. Return a special object that always returns 0 if no core has the component.
     try:
-      return self.sd.getter(component, core, metric)
-    except:
+      return self.sd.getter_vector(component, metric, sim.config.ncores)
+    except ValueError:
       class Zero():
-        def __init__(self): self.delta = 0
+        def __init__(self): self.delta = [ 0 ] * sim.config.ncores
         def update(self): pass
       return Zero()
 
@@ -35,6 +35,7 @@ extern KNOB<BOOL> KnobRoutineTracingOutsideDetailed;
 extern KNOB<BOOL> KnobDebug;
 extern KNOB<BOOL> KnobVerbose;
 extern KNOB<UINT64> KnobStopAddress;
+extern KNOB<BOOL>   KnobChunkedCompression;
 extern KNOB<UINT64> KnobMaxThreads;
 extern KNOB<UINT64> KnobExtraePreLoaded;
 
@@ -18,6 +18,13 @@
 # define SIFT_USE_ZLIB 1
 #endif
 
+// PinCRT does not provide std::thread, so the recorder's copy of libsift decompresses on the calling thread
+#if defined(PIN_CRT)
+# define SIFT_USE_THREADS 0
+#else
+# define SIFT_USE_THREADS 1
+#endif
+
 namespace Sift
 {
 
@@ -42,8 +49,19 @@ namespace Sift
       ArchIA32 = 2,
       IcacheVariable = 4,
       PhysicalAddress = 8,
+      CompressionZlibChunked = 16,
    } Option;
 
+   // With CompressionZlibChunked, the data following the header is a sequence of independently compressed chunks,
+   // so they can be inflated in parallel or skipped over without decompressing them. A chunk of size zero ends the stream.
+   // Readers that do not know this option refuse the trace as having unrecognized options, so writers only use it
+   // when asked to (record-trace --chunked-compression), and use CompressionZlib otherwise.
+   typedef struct
+   {
+      uint32_t size;             //< Size of the compressed data following this header, in bytes
+      uint32_t uncompressed_size;
+   } __attribute__ ((__packed__)) ChunkHeader;
+
    typedef union
    {
       // Simple format for common instructions
@@ -47,6 +47,7 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
    , icache()
    , m_id(id)
    , m_trace_has_pa(false)
+   , m_decompression_threads(2)
    , m_seen_end(false)
    , m_last_sinst(NULL)
    , m_isa(0)
@@ -120,11 +121,21 @@ bool Sift::Reader::initStream()
 #if SIFT_USE_ZLIB
    if (hdr.options & CompressionZlib)
    {
+#if SIFT_USE_THREADS
+      // Inflate ahead of the simulator on a background thread
+      input = new ireadaheadstream(new izstream(input));
+#else
       input = new izstream(input);
+#endif
       hdr.options &= ~CompressionZlib;
    }
+   if (hdr.options & CompressionZlibChunked)
+   {
+      input = new ichunkzstream(input, SIFT_USE_THREADS ? m_decompression_threads : 0);
+      hdr.options &= ~CompressionZlibChunked;
+   }
 #else
-   if (hdr.options & CompressionZlib)
+   if (hdr.options & (CompressionZlib | CompressionZlibChunked))
    {
       std::cerr << "[SIFT:" << m_id << "] Error: Compression requested, but disabled at compile time.\n";
    }
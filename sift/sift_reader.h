@@ -98,6 +98,9 @@ namespace Sift
          uint32_t m_id;
 
          bool m_trace_has_pa;
+
+         // Worker threads inflating the chunks of a CompressionZlibChunked trace
+         unsigned int m_decompression_threads;
          bool m_seen_end;
          const StaticInstruction *m_last_sinst;
          
@@ -117,6 +120,8 @@ namespace Sift
          bool Read(Instruction&);
          bool AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op, uint64_t d_addr, uint8_t *data_buffer, uint32_t data_size);
 
+         // Takes effect on the next initStream(), 0 inflates on the thread calling Read()
+         void setDecompressionThreads(unsigned int threads) { m_decompression_threads = threads; }
          void setHandleInstructionCountFunc(HandleInstructionCountFunc func, void* arg = NULL) { handleInstructionCountFunc = func; handleInstructionCountArg = arg; }
          void setHandleCacheOnlyFunc(HandleCacheOnlyFunc func, void* arg = NULL) { handleCacheOnlyFunc = func; handleCacheOnlyArg = arg; }
          void setHandleOutputFunc(HandleOutputFunc func, void* arg = NULL) { handleOutputFunc = func; handleOutputArg = arg; }
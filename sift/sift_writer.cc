@@ -35,7 +35,7 @@ __sift_assert_fail(__const char *__assertion, __const char *__file,
 }
 
 
-Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data)
+Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data, bool useChunkedCompression)
    : response(NULL)
    , getCodeFunc(getCodeFunc)
    , getCodeFunc2(getCodeFunc2)
@@ -60,8 +60,9 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
 
    uint64_t options = 0;
 #if SIFT_USE_ZLIB
+   // Readers that predate CompressionZlibChunked cannot open chunked traces, so it has to be asked for
    if (useCompression)
-      options |= CompressionZlib;
+      options |= useChunkedCompression ? CompressionZlibChunked : CompressionZlib;
 #else
    if (useCompression) {
       std::cerr << "[SIFT:" << m_id << "] Warning: Compression disabled, ignoring request.\n";
@@ -93,6 +94,8 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
 
    if (options & CompressionZlib)
       output = new ozstream(output);
+   else if (options & CompressionZlibChunked)
+      output = new ochunkzstream(output);
 }
 
 // Modified from http://stackoverflow.com/questions/2203159/is-there-a-c-equivalent-to-getcwd
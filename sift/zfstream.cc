@@ -1,6 +1,9 @@
 #include "zfstream.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <iostream>
 
 #if !SIFT_USE_ZLIB
 
@@ -22,11 +25,32 @@ void ozstream::doCompress(bool finish)
 {
 }
 
+ochunkzstream::ochunkzstream(vostream *output)
+   : output(output)
+   , used(0)
+   , m_fail(true)
+{
+   std::cerr << "[SIFT] Error: Chunked compression requested, but zlib was disabled at compile time.\n";
+}
+
+ochunkzstream::~ochunkzstream()
+{
+}
+
+void ochunkzstream::write(const char* s, std::streamsize n)
+{
+}
+
+void ochunkzstream::doCompress()
+{
+}
+
 izstream::izstream(vistream *input)
    : input(input)
    , m_eof(false)
    , m_fail(false)
    , peek_valid(false)
+   , m_gcount(0)
 {
 }
 
@@ -43,6 +67,31 @@ int izstream::peek()
    return 0;
 }
 
+ichunkzstream::ichunkzstream(vistream *input, unsigned int num_threads)
+   : input(input)
+   , m_next_read(0)
+   , m_next_consume(0)
+   , m_current(NULL)
+   , m_offset(0)
+   , m_input_done(false)
+   , m_fail(true)
+{
+   std::cerr << "[SIFT] Error: Chunked compression found, but zlib was disabled at compile time.\n";
+}
+
+ichunkzstream::~ichunkzstream()
+{
+}
+
+void ichunkzstream::read(char* s, std::streamsize n)
+{
+}
+
+int ichunkzstream::peek()
+{
+   return 0;
+}
+
 #else /*SIFT_USE_ZLIB*/
 
 #include <zlib.h>
@@ -91,11 +140,57 @@ void ozstream::doCompress(bool finish)
 
 
 
+ochunkzstream::ochunkzstream(vostream *output)
+   : output(output)
+   , buffer(chunksize)
+   , compressed(compressBound(chunksize))
+   , used(0)
+   , m_fail(false)
+{
+}
+
+ochunkzstream::~ochunkzstream()
+{
+   if (used)
+      doCompress();
+   Sift::ChunkHeader end = { 0, 0 };
+   output->write(reinterpret_cast<char*>(&end), sizeof(end));
+   delete output;
+}
+
+void ochunkzstream::write(const char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      size_t count = std::min(size_t(n), chunksize - used);
+      memcpy(&buffer[used], s, count);
+      used += count;
+      s += count;
+      n -= count;
+      if (used == chunksize)
+         doCompress();
+   }
+}
+
+void ochunkzstream::doCompress()
+{
+   uLongf size = compressed.size();
+   int ret = compress2((Bytef*)compressed.data(), &size, (const Bytef*)buffer.data(), used, level);
+   assert(ret == Z_OK);
+   Sift::ChunkHeader hdr = { uint32_t(size), uint32_t(used) };
+   output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   output->write(compressed.data(), size);
+   used = 0;
+}
+
+
+
 izstream::izstream(vistream *input)
    : input(input)
    , m_eof(false)
    , m_fail(false)
    , peek_valid(false)
+   , m_gcount(0)
 {
    zstream.zalloc = Z_NULL;
    zstream.zfree = Z_NULL;
@@ -114,6 +209,7 @@ izstream::~izstream()
 
 void izstream::read(char* s, std::streamsize n)
 {
+   m_gcount = n;
    if (peek_valid)
    {
       s[0] = peek_value;
@@ -140,6 +236,7 @@ void izstream::read(char* s, std::streamsize n)
          m_eof = true;
          if (zstream.avail_out)
          {
+            m_gcount -= zstream.avail_out;
             m_fail = true;
             return;
          }
@@ -159,4 +256,292 @@ int izstream::peek()
    return peek_value;
 }
 
+
+
+ichunkzstream::ichunkzstream(vistream *input, unsigned int num_threads)
+   : input(input)
+   , slots(num_threads ? 2 * num_threads : 1)
+   , m_next_read(0)
+   , m_next_consume(0)
+   , m_current(NULL)
+   , m_offset(0)
+   , m_input_done(false)
+   , m_fail(false)
+{
+#if SIFT_USE_THREADS
+   m_stop = false;
+   for (unsigned int i = 0 ; i < num_threads ; ++i)
+      m_workers.push_back(std::thread(&ichunkzstream::worker, this));
+#endif
+}
+
+ichunkzstream::~ichunkzstream()
+{
+#if SIFT_USE_THREADS
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+      m_free_cond.notify_all();
+   }
+   for (std::vector<std::thread>::iterator it = m_workers.begin() ; it != m_workers.end() ; ++it)
+      it->join();
+#endif
+   delete input;
+}
+
+bool ichunkzstream::readChunk(Sift::ChunkHeader &hdr, std::vector<char> &compressed)
+{
+   input->read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (input->fail())
+      return false;
+   if (hdr.size == 0)
+      return true;
+   compressed.resize(hdr.size);
+   input->read(compressed.data(), hdr.size);
+   return !input->fail();
+}
+
+void ichunkzstream::inflateChunk(const Sift::ChunkHeader &hdr, const std::vector<char> &compressed, Chunk &chunk)
+{
+   chunk.data.resize(hdr.uncompressed_size);
+   uLongf size = hdr.uncompressed_size;
+   int ret = uncompress((Bytef*)chunk.data.data(), &size, (const Bytef*)compressed.data(), hdr.size);
+   chunk.error = (ret != Z_OK || size != hdr.uncompressed_size);
+   chunk.last = chunk.error;
+   chunk.size = chunk.error ? 0 : size;
+}
+
+#if SIFT_USE_THREADS
+void ichunkzstream::worker()
+{
+   std::vector<char> compressed;
+   std::unique_lock<std::mutex> lock(m_mutex);
+   while (true)
+   {
+      m_free_cond.wait(lock, [this] { return m_stop || m_input_done || m_next_read - m_next_consume < slots.size(); });
+      if (m_stop || m_input_done)
+         break;
+
+      // Reading the input is sequential, only inflating runs in parallel
+      Chunk &chunk = slot(m_next_read++);
+      Sift::ChunkHeader hdr;
+      bool ok = readChunk(hdr, compressed);
+      if (!ok || hdr.size == 0)
+      {
+         m_input_done = true;
+         chunk.size = 0;
+         chunk.last = true;
+         chunk.error = !ok;
+         chunk.ready = true;
+         m_ready_cond.notify_all();
+         m_free_cond.notify_all();
+         break;
+      }
+
+      lock.unlock();
+      inflateChunk(hdr, compressed, chunk);
+      lock.lock();
+      chunk.ready = true;
+      m_ready_cond.notify_all();
+   }
+}
+#endif
+
+bool ichunkzstream::nextChunk()
+{
+   if (m_current && m_current->last)
+      return false;
+   m_offset = 0;
+
+#if SIFT_USE_THREADS
+   if (!m_workers.empty())
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_current)
+      {
+         m_current->ready = false;
+         ++m_next_consume;
+         m_free_cond.notify_one();
+      }
+      m_current = &slot(m_next_consume);
+      m_ready_cond.wait(lock, [this] { return m_current->ready; });
+      return !m_current->last;
+   }
+#endif
+
+   m_current = &slots[0];
+   Sift::ChunkHeader hdr;
+   bool ok = readChunk(hdr, m_compressed);
+   if (ok && hdr.size != 0)
+   {
+      inflateChunk(hdr, m_compressed, *m_current);
+   }
+   else
+   {
+      m_current->size = 0;
+      m_current->last = true;
+      m_current->error = !ok;
+   }
+   return !m_current->last;
+}
+
+void ichunkzstream::read(char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      if (!m_current || m_offset == m_current->size)
+      {
+         if (!nextChunk())
+         {
+            m_fail = true;
+            return;
+         }
+      }
+      size_t count = std::min(size_t(n), m_current->size - m_offset);
+      memcpy(s, &m_current->data[m_offset], count);
+      m_offset += count;
+      s += count;
+      n -= count;
+   }
+}
+
+int ichunkzstream::peek()
+{
+   if (!m_current || m_offset == m_current->size)
+   {
+      if (!nextChunk())
+      {
+         m_fail = true;
+         return EOF;
+      }
+   }
+   return m_current->data[m_offset];
+}
+
 #endif /*SIFT_USE_ZLIB*/
+
+
+
+#if SIFT_USE_THREADS
+
+ireadaheadstream::ireadaheadstream(izstream *input)
+   : input(input)
+   , blocks(new Block[numblocks])
+   , m_head(0)
+   , m_tail(0)
+   , m_stop(false)
+   , m_producer_waiting(false)
+   , m_consumer_waiting(false)
+   , m_current(NULL)
+   , m_offset(0)
+   , m_fail(false)
+{
+   m_thread = std::thread(&ireadaheadstream::producer, this);
+}
+
+ireadaheadstream::~ireadaheadstream()
+{
+   m_stop = true;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_cond.notify_all();
+   }
+   m_thread.join();
+   delete [] blocks;
+   delete input;
+}
+
+void ireadaheadstream::wake(std::atomic<bool> &waiting)
+{
+   // The sleeper sets its flag before re-checking head or tail, so either it sees our update or we see its flag
+   if (waiting)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_cond.notify_all();
+   }
+}
+
+void ireadaheadstream::producer()
+{
+   while (true)
+   {
+      uint64_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail - m_head == numblocks)
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_producer_waiting = true;
+         m_cond.wait(lock, [this, tail] { return m_stop || tail - m_head < numblocks; });
+         m_producer_waiting = false;
+      }
+      if (m_stop)
+         break;
+
+      Block &block = blocks[tail % numblocks];
+      input->read(block.data, sizeof(block.data));
+      block.last = input->fail();
+      block.size = block.last ? input->gcount() : sizeof(block.data);
+      m_tail = tail + 1;
+      wake(m_consumer_waiting);
+      if (block.last)
+         break;
+   }
+}
+
+bool ireadaheadstream::nextBlock()
+{
+   if (m_current)
+   {
+      if (m_current->last)
+         return false;
+      m_head = m_head.load(std::memory_order_relaxed) + 1;
+      wake(m_producer_waiting);
+   }
+
+   uint64_t head = m_head.load(std::memory_order_relaxed);
+   if (m_tail == head)
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_consumer_waiting = true;
+      m_cond.wait(lock, [this, head] { return m_tail != head; });
+      m_consumer_waiting = false;
+   }
+   m_current = &blocks[head % numblocks];
+   m_offset = 0;
+   return true;
+}
+
+void ireadaheadstream::read(char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      if (!m_current || m_offset == m_current->size)
+      {
+         if (!nextBlock())
+         {
+            m_fail = true;
+            return;
+         }
+         continue;
+      }
+      size_t count = std::min(size_t(n), m_current->size - m_offset);
+      memcpy(s, &m_current->data[m_offset], count);
+      m_offset += count;
+      s += count;
+      n -= count;
+   }
+}
+
+int ireadaheadstream::peek()
+{
+   while (!m_current || m_offset == m_current->size)
+   {
+      if (!nextBlock())
+      {
+         m_fail = true;
+         return EOF;
+      }
+   }
+   return m_current->data[m_offset];
+}
+
+#endif /*SIFT_USE_THREADS*/
@@ -7,10 +7,19 @@
 #include <istream>
 #include <fstream>
 
+#include <vector>
+
 #if SIFT_USE_ZLIB
 # include <zlib.h>
 #endif
 
+#if SIFT_USE_THREADS
+# include <atomic>
+# include <condition_variable>
+# include <mutex>
+# include <thread>
+#endif
+
 class vostream
 {
    public:
@@ -65,6 +74,31 @@ class ozstream : public vostream
 };
 
 
+class ochunkzstream : public vostream
+{
+   private:
+      vostream *output;
+      // Chunks are compressed independently, at a fast level: decompression is what limits trace-driven simulation
+      static const size_t chunksize = 1024*1024;
+      static const int level = 1;
+      std::vector<char> buffer;
+      std::vector<char> compressed;
+      size_t used;
+      bool m_fail;
+      void doCompress();
+   public:
+      ochunkzstream(vostream *output);
+      virtual ~ochunkzstream();
+      virtual void write(const char* s, std::streamsize n);
+      virtual void flush()
+         { output->flush(); }
+      virtual bool fail()
+         { return m_fail || output->fail(); }
+      virtual bool is_open()
+         { return output->is_open(); }
+};
+
+
 
 class vistream
 {
@@ -105,6 +139,7 @@ class izstream : public vistream
       char buffer[chunksize];
       char peek_value;
       bool peek_valid;
+      std::streamsize m_gcount;
    public:
       izstream(vistream *input);
       virtual ~izstream();
@@ -112,6 +147,95 @@ class izstream : public vistream
       virtual int peek();
       virtual bool eof() const { return m_eof; }
       virtual bool fail() const { return m_fail; }
+      // Number of bytes returned by the last read, which is short only at the end of the stream
+      std::streamsize gcount() const { return m_gcount; }
+};
+
+// Reads the chunked format written by ochunkzstream. Worker threads take turns reading the next compressed chunk
+// from the input and inflate it into a ring of slots, which the consumer drains in order.
+// Without worker threads, chunks are inflated on demand by the consumer.
+class ichunkzstream : public vistream
+{
+   private:
+      struct Chunk
+      {
+         std::vector<char> data;
+         size_t size;
+         bool ready;
+         bool last;  //< End of the stream, or a chunk that could not be read
+         bool error;
+         Chunk() : size(0), ready(false), last(false), error(false) {}
+      };
+
+      vistream *input;
+      std::vector<Chunk> slots;
+      uint64_t m_next_read;
+      uint64_t m_next_consume;
+      Chunk *m_current;
+      size_t m_offset;
+      bool m_input_done;
+      bool m_fail;
+      std::vector<char> m_compressed;
+#if SIFT_USE_THREADS
+      bool m_stop;
+      std::mutex m_mutex;
+      std::condition_variable m_ready_cond;
+      std::condition_variable m_free_cond;
+      std::vector<std::thread> m_workers;
+      void worker();
+#endif
+
+      Chunk& slot(uint64_t index) { return slots[index % slots.size()]; }
+      bool readChunk(Sift::ChunkHeader &hdr, std::vector<char> &compressed);
+      static void inflateChunk(const Sift::ChunkHeader &hdr, const std::vector<char> &compressed, Chunk &chunk);
+      bool nextChunk();
+   public:
+      ichunkzstream(vistream *input, unsigned int num_threads);
+      virtual ~ichunkzstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool fail() const { return m_fail; }
 };
 
+#if SIFT_USE_THREADS
+// Runs a (decompressing) input stream ahead of the consumer on a background thread, which fills a bounded
+// single-producer, single-consumer ring of blocks. Head and tail are only touched once per block,
+// and the mutex is only taken when one side has to sleep.
+class ireadaheadstream : public vistream
+{
+   private:
+      struct Block
+      {
+         char data[64*1024];
+         size_t size;
+         bool last;
+      };
+      static const uint64_t numblocks = 16;
+
+      izstream *input;
+      Block *blocks;
+      std::atomic<uint64_t> m_head;  //< Blocks released by the consumer
+      std::atomic<uint64_t> m_tail;  //< Blocks published by the producer
+      std::atomic<bool> m_stop;
+      std::atomic<bool> m_producer_waiting;
+      std::atomic<bool> m_consumer_waiting;
+      std::mutex m_mutex;
+      std::condition_variable m_cond;
+      std::thread m_thread;
+      Block *m_current;
+      size_t m_offset;
+      bool m_fail;
+
+      void producer();
+      void wake(std::atomic<bool> &waiting);
+      bool nextBlock();
+   public:
+      ireadaheadstream(izstream *input);
+      virtual ~ireadaheadstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool fail() const { return m_fail; }
+};
+#endif
+
 #endif // __ZFSTREAM_H
@@ -7,5 +7,5 @@ RESULTS_FOLDER = os.path.join(SNIPER, 'results')
 NUMBER_CORES = 4
 SNIPER_CONFIG = 'gainestown'
 ENABLE_HEARTBEATS = True
-# SCRIPTS = ['magic_timestamp', 'magic_perforation_rate:0,0,0'] # for running with heartbeats and no perforation active. 
-SCRIPTS = ['magic_timestamp']
+# SCRIPTS = ['magic_perforation_rate:0,0,0'] # for running with no perforation active.
+SCRIPTS = [] # heartbeats are reported to the scheduler with SIM_CMD_HEARTBEAT, scripts/magic_timestamp.py is no longer needed
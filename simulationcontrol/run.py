@@ -1,4 +1,6 @@
+import concurrent.futures
 import datetime
+import json
 import math
 import os
 import gzip
@@ -7,6 +9,7 @@ import random
 import re
 import shutil
 import subprocess
+import tempfile
 import time
 import traceback
 import sys
@@ -19,52 +22,92 @@ HERE = os.path.dirname(os.path.abspath(__file__))
 SNIPER_BASE = os.path.dirname(HERE)
 BENCHMARKS = os.path.join(SNIPER_BASE, 'benchmarks')
 BATCH_START = datetime.datetime.now().strftime('%Y-%m-%d_%H.%M')
-
-
-def change_base_configuration(base_configuration):
-    base_cfg = os.path.join(SNIPER_BASE, 'config/base.cfg')
-    with open(base_cfg, 'r') as f:
-        content = f.read()
-    with open(base_cfg, 'w') as f:
-        for line in content.splitlines():
+BASE_CFG = os.path.join(SNIPER_BASE, 'config/base.cfg')
+RESULTS_INDEX = os.path.join(RESULTS_FOLDER, 'index.jsonl')
+
+
+def base_configuration_overlay(base_configuration, filename):
+    '''Write a config file that selects the lines of base.cfg tagged with "cfg:<name>" for base_configuration,
+    base.cfg itself is not modified.
+
+    Every key that has tagged lines is written with the value base.cfg would have if its unselected tagged lines
+    were commented out and its selected ones uncommented, which is usually an untagged default above them.
+    Relative paths in base.cfg are resolved against benchmarks/, which used to be the working directory of a run.'''
+    section = None
+    keys = []  # (section, key) in order of appearance
+    tagged = set()
+    active = set()  # keys set by an uncommented line of base.cfg as it is on disk
+    values = {}  # last value of each key once the tags are applied
+    with open(BASE_CFG, 'r') as f:
+        for line in f.read().splitlines():
+            m = re.match(r'^\[(.*)\]', line)
+            if m:
+                section = m.group(1)
+                continue
+            included = line[:1] != '#'
+            if '=' not in line:
+                continue
+            key = (section, line.lstrip('#').split('=')[0].strip())
+            if key not in keys:
+                keys.append(key)
+            if included:
+                active.add(key)
             m = re.match('.*cfg:(!?)([a-zA-Z_\\.0-9]+)$', line)
             if m:
                 inverted = m.group(1) == '!'
                 include = inverted ^ (m.group(2) in base_configuration)
-                included = line[0] != '#'
                 if include and not included:
                     line = line[1:]
-                elif not include and included:
-                    line = '#' + line
-            f.write(line)
-            f.write('\n')
-
+                included = include
+                tagged.add(key)
+            if included:
+                values[key] = line.split('=', 1)[1].split('#')[0].strip()
+
+    overlay = []
+    for key in keys:
+        if key in tagged and key not in values and key in active:
+            raise ValueError('base.cfg: [{}] {} is set by default, but has no value without its tag; '
+                             'add an untagged default above the tagged lines'.format(*key))
+        if key not in values:
+            continue
+        value = values[key]
+        if value.startswith(('../', './')):
+            value = os.path.normpath(os.path.join(BENCHMARKS, value))
+        elif key not in tagged:
+            continue
+        overlay.append((key, value))
 
-def prev_run_cleanup():
-    '''Cleanup files potentially left over from aborted previous runs.'''
+    with open(filename, 'w') as f:
+        f.write('# base.cfg overlay for {}\n'.format('+'.join(base_configuration)))
+        section = None
+        for key, value in sorted(overlay, key=lambda kv: [k[0] for k in keys].index(kv[0][0])):
+            if key[0] != section:
+                section = key[0]
+                f.write('[{}]\n'.format(section))
+            f.write('{} = {}\n'.format(key[1], value))
 
-    pattern = r"^\d+\.hb.log$" # Heartbeat logs
-    for f in os.listdir(BENCHMARKS):
-        if not re.match(pattern, f):
-            continue
 
-        file_path = os.path.join(BENCHMARKS, f)
-        if os.path.isfile(file_path):
-            os.remove(file_path)
+def append_to_index(record):
+    '''Append one finished run to the results index (one JSON object per line).'''
+    with open(RESULTS_INDEX, 'a') as f:
+        f.write(json.dumps(record) + '\n')
 
-    for f in os.listdir(BENCHMARKS):
-        if ('output.' in f) or ('.264' in f) or ('poses.' in f) or ('app_mapping' in f) :
-            os.remove(os.path.join(BENCHMARKS, f))
-        
 
-def save_output(base_configuration, benchmark, console_output, cpistack, started, ended):
+def save_output(rundir, base_configuration, benchmark, console_output, cpistack, started, ended):
     benchmark_text = benchmark
     if len(benchmark_text) > 100:
         benchmark_text = benchmark_text[:100] + '__etc'
     run = 'results_{}_{}_{}'.format(BATCH_START, '+'.join(base_configuration), benchmark_text)
-    directory = os.path.join(RESULTS_FOLDER, run)
-    if not os.path.exists(directory):
-        os.makedirs(directory)
+    # parallel runs with the same configuration and tasks (e.g. different perforation rates) get a suffix
+    suffix = 1
+    while True:
+        directory = os.path.join(RESULTS_FOLDER, run if suffix == 1 else '{}_{}'.format(run, suffix))
+        try:
+            os.makedirs(directory)
+            break
+        except FileExistsError:
+            suffix += 1
+    run = os.path.basename(directory)
     with gzip.open(os.path.join(directory, 'execution.log.gz'), 'w') as f:
         f.write(console_output.encode('utf-8'))
     with open(os.path.join(directory, 'executioninfo.txt'), 'w') as f:
@@ -79,47 +122,54 @@ def save_output(base_configuration, benchmark, console_output, cpistack, started
               'sim.info',
               'sim.out',
               'cpi-stack.png',
-              'sim.stats.sqlite3'):
-        shutil.copy(os.path.join(BENCHMARKS, f), directory)
+              'sim.stats.sqlite3',
+              'sim.stats.columns'):
+        shutil.copy(os.path.join(rundir, f), directory)
     for f in ('PeriodicPower.log',
               'PeriodicThermal.log',
               'PeriodicFrequency.log',
               'PeriodicVdd.log',
               'PeriodicCPIStack.log',
               'PeriodicRvalue.log'):
-        with open(os.path.join(BENCHMARKS, f), 'rb') as f_in, gzip.open('{}.gz'.format(os.path.join(directory, f)), 'wb') as f_out:
+        with open(os.path.join(rundir, f), 'rb') as f_in, gzip.open('{}.gz'.format(os.path.join(directory, f)), 'wb') as f_out:
             shutil.copyfileobj(f_in, f_out)
 
     pattern = r"^\d+\.hb.log$" # Heartbeat logs
-    for f in os.listdir(BENCHMARKS):
+    for f in os.listdir(rundir):
         if not re.match(pattern, f):
             continue
-        shutil.copy(os.path.join(BENCHMARKS, f), directory)
+        shutil.copy(os.path.join(rundir, f), directory)
     
-    for f in os.listdir(BENCHMARKS):
+    for f in os.listdir(rundir):
         if 'output.' in f:
-            shutil.copy(os.path.join(BENCHMARKS, f), directory)
+            shutil.copy(os.path.join(rundir, f), directory)
         elif 'poses.' in f:
-            shutil.copy(os.path.join(BENCHMARKS, f), directory)
+            shutil.copy(os.path.join(rundir, f), directory)
         elif '.264' in f:
-            shutil.copy(os.path.join(BENCHMARKS, f), directory)
+            shutil.copy(os.path.join(rundir, f), directory)
         elif 'app_mapping.' in f:
-            shutil.copy(os.path.join(BENCHMARKS, f), directory)
+            shutil.copy(os.path.join(rundir, f), directory)
 
     create_plots(run)
+    return run
 
 
-def run(base_configuration, benchmark, ignore_error=False, perforation_script: str = None):
+def run(base_configuration, benchmark, ignore_error=False, perforation_script: str = None, echo=True):
+    '''Run one simulation in its own working directory and save its results, return the name of the run.'''
     print('running {} with configuration {}'.format(benchmark, '+'.join(base_configuration)))
     started = datetime.datetime.now()
-    change_base_configuration(base_configuration)
 
-    prev_run_cleanup()
+    # everything the simulation and the applications write (sim.*, Periodic*.log, heartbeat logs, app output) goes here
+    if not os.path.exists(RESULTS_FOLDER):
+        os.makedirs(RESULTS_FOLDER, exist_ok=True)
+    rundir = tempfile.mkdtemp(prefix='.running_', dir=RESULTS_FOLDER)
+    overlay = os.path.join(rundir, 'base_configuration.cfg')
+    base_configuration_overlay(base_configuration, overlay)
 
     benchmark_options = []
     if ENABLE_HEARTBEATS == True:
         benchmark_options.append('enable_heartbeats')
-        benchmark_options.append('hb_results_dir=%s' % BENCHMARKS)
+        benchmark_options.append('hb_results_dir=%s' % rundir)
 
     # NOTE: This determines the logging interval! (see issue in forked repo)
     periodicPower = 1000000
@@ -132,9 +182,11 @@ def run(base_configuration, benchmark, ignore_error=False, perforation_script: s
     if not perforation_script:
         perforation_script = 'magic_perforation_rate:' 
    
-    args = '-n {number_cores} -c {config} --benchmarks={benchmark} --no-roi --sim-end=last -senergystats:{periodic} -speriodic-power:{periodic}{script}{perforation}{benchmark_options}' \
+    args = '-n {number_cores} -c {config} -c {overlay} -d {rundir} --benchmarks={benchmark} --no-roi --sim-end=last -senergystats:{periodic} -speriodic-power:{periodic}{script}{perforation}{benchmark_options}' \
         .format(number_cores=NUMBER_CORES,
                 config=SNIPER_CONFIG,
+                overlay=overlay,
+                rundir=rundir,
                 benchmark=benchmark,
                 periodic=periodicPower,
                 script= ''.join([' -s' + s for s in SCRIPTS]),
@@ -146,17 +198,18 @@ def run(base_configuration, benchmark, ignore_error=False, perforation_script: s
     print(args)
 
     run_sniper = os.path.join(BENCHMARKS, 'run-sniper')
-    p = subprocess.Popen([run_sniper] + args.split(' '), stdout=subprocess.PIPE, stderr=subprocess.STDOUT, bufsize=1, cwd=BENCHMARKS)
+    p = subprocess.Popen([run_sniper] + args.split(' '), stdout=subprocess.PIPE, stderr=subprocess.STDOUT, bufsize=1, cwd=rundir)
     with p.stdout:
         for line in iter(p.stdout.readline, b''):
             linestr = line.decode('utf-8')
             console_output += linestr
-            print(linestr, end='')
+            if echo:
+                print(linestr, end='')
 
     p.wait()
 
     try:
-        cpistack = subprocess.check_output(['python', os.path.join(SNIPER_BASE, 'tools/cpistack.py')], cwd=BENCHMARKS)
+        cpistack = subprocess.check_output(['python', os.path.join(SNIPER_BASE, 'tools/cpistack.py')], cwd=rundir)
     except:
         if ignore_error:
             cpistack = b''
@@ -165,10 +218,22 @@ def run(base_configuration, benchmark, ignore_error=False, perforation_script: s
 
     ended = datetime.datetime.now()
 
-    save_output(base_configuration, benchmark, console_output, cpistack, started, ended)
+    run = save_output(rundir, base_configuration, benchmark, console_output, cpistack, started, ended)
+    shutil.rmtree(rundir)
+    append_to_index({
+        'run': run,
+        'configuration': base_configuration,
+        'benchmark': benchmark,
+        'perforation_script': perforation_script,
+        'started': started.strftime('%Y-%m-%d %H:%M:%S'),
+        'ended': ended.strftime('%Y-%m-%d %H:%M:%S'),
+        'host': platform.node(),
+        'returncode': p.returncode,
+    })
 
     if p.returncode != 0:
         raise Exception('return code != 0')
+    return run
 
 
 def try_run(base_configuration, benchmark, ignore_error=False):
@@ -186,6 +251,55 @@ def try_run(base_configuration, benchmark, ignore_error=False):
         input('Please press enter...')
 
 
+def _run_job(job, ignore_error):
+    base_configuration, benchmark = job[0], job[1]
+    perforation_script = job[2] if len(job) > 2 else None
+    return run(base_configuration, benchmark, ignore_error=ignore_error, perforation_script=perforation_script, echo=False)
+
+
+def run_batch(name, jobs, workers=None, ignore_error=False):
+    '''Run the jobs, each a tuple (base_configuration, benchmark[, perforation_script]), on a local pool of workers.
+    The state of every job is kept in RESULTS_FOLDER/batch_<name>.json: calling run_batch again with the same name
+    (e.g. after an interruption) only runs the jobs that did not finish successfully.'''
+    if workers is None:
+        # every simulation keeps about one host thread busy per simulated core
+        workers = max(1, (os.cpu_count() or 1) // NUMBER_CORES)
+    if not os.path.exists(RESULTS_FOLDER):
+        os.makedirs(RESULTS_FOLDER, exist_ok=True)
+    state_file = os.path.join(RESULTS_FOLDER, 'batch_{}.json'.format(name))
+    state = {}
+    if os.path.exists(state_file):
+        with open(state_file, 'r') as f:
+            state = json.load(f)
+
+    def job_key(job):
+        return json.dumps([list(job[0]), job[1], job[2] if len(job) > 2 else None])
+
+    pending = [job for job in jobs if state.get(job_key(job), {}).get('status') != 'done']
+    print('batch {}: {} jobs, {} already done, {} workers'.format(name, len(jobs), len(jobs) - len(pending), workers))
+
+    with concurrent.futures.ProcessPoolExecutor(max_workers=workers) as executor:
+        futures = {executor.submit(_run_job, job, ignore_error): job for job in pending}
+        for future in concurrent.futures.as_completed(futures):
+            job = futures[future]
+            try:
+                state[job_key(job)] = {'status': 'done', 'run': future.result()}
+                print('finished {} with configuration {}'.format(job[1], '+'.join(job[0])))
+            except Exception:
+                state[job_key(job)] = {'status': 'failed', 'error': traceback.format_exc()}
+                print('#' * 80)
+                print('failed {} with configuration {}'.format(job[1], '+'.join(job[0])))
+                print(traceback.format_exc())
+                print('#' * 80)
+            with open(state_file + '.tmp', 'w') as f:
+                json.dump(state, f, indent=2)
+            os.replace(state_file + '.tmp', state_file)
+
+    failed = [job for job in jobs if state.get(job_key(job), {}).get('status') != 'done']
+    print('batch {}: {} of {} jobs done'.format(name, len(jobs) - len(failed), len(jobs)))
+    return failed
+
+
 class Infeasible(Exception):
     pass
 
@@ -367,7 +481,16 @@ def multi_program():
 
     run(base_configuration, benchmarks)
 
-    
+
+def example_batch():
+    # Runs all configurations in parallel. Re-running the script resumes the batch with the jobs that did not finish.
+    jobs = []
+    for freq in (1, 2, 3, 4):
+        for parallelism in (2, 3, 4):
+            jobs.append((['{:.1f}GHz'.format(freq), 'maxFreq', 'slowDVFS'], get_instance('parsec-blackscholes', parallelism, input_set='simsmall')))
+    run_batch('example', jobs)
+
+
 def test_static_power():
     run(['4.0GHz', 'testStaticPower', 'slowDVFS'], get_instance('parsec-blackscholes', 3, input_set='simsmall'))
 
@@ -376,6 +499,7 @@ def main():
     example()
     # test_static_power()
     # multi_program()
+    # example_batch()
 
     # example_symmetric_perforation()
     # example_asymmetric_perforation()
@@ -0,0 +1,196 @@
+// Replays queue request streams through the std::list based history list that QueueModelHistoryList used to have,
+// and through FreeIntervalList which replaced it. Checks that both return the same delays and times them.
+//
+// Usage: queue-model-history-list [queue-*.trace ...]
+// Traces are recorded by QueueModelHistoryList with queue_model/history_list/record=true,
+// without arguments a synthetic stream is used.
+
+#include "free_interval_list.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <sys/time.h>
+#include <vector>
+
+// Same layout as QueueModelHistoryList::record_header_t
+struct record_header_t {
+   char magic[8];
+   UInt64 min_processing_time;
+   UInt32 max_list_size;
+   UInt32 analytical_model_enabled;
+};
+
+struct Request {
+   SubsecondTime pkt_time;
+   SubsecondTime processing_time;
+};
+
+// QueueModelHistoryList::computeUsingHistoryList before the interval store was replaced
+class ListHistory
+{
+public:
+   typedef std::list<std::pair<SubsecondTime,SubsecondTime> > FreeIntervalList;
+
+   ListHistory(UInt32 max_size, SubsecondTime min_processing_time, SubsecondTime end_time)
+      : m_max_free_interval_list_size(max_size)
+      , m_min_processing_time(min_processing_time)
+   {
+      m_free_interval_list.push_back(std::pair<SubsecondTime,SubsecondTime>(SubsecondTime::Zero(), end_time));
+   }
+
+   const std::pair<SubsecondTime,SubsecondTime>& front() const { return m_free_interval_list.front(); }
+
+   SubsecondTime allocate(SubsecondTime pkt_time, SubsecondTime processing_time)
+   {
+      SubsecondTime queue_delay = SubsecondTime::MaxTime();
+
+      FreeIntervalList::iterator curr_it;
+      for (curr_it = m_free_interval_list.begin(); curr_it != m_free_interval_list.end(); curr_it ++)
+      {
+         std::pair<SubsecondTime,SubsecondTime> interval = (*curr_it);
+
+         if ((pkt_time >= interval.first) && ((pkt_time + processing_time) <= interval.second))
+         {
+            queue_delay = SubsecondTime::Zero();
+            curr_it = m_free_interval_list.erase(curr_it);
+            if ((pkt_time - interval.first) >= m_min_processing_time)
+               m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first, pkt_time));
+            if ((interval.second - (pkt_time + processing_time)) >= m_min_processing_time)
+               m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(pkt_time + processing_time, interval.second));
+            break;
+         }
+         else if (pkt_time < interval.first)
+         {
+            queue_delay = interval.first - pkt_time;
+            curr_it = m_free_interval_list.erase(curr_it);
+            if ((interval.second - (interval.first + processing_time)) >= m_min_processing_time)
+               m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first + processing_time, interval.second));
+            break;
+         }
+      }
+
+      if (m_free_interval_list.size() > m_max_free_interval_list_size)
+         m_free_interval_list.erase(m_free_interval_list.begin());
+
+      return queue_delay;
+   }
+
+private:
+   UInt32 m_max_free_interval_list_size;
+   SubsecondTime m_min_processing_time;
+   FreeIntervalList m_free_interval_list;
+};
+
+static UInt64 now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return UInt64(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+// Delays of all requests, requests that QueueModelHistoryList would send to its analytical model get MaxTime
+template <class History>
+static UInt64 replay(const record_header_t &header, const std::vector<Request> &requests, std::vector<SubsecondTime> &delays)
+{
+   History history(header.max_list_size, SubsecondTime::FS(header.min_processing_time), SubsecondTime::FS() << 63);
+   delays.resize(requests.size());
+
+   UInt64 start = now();
+   for (size_t i = 0; i < requests.size(); i++)
+   {
+      const Request &request = requests[i];
+      if (header.analytical_model_enabled && (request.pkt_time + request.processing_time) <= history.front().first)
+         delays[i] = SubsecondTime::MaxTime();
+      else
+         delays[i] = history.allocate(request.pkt_time, request.processing_time);
+   }
+   return now() - start;
+}
+
+static bool readTrace(const char *filename, record_header_t &header, std::vector<Request> &requests)
+{
+   FILE *fp = fopen(filename, "rb");
+   if (!fp)
+   {
+      fprintf(stderr, "Cannot open %s\n", filename);
+      return false;
+   }
+   if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, "SNIPQMHL", sizeof(header.magic)) != 0)
+   {
+      fprintf(stderr, "%s is not a queue request trace\n", filename);
+      fclose(fp);
+      return false;
+   }
+
+   UInt64 request[2];
+   while (fread(request, sizeof(request), 1, fp) == 1)
+   {
+      Request r = { SubsecondTime::FS(request[0]), SubsecondTime::FS(request[1]) };
+      requests.push_back(r);
+   }
+   fclose(fp);
+   return true;
+}
+
+// Requests at a DRAM-like load: arrivals mostly in order with some skew between cores, a few transfer sizes
+static void makeSynthetic(record_header_t &header, std::vector<Request> &requests)
+{
+   memcpy(header.magic, "SNIPQMHL", sizeof(header.magic));
+   header.min_processing_time = 1000000; // 1 ns
+   header.max_list_size = 100;
+   header.analytical_model_enabled = 1;
+
+   srand(0);
+   UInt64 time = 0;
+   for (UInt32 i = 0; i < 2000000; i++)
+   {
+      time += rand() % 4000000;
+      UInt64 skew = rand() % 4 == 0 ? rand() % 100000000 : 0;
+      UInt64 processing_time = (1 + rand() % 4) * 1000000;
+      Request r = { SubsecondTime::FS(time > skew ? time - skew : 0), SubsecondTime::FS(processing_time) };
+      requests.push_back(r);
+   }
+}
+
+static bool compare(const char *name, const record_header_t &header, const std::vector<Request> &requests)
+{
+   std::vector<SubsecondTime> list_delays, flat_delays;
+   UInt64 list_time = replay<ListHistory>(header, requests, list_delays);
+   UInt64 flat_time = replay<FreeIntervalList>(header, requests, flat_delays);
+
+   for (size_t i = 0; i < requests.size(); i++)
+   {
+      if (list_delays[i] != flat_delays[i])
+      {
+         printf("%s: MISMATCH at request %zu: list %" PRIu64 " fs, flat %" PRIu64 " fs\n", name, i, list_delays[i].getFS(), flat_delays[i].getFS());
+         return false;
+      }
+   }
+
+   printf("%s: %zu requests, list %.1f ns/request, flat %.1f ns/request, speedup %.2fx\n", name, requests.size(),
+      1000. * list_time / requests.size(), 1000. * flat_time / requests.size(), flat_time ? double(list_time) / flat_time : 0.);
+   return true;
+}
+
+int main(int argc, char **argv)
+{
+   bool ok = true;
+   if (argc < 2)
+   {
+      record_header_t header;
+      std::vector<Request> requests;
+      makeSynthetic(header, requests);
+      ok = compare("synthetic", header, requests);
+   }
+   for (int i = 1; i < argc; i++)
+   {
+      record_header_t header;
+      std::vector<Request> requests;
+      if (!readTrace(argv[i], header, requests))
+         return 2;
+      ok = compare(argv[i], header, requests) && ok;
+   }
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+"""
+Write a statistics snapshot periodically and read it back right away from sim.stats.sqlite3 and
+sim.stats.columns, the way energystats and powertrace do during a simulation.
+Every other snapshot is deleted again once read, so sim.stats.columns is compacted along the way.
+"""
+
+import sys, os, sim
+sys.path.append(os.path.join(os.getenv('SNIPER_ROOT'), 'tools'))
+import sniper_stats_sqlite
+
+class ReadBack:
+  def setup(self, args):
+    interval_ns = long(args or 100000)
+    self.num_snapshots = 0
+    sim.stats.register('readback', 0, 'snapshots', lambda objectName, index, metricName: self.num_snapshots)
+    sim.util.Every(interval_ns * sim.util.Time.NS, self.periodic)
+
+  def periodic(self, time, time_delta):
+    self.num_snapshots += 1
+    prefix = 'readback-%d' % self.num_snapshots
+    sim.stats.write(prefix)
+    self.check(self.num_snapshots)
+    if self.num_snapshots % 2 == 0:
+      sim.util.db_delete(prefix)
+    # The first snapshot is kept, and moves to a new place in the file whenever it is compacted
+    self.check(1)
+
+  def check(self, snapshot):
+    prefix = 'readback-%d' % snapshot
+    stats = sniper_stats_sqlite.SniperStatsSqlite(os.path.join(sim.config.output_dir, 'sim.stats.sqlite3'))
+    values = stats.read_snapshot(prefix, [ 'readback.snapshots' ])
+    found = values.values()[0][0] if values else None
+    if found != snapshot:
+      print >> sys.stderr, '[READBACK] Snapshot %s has readback.snapshots = %s, expected %d' % (prefix, found, snapshot)
+      sys.exit(1)
+
+  def hook_sim_end(self):
+    print '[READBACK] Read back %d snapshots while running' % self.num_snapshots
+
+sim.util.register(ReadBack())
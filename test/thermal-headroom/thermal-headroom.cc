@@ -0,0 +1,95 @@
+// Checks the cached TSP sums of ThermalModel (ThermalHeadroom) against a full recomputation over BInv.
+//
+// The model file has 4 * cores + 12 thermal nodes, so BInv is not cores x cores and any mixup between
+// the row stride of BInv and the number of cores shows up as a mismatch.
+//
+// Usage: thermal-headroom
+
+#include "thermalModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const char *MODEL_FILENAME = "thermal-headroom.model";
+
+static const double AMBIENT_TEMPERATURE = 45;
+static const double MAX_TEMPERATURE = 80;
+static const double INACTIVE_POWER = 0.3;
+static const double TDP = 250;
+
+// Same layout as the files ThermalModel reads: three counts, one name per unit, BInv
+static void writeModel(unsigned int numberUnits)
+{
+   unsigned int numberThermalNodes = 4 * numberUnits + 12;
+   unsigned int numberNodesAmbient = numberThermalNodes - 3 * numberUnits;
+
+   FILE *fp = fopen(MODEL_FILENAME, "wb");
+   fwrite(&numberUnits, sizeof(numberUnits), 1, fp);
+   fwrite(&numberNodesAmbient, sizeof(numberNodesAmbient), 1, fp);
+   fwrite(&numberThermalNodes, sizeof(numberThermalNodes), 1, fp);
+   for (unsigned int u = 0; u < numberUnits; u++)
+      fprintf(fp, "C_%u\n", u);
+   for (unsigned int i = 0; i < numberThermalNodes * numberThermalNodes; i++)
+   {
+      double value = 0.1 + (double)rand() / RAND_MAX;
+      fwrite(&value, sizeof(value), 1, fp);
+   }
+   fclose(fp);
+}
+
+static bool check(const char *what, double incremental, double full)
+{
+   if (std::fabs(incremental - full) <= 1e-9 * std::max(1.0, std::fabs(full)))
+      return true;
+   fprintf(stderr, "%s: cached sums give %.12g, full recomputation %.12g\n", what, incremental, full);
+   return false;
+}
+
+int main()
+{
+   const unsigned int coreRows = 4, coreColumns = 5, numberUnits = coreRows * coreColumns;
+   srand(1);
+   writeModel(numberUnits);
+   ThermalModel model(coreRows, coreColumns, MODEL_FILENAME, AMBIENT_TEMPERATURE, MAX_TEMPERATURE, INACTIVE_POWER, TDP);
+
+   // tsp(activeCores, powerOfInactiveCores) still scans BInv on every call
+   std::vector<double> inactivePowers(numberUnits, INACTIVE_POWER);
+   unsigned int checks = 0, failures = 0;
+
+   // Random walks toggling one core at a time, like PCGov's greedy mapping
+   for (unsigned int walk = 0; walk < 20; walk++)
+   {
+      std::vector<bool> activeCores(numberUnits, false);
+      for (unsigned int step = 0; step < 2 * numberUnits; step++)
+      {
+         unsigned int core = rand() % numberUnits;
+         activeCores[core] = !activeCores[core];
+         if (std::count(activeCores.begin(), activeCores.end(), true) == 0)
+            continue;
+
+         ++checks;
+         if (!check("tsp", model.tsp(activeCores), model.tsp(activeCores, inactivePowers)))
+            ++failures;
+
+         std::vector<int> candidates;
+         for (unsigned int c = 0; c < numberUnits; c++)
+            if (!activeCores[c])
+               candidates.push_back(c);
+         std::vector<double> tsps = model.tspForManyCandidates(activeCores, candidates);
+         for (unsigned int idx = 0; idx < candidates.size(); idx++)
+         {
+            std::vector<bool> withCandidate = activeCores;
+            withCandidate[candidates[idx]] = true;
+            ++checks;
+            if (!check("tspForManyCandidates", tsps[idx], model.tsp(withCandidate, inactivePowers)))
+               ++failures;
+         }
+      }
+   }
+
+   printf("%u checks, %u failures\n", checks, failures);
+   return failures ? 1 : 0;
+}
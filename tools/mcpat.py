@@ -242,38 +242,8 @@ def log_cpi_stack(results):
                 f.write('\n')
 
 
-def main(jobid, resultsdir, outputfile, powertype='dynamic', config=None, no_graph=False, partial=None, print_stack=True, return_data=False):
-    tempfile = outputfile + '.xml'
-
-    results = sniper_lib.get_results(jobid, resultsdir, partial=partial)
-    if config:
-        # update using energystats-temp.cfg
-        results['config'] = sniper_config.parse_config(
-            file(config).read(), results['config'])
-
-        # recompute cycle counts with updated frequencies
-        _results = sniper_lib.parse_results_from_dir(
-            resultsdir, partial=partial, metrics=None)
-        results['results'] = sniper_lib.stats_process(
-            results['config'], _results)
-
-    stats = sniper_stats.SniperStats(resultsdir=resultsdir, jobid=jobid)
-
-    power, nuca_at_level = edit_XML(
-        stats, results['results'], results['config'])
-    power = map(lambda v: v[0], power)
-    file(tempfile, "w").write('\n'.join(power))
-
-    # Log Performance Counters
-    log_frequencies(results)
-    log_vdd(results)
-    log_cpi_stack(results)
-
-    # Run McPAT
-    mcpat_run(tempfile, outputfile + '.txt')
-
-    # Parse output
-    power_txt = file(outputfile + '.txt')
+def parse_mcpat_output(filename, nuca_at_level):
+    power_txt = file(filename)
     power_dat = {}
 
     components = power_txt.read().split('*'*89)[2:-1]
@@ -327,6 +297,51 @@ def main(jobid, resultsdir, outputfile, powertype='dynamic', config=None, no_gra
     if not power_dat:
         raise ValueError('No valid McPAT output found')
 
+    return power_dat
+
+
+def get_partial_results(jobid, resultsdir, config=None, partial=None):
+    results = sniper_lib.get_results(jobid, resultsdir, partial=partial)
+    if config:
+        # update using energystats-temp.cfg
+        results['config'] = sniper_config.parse_config(
+            file(config).read(), results['config'])
+
+        # recompute cycle counts with updated frequencies
+        _results = sniper_lib.parse_results_from_dir(
+            resultsdir, partial=partial, metrics=None)
+        results['results'] = sniper_lib.stats_process(
+            results['config'], _results)
+    return results
+
+
+def log_performance_counters(results):
+    log_frequencies(results)
+    log_vdd(results)
+    log_cpi_stack(results)
+
+
+def main(jobid, resultsdir, outputfile, powertype='dynamic', config=None, no_graph=False, partial=None, print_stack=True, return_data=False):
+    tempfile = outputfile + '.xml'
+
+    results = get_partial_results(jobid, resultsdir, config, partial)
+
+    # Log Performance Counters
+    log_performance_counters(results)
+
+    stats = sniper_stats.SniperStats(resultsdir=resultsdir, jobid=jobid)
+
+    power, nuca_at_level = edit_XML(
+        stats, results['results'], results['config'])
+    power = map(lambda v: v[0], power)
+    file(tempfile, "w").write('\n'.join(power))
+
+    # Run McPAT
+    mcpat_run(tempfile, outputfile + '.txt')
+
+    # Parse output
+    power_dat = parse_mcpat_output(outputfile + '.txt', nuca_at_level)
+
     # Add DRAM power
     dram_dyn, dram_stat = dram_power(results['results'], results['config'])
     power_dat['DRAM'] = {
@@ -337,6 +352,7 @@ def main(jobid, resultsdir, outputfile, powertype='dynamic', config=None, no_gra
         'Gate Leakage': 0,
         'Area': 0,
     }
+
     # Write back
     file(outputfile + '.py', 'w').write("power = " + pprint.pformat(power_dat))
 
@@ -427,30 +443,114 @@ def scale_power(suffix, power, size_nm):
         raise Exception('do not know how to scale power: {}'.format(suffix))
 
 
+def power_log_components(nr_cores, cfg):
+    # Create the 'Headings' of the power log from this component_list
+    # The order of component_list MUST match the order in which power_log_readings
+    # constructs the readings below!
+    component_list = {
+        "FPU", # Floating Point Unit
+        "RBB", # Result Broadcast Bus
+        "REN", # Renaming Unit
+        "MMU", # Memory Management Unit
+        "Other", # Total power - (IF + LSU + RU + MMU + L2)
+        "IW", # Instruction Window
+        "FPIW", # FP Instruction Window
+        "ROB", # Reorder Buffer
+        "IRF", # Integer Register Files
+        "FPRF", # FP Register Files
+        "CALU", # Complex ALU
+        "IALU", # Integer ALU
+        "BTB", # Branch Target Buffer
+        "BP", # Branch Predictor
+        "LQ", # Load Queue
+        "SQ", # Store Queue
+        "DC", # Data Cache
+        "ID", # Instruction Decoder
+        "IB", # Instruction Buffer
+        "IC", # Instruction Cache
+        "L2" # Private L2
+    }
+    all_components = ["C_{}_".format(core_num) + component
+            for core_num in range(nr_cores)
+            for component in component_list]
+
+    if int(cfg['perf_model/cache/levels']) == 3:
+        all_components.insert(0, 'L3') # Add to front: to match order of 'Readings'
+    return all_components
+
+
+def power_log_readings(power_dat, cfg, getpower):
+    # The order of the values MUST match power_log_components.
+    Readings = []
+
+    L3Power = sum([getpower(cache) for cache in power_dat.get('L3', [])])
+
+    if int(cfg['perf_model/cache/levels']) == 3:
+        Readings.append(L3Power)  # Private L3
+
+    for i, core in enumerate(power_dat['Core']):
+        totalPower = getpower(core)
+        OtherPower = totalPower - (getpower(core, 'Execution Unit')
+                           + getpower(core, 'Instruction Fetch Unit')
+                           + getpower(core, 'Load Store Unit')
+                           + getpower(core, 'Renaming Unit')
+                           + getpower(core, 'Memory Management Unit')
+                           + getpower(core, 'L2'))
+        OtherPower = max(0, OtherPower)  #zero out small negative values
+
+        Readings.append(getpower(core, 'Execution Unit/Floating Point Units'))
+        Readings.append(getpower(core, 'Execution Unit/Results Broadcast Bus'))
+        Readings.append(getpower(core, 'Renaming Unit'))
+        Readings.append(getpower(core, 'Memory Management Unit'))
+        Readings.append(OtherPower)
+        Readings.append(getpower(core, 'Execution Unit/Instruction Scheduler/Instruction Window'))
+        Readings.append(getpower(core, 'Execution Unit/Instruction Scheduler/FP Instruction Window'))
+        Readings.append(getpower(core, 'Execution Unit/Instruction Scheduler/ROB'))
+        Readings.append(getpower(core, 'Execution Unit/Register Files/Integer RF'))
+        Readings.append(getpower(core, 'Execution Unit/Register Files/Floating Point RF'))
+        Readings.append(getpower(core, 'Execution Unit/Complex ALUs'))
+        Readings.append(getpower(core, 'Execution Unit/Integer ALUs'))
+        Readings.append(getpower(core, 'Instruction Fetch Unit/Branch Target Buffer'))
+        Readings.append(getpower(core, 'Instruction Fetch Unit/Branch Predictor'))
+        Readings.append(getpower(core, 'Load Store Unit/LoadQ'))
+        Readings.append(getpower(core, 'Load Store Unit/StoreQ'))
+        Readings.append(getpower(core, 'Load Store Unit/Data Cache'))
+        Readings.append(getpower(core, 'Instruction Fetch Unit/Instruction Decoder'))
+        Readings.append(getpower(core, 'Instruction Fetch Unit/Instruction Buffer'))
+        Readings.append(getpower(core, 'Instruction Fetch Unit/Instruction Cache'))
+        Readings.append(getpower(core, 'L2'))
+
+    return Readings
+
+
+def get_power(powers, key, powertype, size_nm):
+    def getcomponent(suffix):
+        if key:
+            return scale_power(suffix, powers.get(key+'/'+suffix, 0), size_nm)
+        else:
+            return scale_power(suffix, powers.get(suffix, 0), size_nm)
+    if powertype == 'dynamic':
+        return getcomponent('Runtime Dynamic')
+    elif powertype == 'static':
+        return getcomponent('Subthreshold Leakage with power gating') + getcomponent('Gate Leakage')
+    elif powertype == 'total':
+        return getcomponent('Runtime Dynamic') + getcomponent('Subthreshold Leakage with power gating') + getcomponent('Gate Leakage')
+    elif powertype == 'peak':
+        return getcomponent('Peak Dynamic') + getcomponent('Subthreshold Leakage with power gating') + getcomponent('Gate Leakage')
+    elif powertype == 'peakdynamic':
+        return getcomponent('Peak Dynamic')
+    elif powertype == 'area':
+        return getcomponent('Area') + getcomponent('Area Overhead')
+    else:
+        raise ValueError('Unknown powertype %s' % powertype)
+
+
 def power_stack(power_dat, cfg, seconds, powertype='total', nocollapse=False):
     # `seconds` is the sampling time interval.
     size_nm = int(sniper_config.get_config(cfg, "power/technology_node"))
 
     def getpower(powers, key=None):
-        def getcomponent(suffix):
-            if key:
-                return scale_power(suffix, powers.get(key+'/'+suffix, 0), size_nm)
-            else:
-                return scale_power(suffix, powers.get(suffix, 0), size_nm)
-        if powertype == 'dynamic':
-            return getcomponent('Runtime Dynamic')
-        elif powertype == 'static':
-            return getcomponent('Subthreshold Leakage with power gating') + getcomponent('Gate Leakage')
-        elif powertype == 'total':
-            return getcomponent('Runtime Dynamic') + getcomponent('Subthreshold Leakage with power gating') + getcomponent('Gate Leakage')
-        elif powertype == 'peak':
-            return getcomponent('Peak Dynamic') + getcomponent('Subthreshold Leakage with power gating') + getcomponent('Gate Leakage')
-        elif powertype == 'peakdynamic':
-            return getcomponent('Peak Dynamic')
-        elif powertype == 'area':
-            return getcomponent('Area') + getcomponent('Area Overhead')
-        else:
-            raise ValueError('Unknown powertype %s' % powertype)
+        return get_power(powers, key, powertype, size_nm)
 
     # for core in power_dat['Core']:
          #corePower = getpower(core, 'Instruction Fetch Unit/Instruction Cache')
@@ -500,43 +600,15 @@ def power_stack(power_dat, cfg, seconds, powertype='total', nocollapse=False):
         os.path.join(sniper_config.get_config(cfg, "general/output_dir"),
                      "InstantaneousPower.log"), 'w')
 
-    if (sniper_config.get_config(cfg, "periodic_thermal/enabled") == 'true'):
+    # With the internal engine, the open scheduler steps HotSpot in-process and writes the thermal logs itself
+    external_thermal = sniper_config.get_config(cfg, "periodic_thermal/enabled") == 'true' and \
+        sniper_config.get_config_default(cfg, "periodic_thermal/engine", 'external') == 'external'
+
+    if external_thermal:
         thermalLogFileName = file(os.path.join(sniper_config.get_config(
             cfg, "general/output_dir"), "PeriodicThermal.log"), 'a')
 
-    # Create the 'Headings' string from this component_list
-    # The order of component_list MUST match the order in which 'Readings'
-    # is constructed below!
-    component_list = {
-        "FPU", # Floating Point Unit
-        "RBB", # Result Broadcast Bus
-        "REN", # Renaming Unit
-        "MMU", # Memory Management Unit
-        "Other", # Total power - (IF + LSU + RU + MMU + L2)
-        "IW", # Instruction Window
-        "FPIW", # FP Instruction Window
-        "ROB", # Reorder Buffer
-        "IRF", # Integer Register Files
-        "FPRF", # FP Register Files
-        "CALU", # Complex ALU
-        "IALU", # Integer ALU
-        "BTB", # Branch Target Buffer
-        "BP", # Branch Predictor
-        "LQ", # Load Queue
-        "SQ", # Store Queue
-        "DC", # Data Cache
-        "ID", # Instruction Decoder
-        "IB", # Instruction Buffer
-        "IC", # Instruction Cache
-        "L2" # Private L2
-    }
-    nr_cores = len(power_dat['Core'])
-    all_components = ["C_{}_".format(core_num) + component
-            for core_num in range(nr_cores)
-            for component in component_list]
-
-    if int(cfg['perf_model/cache/levels']) == 3:
-        all_components.insert(0, 'L3') # Add to front: to match order of 'Readings'
+    all_components = power_log_components(len(power_dat['Core']), cfg)
     Headings = '\t'.join(all_components)
 
     # gkothar1
@@ -546,7 +618,7 @@ def power_stack(power_dat, cfg, seconds, powertype='total', nocollapse=False):
 
     if needInitializing:
         powerLogFileName.write(Headings+"\n")
-        if (sniper_config.get_config(cfg, "periodic_thermal/enabled") == 'true'):
+        if external_thermal:
             thermalLogFileName.write(Headings+"\n")
         if (sniper_config.get_config(cfg, 'reliability/enabled') == 'true'):
             periodic_rvalues = os.path.join(sniper_config.get_config(cfg, "general/output_dir"), 'PeriodicRvalue.log')
@@ -555,68 +627,15 @@ def power_stack(power_dat, cfg, seconds, powertype='total', nocollapse=False):
 
     powerInstantaneousFileName.write(Headings+"\n")
 
-    # The order of the values in 'Reading' MUST match the 'Headings' string created above.
-    Readings = ""
-
-    L3Power = sum([getpower(cache) for cache in power_dat.get('L3', [])])
-
-    if int(cfg['perf_model/cache/levels']) == 3:
-        Readings += str(L3Power)+"\t"  # Private L3
-
-    amtCores = len(power_dat['Core'])
-    for i, core in enumerate(power_dat['Core']):
-        totalPower = getpower(core)
-        IFUPower = getpower(core, 'Instruction Fetch Unit/Branch Predictor') + \
-                getpower(core, 'Instruction Fetch Unit/Branch Target Buffer') + \
-                getpower(core, 'Instruction Fetch Unit/Instruction Buffer') + \
-                getpower(core, 'Instruction Fetch Unit/Instruction Decoder') + \
-                getpower(core, 'Instruction Fetch Unit/Instruction Cache')
-        LSUPower = getpower(core, 'Load Store Unit/Data Cache') + \
-                getpower(core, 'Load Store Unit/LoadQ') + \
-                getpower(core, 'Load Store Unit/StoreQ')
-        EUPower = getpower(core, 'Execution Unit/Instruction Scheduler') + \
-                getpower(core, 'Execution Unit/Register Files') + \
-                getpower(core, 'Execution Unit/Results Broadcast Bus') + \
-                getpower(core, 'Execution Unit/Complex ALUs') + \
-                getpower(core, 'Execution Unit/Floating Point Units') + \
-                getpower(core, 'Execution Unit/Integer ALUs')
-        OtherPower = totalPower - (getpower(core, 'Execution Unit')
-                           + getpower(core, 'Instruction Fetch Unit')
-                           + getpower(core, 'Load Store Unit')
-                           + getpower(core, 'Renaming Unit')
-                           + getpower(core, 'Memory Management Unit')
-                           + getpower(core, 'L2'))
-        OtherPower = max(0, OtherPower)  #zero out small negative values
+    Readings = '\t'.join(map(str, power_log_readings(power_dat, cfg, getpower)))
 
-        Readings += str(getpower(core, 'Execution Unit/Floating Point Units'))+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Results Broadcast Bus'))+"\t"
-        Readings += str(getpower(core, 'Renaming Unit'))+"\t"
-        Readings += str(getpower(core, 'Memory Management Unit'))+"\t"
-        Readings += str(OtherPower)+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Instruction Scheduler/Instruction Window'))+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Instruction Scheduler/FP Instruction Window'))+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Instruction Scheduler/ROB'))+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Register Files/Integer RF'))+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Register Files/Floating Point RF'))+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Complex ALUs'))+"\t"
-        Readings += str(getpower(core, 'Execution Unit/Integer ALUs'))+"\t"
-        Readings += str(getpower(core, 'Instruction Fetch Unit/Branch Target Buffer'))+"\t"
-        Readings += str(getpower(core, 'Instruction Fetch Unit/Branch Predictor'))+"\t"
-        Readings += str(getpower(core, 'Load Store Unit/LoadQ'))+"\t"
-        Readings += str(getpower(core, 'Load Store Unit/StoreQ'))+"\t"
-        Readings += str(getpower(core, 'Load Store Unit/Data Cache'))+"\t"
-        Readings += str(getpower(core, 'Instruction Fetch Unit/Instruction Decoder'))+"\t"
-        Readings += str(getpower(core, 'Instruction Fetch Unit/Instruction Buffer'))+"\t"
-        Readings += str(getpower(core, 'Instruction Fetch Unit/Instruction Cache'))+"\t"
-        Readings += str(getpower(core, 'L2'))+"\t"
-
-    powerInstantaneousFileName.write(Readings.rstrip('\t')+"\n")
+    powerInstantaneousFileName.write(Readings+"\n")
     powerInstantaneousFileName.close()
 
-    powerLogFileName.write(Readings.rstrip('\t')+"\n")
+    powerLogFileName.write(Readings+"\n")
     powerLogFileName.close()
 
-    if (sniper_config.get_config(cfg, "periodic_thermal/enabled") == 'true'):
+    if external_thermal:
         # HotSpot Integration Code
         # gkothar1
         hotspot_dir = os.path.dirname(__file__)
@@ -0,0 +1,210 @@
+#!/usr/bin/env python
+"""
+Characterize McPAT for the native power model of the open scheduler (power/model = native)
+
+Uses the configuration of a finished simulation and runs McPAT on synthetic 1 ms intervals:
+- without any activity at every DVFS level, giving the static (idle) power of each component
+- at the reference DVFS level with a single kind of event, giving the energy per event of each component
+The result is the energy table read by common/scheduler/power_estimator.cc.
+The model is linear: it assumes homogeneous cores and dynamic energy that scales with vdd^2.
+NoC and NUCA activity is not characterized.
+"""
+
+import sys
+import os
+import copy
+import getopt
+import sniper_lib
+import sniper_config
+import sniper_stats
+import mcpat
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'scripts'))
+from dvfs_table import build_dvfs_table
+
+INTERVAL = 1e12  # fs
+ACTIVITY = 0.25  # events per cycle when characterizing an event
+
+
+def get_events(stats, private_l2s):
+    if 'rob_timer.uop_load' in stats:
+        timer = 'rob_timer'
+    else:
+        timer = 'interval_timer'
+    events = [
+        ('core', 'performance_model', 'elapsed_time', 'idle_elapsed_time'),
+        ('core', 'performance_model', 'instruction_count', None),
+        ('core', timer, 'uops_total', None),
+        ('core', timer, 'uop_fp_addsub', None),
+        ('core', timer, 'uop_fp_muldiv', None),
+        ('core', timer, 'uop_branch', None),
+        ('core', timer, 'uop_load', None),
+        ('core', timer, 'uop_store', None),
+        ('core', timer, 'uop_generic', None),
+        ('core', 'branch_predictor', 'num-incorrect', None),
+        ('core', 'L1-I', 'loads', None),
+        ('core', 'L1-I', 'stores', None),
+        ('core', 'L1-I', 'load-misses', None),
+        ('core', 'L1-D', 'loads', None),
+        ('core', 'L1-D', 'stores', None),
+        ('core', 'L1-D', 'load-misses', None),
+        ('core', 'L1-D', 'store-misses', None),
+    ]
+    for metric in ('loads', 'stores', 'load-misses', 'store-misses'):
+        events.append(('core' if private_l2s else 'shared', 'L2', metric, None))
+    if 'L3.loads' in stats:
+        for metric in ('loads', 'stores', 'load-misses', 'store-misses'):
+            events.append(('shared', 'L3', metric, None))
+    events.append(('shared', 'dram', 'reads', None))
+    events.append(('shared', 'dram', 'writes', None))
+    return events
+
+
+def idle_stats(stats, events, frequency, ncores):
+    stats = copy.deepcopy(stats)
+    # remove all activity, including events that are not characterized
+    for key in stats.keys():
+        if key.split('.')[0] in ('rob_timer', 'interval_timer', 'branch_predictor', 'L1-I', 'L1-D', 'L2', 'L3', 'nuca-cache', 'dram', 'bus', 'network'):
+            if type(stats[key]) is list:
+                stats[key] = [0] * len(stats[key])
+    for scope, objectname, metric, subtract in events:
+        stats.setdefault('%s.%s' % (objectname, metric), [0] * ncores)
+    stats['performance_model.instruction_count'] = [0] * ncores
+    stats['performance_model.elapsed_time'] = [INTERVAL] * ncores
+    stats['performance_model.idle_elapsed_time'] = [INTERVAL] * ncores
+    stats['fs_to_cycles_cores'] = [frequency * 1e6 / 1e15] * ncores
+    stats['global.time_begin'] = 0
+    stats['global.time_end'] = INTERVAL
+    stats['global.time'] = INTERVAL
+    return stats
+
+
+def level_config(cfg, frequency, vdd, ncores):
+    return sniper_config.parse_config('''
+[perf_model/core]
+frequency[] = %s
+[power]
+vdd[] = %s
+''' % (','.join(['%f' % (frequency / 1000.)] * ncores), ','.join([str(vdd)] * ncores)), copy.deepcopy(cfg))
+
+
+def run_power(statsobj, stats, cfg, outputbase):
+    # Return the total power of every table component: per-core components of core 0, shared and extra components
+    power, nuca_at_level = mcpat.edit_XML(statsobj, copy.deepcopy(stats), copy.deepcopy(cfg))
+    file(outputbase + '.xml', 'w').write('\n'.join(map(lambda v: v[0], power)))
+    mcpat.mcpat_run(outputbase + '.xml', outputbase + '.txt')
+    power_dat = mcpat.parse_mcpat_output(outputbase + '.txt', nuca_at_level)
+
+    size_nm = int(sniper_config.get_config(cfg, 'power/technology_node'))
+    getpower = lambda powers, key=None: mcpat.get_power(powers, key, 'total', size_nm)
+    names = mcpat.power_log_components(len(power_dat['Core']), cfg)
+    readings = mcpat.power_log_readings(power_dat, cfg, getpower)
+
+    values = dict(zip(names, readings))
+    values['Uncore'] = max(0, getpower(power_dat['Processor']) - sum(readings))
+    dram_dyn, dram_stat = mcpat.dram_power(stats, cfg)
+    values['DRAM'] = dram_dyn + dram_stat
+    return values
+
+
+def main(jobid, resultsdir, outputfile):
+    results = sniper_lib.get_results(jobid, resultsdir)
+    cfg = results['config']
+    stats = results['results']
+    statsobj = sniper_stats.SniperStats(resultsdir=resultsdir, jobid=jobid)
+    ncores = int(cfg['general/total_cores'])
+    outputbase = os.path.join(resultsdir, 'energytable-temp')
+
+    private_l2s = int(sniper_config.get_config_default(cfg, 'perf_model/l2_cache/shared_cores', 1)) == 1
+    events = get_events(stats, private_l2s)
+
+    core_components = [name[len('C_0_'):] for name in mcpat.power_log_components(1, cfg) if name.startswith('C_0_')]
+    shared_components = [name for name in mcpat.power_log_components(1, cfg) if not name.startswith('C_')]
+    extra_components = ['Uncore', 'DRAM']
+
+    def component_values(values):
+        return [values['C_0_' + name] for name in core_components] + [values[name] for name in shared_components + extra_components]
+
+    # DVFS levels that the open scheduler can select
+    min_frequency = float(sniper_config.get_config_default(cfg, 'scheduler/open/dvfs/min_frequency', 0)) * 1000
+    max_frequency = float(sniper_config.get_config_default(cfg, 'scheduler/open/dvfs/max_frequency', 1e6)) * 1000
+    dvfs_table = build_dvfs_table(int(sniper_config.get_config(cfg, 'power/technology_node')))
+    levels = [(f, v) for f, v in dvfs_table if f > 0 and min_frequency - 100 < f <= max_frequency]
+
+    reference_frequency = float(sniper_config.get_config(cfg, 'perf_model/core/frequency')) * 1000
+    reference_frequency, reference_vdd = [(f, v) for f, v in levels if f <= reference_frequency or (f, v) == levels[-1]][0]
+
+    static = []
+    for frequency, vdd in levels:
+        print >> sys.stderr, '[mcpat_energy_table] idle power at %d MHz, %.3f V' % (frequency, vdd)
+        values = run_power(statsobj, idle_stats(stats, events, frequency, ncores), level_config(cfg, frequency, vdd, ncores), outputbase)
+        static.append(component_values(values))
+
+    reference_cfg = level_config(cfg, reference_frequency, reference_vdd, ncores)
+    reference_stats = idle_stats(stats, events, reference_frequency, ncores)
+    reference_power = component_values(run_power(statsobj, reference_stats, reference_cfg, outputbase))
+    count = ACTIVITY * INTERVAL * reference_stats['fs_to_cycles_cores'][0]
+
+    energies = []
+    for scope, objectname, metric, subtract in events:
+        print >> sys.stderr, '[mcpat_energy_table] energy of %s.%s' % (objectname, metric)
+        event_stats = copy.deepcopy(reference_stats)
+        if subtract:
+            # busy time: the event is elapsed_time - idle_elapsed_time (in fs)
+            amount = ACTIVITY * INTERVAL
+            event_stats['%s.%s' % (objectname, subtract)][0] -= amount
+        else:
+            amount = count
+            event_stats['%s.%s' % (objectname, metric)][0] += amount
+        power = component_values(run_power(statsobj, event_stats, reference_cfg, outputbase))
+        energies.append([(p - p0) * INTERVAL * 1e-15 / amount for p, p0 in zip(power, reference_power)])
+
+    for ext in ('.xml', '.txt'):
+        if os.path.exists(outputbase + ext):
+            os.unlink(outputbase + ext)
+
+    with open(outputfile, 'w') as f:
+        f.write('# Energy table for the native power model, generated by tools/mcpat_energy_table.py from %s\n' % os.path.abspath(resultsdir))
+        f.write('cores %d\n' % ncores)
+        f.write('reference_vdd %f\n' % reference_vdd)
+        for name in core_components:
+            f.write('component core %s\n' % name)
+        for name in shared_components:
+            f.write('component shared %s\n' % name)
+        for name in extra_components:
+            f.write('component extra %s\n' % name)
+        for scope, objectname, metric, subtract in events:
+            f.write('event %s %s %s%s\n' % (scope, objectname, metric, ' ' + subtract if subtract else ''))
+        f.write('# level <frequency (MHz)> <vdd> <static power (W) per component>\n')
+        for (frequency, vdd), values in zip(levels, static):
+            f.write('level %d %f %s\n' % (frequency, vdd, ' '.join('%.6e' % v for v in values)))
+        f.write('# energy <component> <energy (J) per event at the reference vdd>\n')
+        for c, name in enumerate(core_components + shared_components + extra_components):
+            f.write('energy %s %s\n' % (name, ' '.join('%.6e' % max(0, energies[e][c]) for e in range(len(events)))))
+
+
+if __name__ == '__main__':
+    def usage():
+        print 'Usage:', sys.argv[0], '[-h (help)] [-j <jobid> | -d <resultsdir (default: .)>] [-o <output-file (default: energy_table.txt)>]'
+        sys.exit(-1)
+
+    jobid = 0
+    resultsdir = '.'
+    outputfile = 'energy_table.txt'
+
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], "hj:d:o:")
+    except getopt.GetoptError, e:
+        print e
+        usage()
+    for o, a in opts:
+        if o == '-h':
+            usage()
+        if o == '-d':
+            resultsdir = a
+        if o == '-j':
+            jobid = long(a)
+        if o == '-o':
+            outputfile = a
+
+    main(jobid=jobid, resultsdir=resultsdir, outputfile=outputfile)
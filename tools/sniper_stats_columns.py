@@ -0,0 +1,79 @@
+import mmap, struct
+
+# Reader for sim.stats.columns, the columnar statistics store written by StatsColumnWriter (common/misc/stats_columns.h)
+# Chunks are found through the `chunks` table of sim.stats.sqlite3, so opening the store does not scan the file.
+
+MAGIC = 'SNIPSTCL'
+FILE_HEADER = struct.Struct('=8sIIQ')    # magic, version, generation, size
+CHUNK_HEADER = struct.Struct('=IIQ')     # num_snapshots, num_columns, size
+
+def decode_column(data, start, end, num_snapshots):
+  values = []
+  value = 0
+  pos = start
+  while pos < end:
+    encoded = 0
+    shift = 0
+    while True:
+      byte = ord(data[pos:pos+1])
+      pos += 1
+      encoded |= (byte & 0x7f) << shift
+      shift += 7
+      if byte < 0x80:
+        break
+    # Undo zigzag, then the delta against the previous snapshot
+    value = (value + ((encoded >> 1) ^ -(encoded & 1))) & 0xffffffffffffffff
+    values.append(to_signed(value))
+  assert len(values) == num_snapshots
+  return values
+
+def to_signed(value):
+  # Signed, as sqlite returns the values it stored
+  return value - (1 << 64) if value >> 63 else value
+
+class StatsColumns:
+  def __init__(self, filename = 'sim.stats.columns'):
+    self.filename = filename
+    self.fp = open(filename, 'rb')
+    self.data = None
+    self._map()
+
+  def _map(self):
+    if self.data:
+      self.data.close()
+    self.data = mmap.mmap(self.fp.fileno(), 0, access = mmap.ACCESS_READ)
+    magic, version, self.generation, _ = FILE_HEADER.unpack_from(self.data, 0)
+    if magic != MAGIC.encode('ascii') or version != 3:
+      raise ValueError('%s is not a statistics column file' % self.filename)
+
+  def _chunk(self, offset):
+    # While the simulation runs, the file grows and a compaction can move the chunks: map it again when needed
+    magic, version, generation, valid_size = FILE_HEADER.unpack_from(self.data, 0)
+    if generation != self.generation or offset + CHUNK_HEADER.size > len(self.data):
+      self._map()
+    num_snapshots, num_columns, size = CHUNK_HEADER.unpack_from(self.data, offset)
+    pos = offset + CHUNK_HEADER.size
+    snapshots = struct.unpack_from('=%dQ' % num_snapshots, self.data, pos)
+    return snapshots, num_columns, pos + 8 * num_snapshots
+
+  def _read_chunk_column(self, chunk, column):
+    snapshots, num_columns, offsets = chunk
+    if column >= num_columns:
+      return [ 0 ] * len(snapshots)
+    start, end = struct.unpack_from('=II', self.data, offsets + 4 * column)
+    base = offsets + 4 * (num_columns + 1)
+    return decode_column(self.data, base + start, base + end, len(snapshots))
+
+  def read_snapshot(self, offset, snapshot, columns):
+    # Return { column: value } for the given columns in one snapshot of the chunk at offset
+    chunk = self._chunk(offset)
+    idx = chunk[0].index(snapshot)
+    return dict([ (column, self._read_chunk_column(chunk, column)[idx]) for column in columns ])
+
+  def read_column(self, offsets, column):
+    # Return { snapshot: value } with the time series of one column over the chunks at offsets
+    series = {}
+    for offset in offsets:
+      chunk = self._chunk(offset)
+      series.update(zip(chunk[0], self._read_chunk_column(chunk, column)))
+    return series
@@ -1,10 +1,34 @@
-import collections, sqlite3, sniper_stats
+import collections, os, sqlite3, sniper_stats, sniper_stats_columns
 
 class SniperStatsSqlite(sniper_stats.SniperStatsBase):
   def __init__(self, filename = 'sim.stats.sqlite3'):
     self.db = sqlite3.connect(filename)
     self.db.text_factory = str # Don't try to convert database contents to UTF-8
     self.names = self.read_metricnames()
+    # Newer runs store their values in sim.stats.columns, indexed through the `columns` table
+    self.columns = None
+    c = self.db.cursor()
+    if c.execute('SELECT name FROM sqlite_master WHERE type="table" AND name="columns"').fetchall():
+      self.columns = sniper_stats_columns.StatsColumns(os.path.join(os.path.dirname(filename), 'sim.stats.columns'))
+      self.column_ids = {}
+      for columnid, nameid, core in c.execute('SELECT columnid, nameid, core FROM `columns`'):
+        self.column_ids[(nameid, core)] = columnid
+      # The latest snapshots are only in memory until their chunk is full, in-process readers can ask the simulator
+      try:
+        import sim_stats
+        self.read_buffered = sim_stats.read_buffered
+      except ImportError:
+        self.read_buffered = lambda prefixid: None
+
+  def read_columns(self, prefixid, columns):
+    c = self.db.cursor()
+    chunks = c.execute('SELECT chunkoffset FROM `chunks` WHERE firstprefixid <= ? AND lastprefixid >= ?', (prefixid, prefixid)).fetchall()
+    if chunks:
+      return self.columns.read_snapshot(chunks[0][0], prefixid, columns)
+    values = self.read_buffered(prefixid)
+    if values is None:
+      raise ValueError('Snapshot %d is still in the memory of the simulator' % prefixid)
+    return dict([ (column, values[column] if column < len(values) else 0) for column in columns ])
 
   def get_snapshots(self):
     snapshots = []
@@ -26,7 +50,21 @@ class SniperStatsSqlite(sniper_stats.SniperStatsBase):
     c = self.db.cursor()
     c.execute('select prefixid from `prefixes` where prefixname = ?', (prefix,))
     prefixids = list(c)
-    if prefixids:
+    if prefixids and self.columns:
+      prefixid = prefixids[0][0]
+      nameids = self.names.keys()
+      if metrics:
+        nameids = [ nameid for nameid in nameids if '%s.%s' % self.names[nameid] in metrics ]
+      columns = dict([ (columnid, (nameid, core)) for (nameid, core), columnid in self.column_ids.items() if nameid in nameids ])
+      values = {}
+      for columnid, value in self.read_columns(prefixid, columns.keys()).items():
+        # Like the sqlite store, do not report statistics that still have their initial value
+        if value:
+          nameid, core = columns[columnid]
+          if nameid not in values: values[nameid] = {}
+          values[nameid][core] = value
+      return values
+    elif prefixids:
       prefixid = prefixids[0][0]
       if metrics:
         nameids = [ str(nameid) for nameid, (objectname, metricname) in self.names.items() if '%s.%s' % (objectname, metricname) in metrics ]
@@ -43,6 +81,32 @@ class SniperStatsSqlite(sniper_stats.SniperStatsBase):
     else:
       raise ValueError('Invalid prefix %s' % prefix)
 
+  def read_metric(self, metric):
+    # Return { core: [ value in each snapshot ] } for one metric, following the order of get_snapshots()
+    objectname, metricname = metric.split('.', 1)
+    nameids = [ nameid for nameid, name in self.names.items() if name == (objectname, metricname) ]
+    if not nameids:
+      raise ValueError('Invalid metric %s' % metric)
+    c = self.db.cursor()
+    prefixids = [ prefixid for prefixid, in c.execute('SELECT prefixid FROM `prefixes` ORDER BY prefixid ASC') ]
+    series = {}
+    if self.columns:
+      offsets = [ offset for offset, in c.execute('SELECT chunkoffset FROM `chunks` ORDER BY firstprefixid ASC') ]
+      for (nameid, core), columnid in self.column_ids.items():
+        if nameid in nameids:
+          values = self.columns.read_column(offsets, columnid)
+          for prefixid in prefixids:
+            if prefixid not in values:
+              values[prefixid] = self.read_columns(prefixid, [ columnid ])[columnid]
+          series[core] = [ values[prefixid] for prefixid in prefixids ]
+    else:
+      c.execute('SELECT prefixid, core, value FROM `values` WHERE nameid = ?', (nameids[0],))
+      index = dict([ (prefixid, idx) for idx, prefixid in enumerate(prefixids) ])
+      for prefixid, core, value in c:
+        if prefixid in index:
+          series.setdefault(core, [ 0 ] * len(prefixids))[index[prefixid]] = value
+    return series
+
   def get_topology(self):
     c = self.db.cursor()
     return c.execute('SELECT componentname, coreid, masterid FROM topology').fetchall()